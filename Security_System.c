@@ -14,7 +14,7 @@
  *                passcodes (0-9) mimicking some sort of authentication system.
  *                There is also functionality to store and remove passcodes.
  *
- *                It has three core modes (indicated by onboard LED_0):
+ *                It has four core modes (indicated by onboard LED_0):
  *                <> MODE_1_CHECK_CODE (Led color: Blue)
  *                  -> Allows a user to enter a passcode and provides feedback
  *                     indicating whether the passcode is valid.
@@ -27,13 +27,22 @@
  *                  -> Allows a user to enter a passcode and provides feedback
  *                     indicating whether the passcode was removed.
  *
+ *                <> MODE_4_SET_TEMP_CODE (Led color: Cyan)
+ *                  -> Same as MODE_2_SET_CODE, but the passcode expires on
+ *                     its own after TEMPORARY_PASSCODE_LIFETIME_S seconds.
+ *
+ *                The mode button steps through the modes in order. The
+ *                keypad function keys select them directly: A-D select
+ *                MODE_1-MODE_4, H and L step to the next and previous mode,
+ *                E clears the entry and F deletes its last digit.
+ *
  *                To indicate whether an operation completed successfully
  *                or not, an onboard pushbutton will flash either green or red.
  *
  *                Digit Input is through a matrix keypad being controlled in
  *                firmware. This provides a stream of 4-bit data indicating
- *                what button is pressed (0-9 only) with all other keys and
- *                no key pressed indicated by 0xF.
+ *                what hex key is pressed, with flags for a hex key and the
+ *                H and L function keys being pressed.
  *
  *                Passcode output is through a 4-digit seven segment display
  *                also being controlled in firmware. To drive the display, a
@@ -45,35 +54,212 @@
 
 // Includes
 #include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
 #include <stdbool.h>
+#include <string.h>
+#include <ctype.h>
 #include "xil_cache.h"
-#include "keypad_binary_slave.h"
-#include "seven_segment_display_slave.h"
-#include "axilab_slave_button.h"
-#include "axilab_slave_led.h"
 #include "xil_io.h"
+#include "xtime_l.h"
+
+// Defined when building for Linux (see host/)
+#ifdef HOST_BUILD
+#include "host_platform.h"
+#endif
+
+// Uncomment to check passcodes with the passcode CAM peripheral instead of
+// scanning the store in software
+//#define USE_PASSCODE_CAM
+
+// Uncomment to replace the least recently used passcode when a passcode is
+// stored while the store is full, instead of rejecting it
+//#define USE_LRU_EVICTION
+
+// Uncomment to take codes back-to-back in MODE_2_SET_CODE: each verdict
+// flashes while the next code is typed, and the codes are stored together
+// when the mode is left
+//#define USE_ENROLLMENT_SESSION
+
+// Uncomment to also accept the rolling time-based codes (TOTP, RFC 6238) of
+// the shared service accounts in MODE_1_CHECK_CODE. The codes valid within
+// ROLLING_CODE_WINDOW steps of now are computed once per step, so a check is
+// a table lookup instead of an HMAC per step and account. The time and the
+// secrets are set over UART ('T' and 'S'); no code is accepted before then.
+//#define USE_ROLLING_CODES
+
+// Uncomment to set the zones passcodes open over UART: 'Z' sets the zones of
+// one passcode, 'R' and 'G' take a zone from or give it to every passcode
+//#define USE_ZONE_COMMANDS
+
+// Uncomment to replace the whole code set over UART without a reset: 'L'
+// opens a code set, its codes follow as digits and 'C' makes it live ('X'
+// drops it). Checks are served from the old set until then.
+//#define USE_CODE_SET_LOAD
+
+// Uncomment to pin the passcode store, the event rings and the main loop's
+// hot functions to on-chip memory (OCM) instead of DDR, for lookup times that
+// do not depend on DDR on a cache miss. Needs ocm_sections.ld in lscript.ld.
+//#define USE_OCM_PLACEMENT
+#if defined(USE_OCM_PLACEMENT) && !defined(HOST_BUILD)
+#define OCM_DATA __attribute__((section(".ocm_data")))
+#define OCM_CODE __attribute__((section(".ocm_text")))
+#else
+#define OCM_DATA
+#define OCM_CODE
+#endif
+
+// Uncomment to sleep (WFI) between input events instead of polling the
+// peripherals continuously. Needs keypad_irq on IRQ_F2P[0] and button_irq on
+// IRQ_F2P[1], which the block design does not wire yet.
+//#define USE_TICKLESS_IDLE
+#if defined(USE_TICKLESS_IDLE) && !defined(HOST_BUILD)
+#include "xscugic.h"
+#include "xscutimer.h"
+#include "xil_exception.h"
+#include "xpseudo_asm.h"
+#endif
+
+// Uncomment to print the fraction of time spent idle over UART
+//#define MEASURE_IDLE_TIME
+#ifdef MEASURE_IDLE_TIME
+#ifndef USE_TICKLESS_IDLE
+#error "MEASURE_IDLE_TIME requires USE_TICKLESS_IDLE"
+#endif
+#endif
+
+// Uncomment to record every peripheral register access into a binary ring
+// (see register_trace.h). Sending 't' over UART dumps the ring.
+//#define USE_REGISTER_TRACE
+#ifdef USE_REGISTER_TRACE
+#include "register_trace.h"
+
+// Route the register accessors (peripheral_regs.h) through the recorder
+u32 traceReadReg(UINTPTR address);
+void traceWriteReg(UINTPTR address, u32 value);
+#define PERIPHERAL_REG_READ(address)         traceReadReg(address)
+#define PERIPHERAL_REG_WRITE(address, value) traceWriteReg((address), (value))
+#endif
+
+// Register map of the AXI slaves, generated from their component.xml files
+// (see host/regmap)
+#include "peripheral_regs.h"
+
+// Uncomment to count the calls and cycles of the functions instrumented with
+// PROFILE_FUNCTION(). Sending 'p' over UART prints the profile.
+//#define USE_PROFILER
+#ifdef USE_PROFILER
+#if !defined(HOST_BUILD)
+#include "xpseudo_asm.h"
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+#endif
+
+// Uncomment to send binary telemetry frames over UART (see telemetry.h)
+//#define USE_TELEMETRY
+#ifdef USE_TELEMETRY
+#include "telemetry.h"
+#ifndef HOST_BUILD
+#include "xparameters.h"
+#include "xuartps_hw.h"
+#endif
+#endif
+
+// Uncomment to split the firmware across both Cortex-A9 cores: CPU1 (the I/O
+// core) runs the main loop on the peripherals and CPU0 (the store core) owns
+// the passcode store and the access log. The same source is built once per
+// core (XPAR_CPU_ID selects the role), CPU1's at IO_CORE_START_ADDR.
+//#define USE_DUAL_CORE
+#ifdef USE_DUAL_CORE
+#ifdef USE_TELEMETRY
+#error "USE_TELEMETRY reports store state from the I/O core, it needs a single core"
+#endif
+#ifdef USE_OCM_PLACEMENT
+#error "USE_OCM_PLACEMENT would place both cores' state at the same OCM address"
+#endif
+#ifdef USE_ENROLLMENT_SESSION
+#error "USE_ENROLLMENT_SESSION commits to the store from the I/O core, it needs a single core"
+#endif
+#ifdef HOST_BUILD
+#include <pthread.h>
+#else
+#include "xparameters.h"
+#include "xil_mmu.h"
+#include "xpseudo_asm.h"
+#endif
+#endif
+
+// Comment out to remove the diagnostics (AXI register latency and throughput,
+// main loop rate and store operation times) started by pressing the mode
+// button DIAGNOSTICS_MODE_PRESSES times within DIAGNOSTICS_SEQUENCE_MS
+#define USE_DIAGNOSTICS
+#if defined(USE_DIAGNOSTICS) && !defined(HOST_BUILD)
+#include "xpseudo_asm.h"
+#endif
+
+// Commands received over UART, some followed by a line of arguments
+#if defined(USE_ZONE_COMMANDS) || defined(USE_ROLLING_CODES)
+#define USE_CONSOLE_LINES
+#endif
+#if defined(USE_REGISTER_TRACE) || defined(USE_PROFILER) || \
+    defined(USE_CODE_SET_LOAD) || defined(USE_CONSOLE_LINES)
+#define USE_CONSOLE_COMMANDS
+#ifndef HOST_BUILD
+#include "xparameters.h"
+#include "xuartps_hw.h"
+#endif
+#endif
 
 // Masks for onboard push buttons
-#define BUTTON_0_MASK 1
-#define BUTTON_1_MASK 2
+#define BUTTON_0_MASK AXILAB_SLAVE_BUTTON_BUTTONS_BUTTON_0_MASK
+#define BUTTON_1_MASK AXILAB_SLAVE_BUTTON_BUTTONS_BUTTON_1_MASK
 #define RESET_BUTTON_MASK BUTTON_1_MASK
 #define MODE_BUTTON_MASK  BUTTON_0_MASK
 
 // Masks for individual colors of each onboard led
-#define LED_0_BLUE_MASK   0b000001
-#define LED_0_GREEN_MASK  0b000010
-#define LED_0_RED_MASK    0b000100
-#define LED_1_BLUE_MASK   0b001000
-#define LED_1_GREEN_MASK  0b010000
-#define LED_1_RED_MASK    0b100000
+#define LED_0_BLUE_MASK   AXILAB_SLAVE_LED_LEDS_LED_0_BLUE_MASK
+#define LED_0_GREEN_MASK  AXILAB_SLAVE_LED_LEDS_LED_0_GREEN_MASK
+#define LED_0_RED_MASK    AXILAB_SLAVE_LED_LEDS_LED_0_RED_MASK
+#define LED_1_BLUE_MASK   AXILAB_SLAVE_LED_LEDS_LED_1_BLUE_MASK
+#define LED_1_GREEN_MASK  AXILAB_SLAVE_LED_LEDS_LED_1_GREEN_MASK
+#define LED_1_RED_MASK    AXILAB_SLAVE_LED_LEDS_LED_1_RED_MASK
 #define LED_0_PURPLE_MASK LED_0_BLUE_MASK  | LED_0_RED_MASK
 #define LED_0_YELLOW_MASK LED_0_GREEN_MASK | LED_0_RED_MASK
+#define LED_0_CYAN_MASK   LED_0_BLUE_MASK  | LED_0_GREEN_MASK
+
+// Keypad slave clock (FCLK_CLK0), which the key age is counted in
+#define KEYPAD_CLOCK_HZ 100000000
+
+// Keypad scan divider (clock ticks per scan step minus one, 7 bits)
+#define KEYPAD_SCAN_DIVIDER_MASK    KEYPAD_BINARY_SLAVE_SCAN_DIVIDER_TICKS_MASK
+#define DEFAULT_KEYPAD_SCAN_DIVIDER KEYPAD_BINARY_SLAVE_SCAN_DIVIDER_RESET
+
+// Masks for the keypad key state bitmap (bit ((row - 1) * 4) + (col - 1))
+#define KEYPAD_KEY_STATE_MASK KEYPAD_BINARY_SLAVE_KEY_STATE_KEYS_MASK
+
+// Masks for the keypad key register (any key being pressed)
+#define KEYPAD_KEY_PRESSED_MASK (KEYPAD_BINARY_SLAVE_KEY_HEX_MASK | \
+                                 KEYPAD_BINARY_SLAVE_KEY_H_MASK   | \
+                                 KEYPAD_BINARY_SLAVE_KEY_L_MASK)
 
-// Masks for peripheral addresses
-#define KEYPAD_BASE_ADDR        0x43c00000
-#define ONBOARD_PUSH_BASE_ADDR  0x43c10000
-#define SEVEN_SEGMENT_BASE_ADDR 0x43c20000
-#define RGB_LEDS_BASE_ADDR      0x43c30000
+// Keypad keys other than the digits, as returned by getKeypadValue()
+#define KEYPAD_KEY_A  0xA   // Select MODE_1_CHECK_CODE
+#define KEYPAD_KEY_B  0xB   // Select MODE_2_SET_CODE
+#define KEYPAD_KEY_C  0xC   // Select MODE_3_REMOVE_CODE
+#define KEYPAD_KEY_D  0xD   // Select MODE_4_SET_TEMP_CODE
+#define KEYPAD_KEY_E  0xE   // Clear the current passcode
+#define KEYPAD_KEY_F  0xF   // Delete the last digit of the current passcode
+#define KEYPAD_KEY_H  0x10  // Next mode (same as the mode button)
+#define KEYPAD_KEY_L  0x11  // Previous mode
+#define KEYPAD_NO_KEY 0xFF
+
+// Keypad press edge detection, for keys acted on once per press
+#define KEYPAD_DEBOUNCE_MS 30   // Presses this soon after a release bounce
+bool keypadWasPressed;
+uint32_t keypadReleaseMS;
 
 /*******************************************************************************
  * Mode related functionality
@@ -84,7 +270,8 @@ typedef enum
 {
     MODE_1_CHECK_CODE  = 0x1,
     MODE_2_SET_CODE    = 0x2,
-    MODE_3_REMOVE_CODE = 0x3
+    MODE_3_REMOVE_CODE = 0x3,
+    MODE_4_SET_TEMP_CODE = 0x4
 } Mode;
 #define DEFAULT_MODE MODE_1_CHECK_CODE
 
@@ -94,9 +281,18 @@ Mode currentMode;
 // Toggles the current mode of operation
 void toggleMode();
 
+// Toggles the current mode of operation backwards
+void toggleModeBackward();
+
 // Sets the current mode of operation
 void setMode(Mode mode);
 
+// Determines if a keypad function key (A-F, H or L) is being pressed
+bool isFunctionKeyPressed();
+
+// Selects a mode or edits the current passcode from a keypad function key
+void handleFunctionKey();
+
 /*******************************************************************************
  * Passcode related functionality
  ******************************************************************************/
@@ -106,26 +302,112 @@ void setMode(Mode mode);
 
 // Master passcode for system (cannot be changed)
 const uint8_t MASTER_PASSCODE[PASSCODE_LENGTH] = {0,0,0,0};
+#define MASTER_PACKED_PASSCODE 0x0000  // MASTER_PASSCODE packed (packPasscode)
+
+// One bank of the passcode store. Only passcodes (packed, see packPasscode)
+// is read while searching; the attributes of a passcode live in the parallel
+// arrays (same index) and are only touched once it has been found.
+#define BLANK_PACKED_PASSCODE 0xFFFF
+typedef struct
+{
+    uint16_t passcodes[MAX_NUM_STORED_PASSCODES];
+    uint8_t roles[MAX_NUM_STORED_PASSCODES];
+    uint32_t zones[MAX_NUM_STORED_PASSCODES];
+    uint16_t useCounts[MAX_NUM_STORED_PASSCODES];
+    uint32_t lastUsed[MAX_NUM_STORED_PASSCODES];  // Seconds since boot
+    uint8_t creators[MAX_NUM_STORED_PASSCODES];
+    uint8_t timers[MAX_NUM_STORED_PASSCODES];     // Expiry timer (or NO_TIMER)
+    uint8_t numPasscodes;
+} PasscodeBank;
+
+// The store is double buffered. Checks are served from the live bank while a
+// new code set is loaded into the other (shadow) bank, and one release store
+// of liveStore makes the loaded set live (see commitPasscodeLoad). Only the
+// store core (see USE_DUAL_CORE) touches the banks and liveStore.
+OCM_DATA PasscodeBank passcodeBanks[2];
+OCM_DATA PasscodeBank *liveStore = &passcodeBanks[0];
+
+// Code set being loaded into the shadow bank. A load that failed (or never
+// finished) is never committed.
+bool isPasscodeLoadOpen;
+bool isPasscodeLoadFailed;
 
-// Location to store valid passcodes
-uint8_t storedPasscodes[MAX_NUM_STORED_PASSCODES][PASSCODE_LENGTH];
-uint8_t currentStoredPasscodesIndex;
+// Store generation, bumped by resetStoredPasscodes() instead of clearing the
+// store. Only the first numPasscodes slots of a bank are ever searched and
+// stores overwrite their slot, so codes of an earlier generation are left in
+// place.
+#define STORE_SWEEP_ENTRIES 8   // Wheel slots cleaned per sweep
+OCM_DATA uint8_t storeEpoch;
+
+// Roles a stored passcode can have
+typedef enum
+{
+    ROLE_USER      = 0x1,
+    ROLE_TEMPORARY = 0x2   // Stored in MODE_4_SET_TEMP_CODE
+} PasscodeRole;
+
+// Who stored a passcode
+#define CREATOR_KEYPAD 0x0
+
+// Zones a passcode opens (one bit per zone)
+#define NUM_ZONES      32
+#define ZONE_MASK(zone) (1UL << (zone))
+#define ALL_ZONES_MASK 0xFFFFFFFF
+
+// Zone of the door this keypad opens
+#define KEYPAD_ZONE 0
+
+// Passcode not yet used
+#define NEVER_USED 0
+
+// Returned by findPasscode when a passcode is not stored
+#define PASSCODE_NOT_FOUND -1
+
+// Outcome of a compound store operation (see insertPasscode, erasePasscode,
+// loadPasscode)
+typedef enum
+{
+    STORE_INSERTED,   // Passcode was not stored and now is
+    STORE_DUPLICATE,  // Passcode was already stored (not inserted)
+    STORE_MASTER,     // MASTER_PASSCODE (never stored or removed)
+    STORE_FULL,       // No room for the passcode (not inserted)
+    STORE_REMOVED,    // Passcode was stored and now is not
+    STORE_ABSENT,     // Passcode was not stored (nothing removed)
+    STORE_NO_LOAD     // No code set is being loaded (see beginPasscodeLoad)
+} StoreStatus;
 
 // A location to store the current keypad entry (0xF results in a blank digit)
-uint8_t currentPasscode[PASSCODE_LENGTH];
-uint8_t currentPasscodeIndex;
+OCM_DATA uint8_t currentPasscode[PASSCODE_LENGTH];
+OCM_DATA uint8_t currentPasscodeIndex;
 
-// Clears and resets storedPasscodes
+// Clears and resets the store (in constant time)
 void resetStoredPasscodes();
 
+// Cleans up a little of what the last resetStoredPasscodes() left behind
+void sweepStoredPasscodes();
+
 // Clears and resets currentPasscode
 void resetCurrentPasscode();
 
-// Adds the current passcode to storedPasscodes
-bool storePasscode(uint8_t passcode[]);
+// Adds passcode to the store unless it is the master or already stored
+StoreStatus insertPasscode(uint8_t passcode[]);
+
+// Adds a packed passcode to the store unless it is the master or already
+// stored
+StoreStatus insertPackedPasscode(uint16_t packedPasscode);
+
+// Probes a bank once for a packed passcode (master, stored or not stored)
+StoreStatus probePasscode(const PasscodeBank *bank, uint16_t packedPasscode);
+
+// Adds a packed passcode known not to be stored to the store
+bool storePackedPasscode(uint16_t packedPasscode);
+
+// Sets a slot of a bank to a packed passcode with default attributes
+void setPasscodeBankSlot(PasscodeBank *bank, uint8_t index,
+                         uint16_t packedPasscode);
 
-// Removes the current passcode from storedPasscodes
-bool removePasscode(uint8_t passcode[]);
+// Removes passcode from the store if it is stored
+StoreStatus erasePasscode(uint8_t passcode[]);
 
 // Add a digit to currentPasscode
 bool storeCurrentPasscodeDigit(uint8_t digitData);
@@ -133,15 +415,344 @@ bool storeCurrentPasscodeDigit(uint8_t digitData);
 // Checks if passcode is equal to MASTER_PASSCODE
 bool isMasterPasscode(uint8_t passcode[]);
 
-// Checks if passcode exists in storedPasscodes
+// Checks if passcode exists in the store
 bool isExistingPasscode(uint8_t passcode[]);
 
-// Checks if storedPasscodes is full
+// Checks if passcode exists in the store and opens zone, and records
+// its use
+bool checkPasscode(uint8_t passcode[], uint8_t zone);
+
+// Sets the zones a stored passcode opens
+bool setPasscodeZones(uint8_t passcode[], uint32_t zones);
+
+// Takes zone away from every stored passcode
+void revokeZone(uint8_t zone);
+
+// Gives zone to every stored passcode
+void grantZone(uint8_t zone);
+
+// Finds the index of passcode in the store
+int findPasscode(uint16_t packedPasscode);
+
+// Finds the index of a packed passcode in a bank
+int findBankPasscode(const PasscodeBank *bank, uint16_t packedPasscode);
+
+// Finds the index of a packed passcode in an array of packed passcodes
+int searchPasscodes(const uint16_t passcodes[], uint8_t numPasscodes,
+                    uint16_t packedPasscode);
+
+// Checks if the store is full
 bool isStoredPasscodesFull();
 
+// Gets the bank of the store that is not live
+PasscodeBank *getShadowStore();
+
+// Starts loading a new code set into the shadow bank (in constant time)
+void beginPasscodeLoad();
+
+// Adds passcode to the code set being loaded
+StoreStatus loadPasscode(uint8_t passcode[]);
+
+// Makes the code set being loaded live, unless its load failed
+bool commitPasscodeLoad();
+
+// Drops the code set being loaded
+void abortPasscodeLoad();
+
 // Checks if currentPasscode is complete
 bool isCurrentPasscodeComplete();
 
+// Checks, stores or removes a complete passcode entered in mode
+bool handlePasscode(uint8_t mode, uint8_t passcode[]);
+
+// Packs a passcode into a 16-bit number (one digit per nibble)
+uint16_t packPasscode(const uint8_t passcode[]);
+
+/*******************************************************************************
+ * Passcode expiry related functionality
+ ******************************************************************************/
+
+// Lifetime of passcodes stored in MODE_4_SET_TEMP_CODE (8 hours)
+#define TEMPORARY_PASSCODE_LIFETIME_S (8UL * 60 * 60)
+
+// Hierarchical timing wheel of one second ticks. Level n has WHEEL_SLOTS slots
+// of 64^n seconds each, so 4 levels cover 2^24 seconds (about 194 days).
+#define WHEEL_LEVELS    4
+#define WHEEL_SLOT_BITS 6
+#define WHEEL_SLOTS     (1 << WHEEL_SLOT_BITS)
+#define WHEEL_SLOT_MASK (WHEEL_SLOTS - 1)
+#define WHEEL_RANGE_S   (1UL << (WHEEL_LEVELS * WHEEL_SLOT_BITS))
+#define NO_TIMER        0xFF
+
+// The expiry of a temporary passcode (linked into one wheel slot)
+typedef struct
+{
+    uint32_t expiryTime;  // Seconds since boot
+    uint8_t storeIndex;   // Index of the passcode in the store
+    uint8_t slot;         // Wheel slot ((level * WHEEL_SLOTS) + index)
+    uint8_t next;         // Next timer in the slot (or free list)
+    uint8_t prev;         // Previous timer in the slot (NO_TIMER for head)
+} ExpiryTimer;
+
+OCM_DATA ExpiryTimer expiryTimers[MAX_NUM_STORED_PASSCODES];
+OCM_DATA uint8_t expiryWheel[WHEEL_LEVELS * WHEEL_SLOTS];  // First timer of each slot
+uint8_t freeExpiryTimers;                         // First freed timer
+uint8_t usedExpiryTimers;                         // Timers taken since the reset
+uint8_t numExpiryTimers;
+uint32_t expiryWheelTime;                         // Last second processed
+
+// Occupied slots of each level (bit n for slot index n), so the wheel skips
+// straight to the next second with a timer to expire or cascade
+#if WHEEL_SLOTS != 64
+#error "expiryWheelOccupied holds one 64-bit word per level"
+#endif
+uint64_t expiryWheelOccupied[WHEEL_LEVELS];
+
+// Store generation each wheel slot was last written in. A slot of an earlier
+// generation is empty, so a reset leaves the wheel as it is. Every reset also
+// sweeps WHEEL_SWEEP_SLOTS_PER_RESET slots in turn, so no slot falls 256
+// generations behind and looks current again.
+#define WHEEL_TOTAL_SLOTS           (WHEEL_LEVELS * WHEEL_SLOTS)
+#define WHEEL_SWEEP_SLOTS_PER_RESET ((WHEEL_TOTAL_SLOTS + 254) / 255)
+OCM_DATA uint8_t expiryWheelEpochs[WHEEL_TOTAL_SLOTS];
+uint16_t expiryWheelSweepSlot;                    // Next slot to sweep
+uint16_t staleExpiryWheelSlots;                   // Slots left to sweep
+
+// Adds passcode to the store for lifetimeS seconds, like insertPasscode
+StoreStatus insertTemporaryPasscode(uint8_t passcode[], uint32_t lifetimeS);
+
+// Removes the passcode at index from the store
+void removeStoredPasscodeAt(uint8_t index);
+
+// Removes every passcode whose expiry time has passed
+void expirePasscodes();
+
+// Clears the timing wheel and frees all expiry timers (in constant time)
+void resetExpiryWheel();
+
+// Gets the first timer of a wheel slot (NO_TIMER if empty or stale)
+uint8_t getExpiryWheelSlot(uint8_t slot);
+
+// Sets the first timer of a wheel slot
+void setExpiryWheelSlot(uint8_t slot, uint8_t timer);
+
+// Gets the next second after expiryWheelTime with a timer to expire or cascade
+uint32_t getNextExpiryWheelTime();
+
+// Empties up to numSlots wheel slots of earlier store generations
+void sweepExpiryWheel(uint16_t numSlots);
+
+// Links an expiry timer into the wheel slot for its expiry time
+void scheduleExpiryTimer(uint8_t timer);
+
+// Unlinks an expiry timer from the wheel and frees it
+void cancelExpiryTimer(uint8_t timer);
+
+// Moves the timers of the current slot of a wheel level down a level
+void cascadeExpiryWheel(uint8_t level);
+
+// Gets the time since boot in seconds
+uint32_t getTimeSeconds();
+
+// Gets the time since boot in milliseconds
+uint32_t getTimeMS();
+
+/*******************************************************************************
+ * Passcode LRU eviction related functionality
+ ******************************************************************************/
+#ifdef USE_LRU_EVICTION
+
+#define NO_LRU_ENTRY 0xFF
+
+// Recency list through the stored passcodes (same index as the store),
+// most recently stored or checked at the head, next to evict at the tail
+OCM_DATA uint8_t storedPasscodeLRUNext[MAX_NUM_STORED_PASSCODES];  // Towards the tail
+OCM_DATA uint8_t storedPasscodeLRUPrev[MAX_NUM_STORED_PASSCODES];  // Towards the head
+uint8_t lruHead;
+uint8_t lruTail;
+
+// Empties the recency list
+void resetLRUList();
+
+// Links the passcode at index in as the most recently used
+void pushLRUEntry(uint8_t index);
+
+// Unlinks the passcode at index from the recency list
+void unlinkLRUEntry(uint8_t index);
+
+// Makes the passcode at index the most recently used
+void touchLRUEntry(uint8_t index);
+
+// Relinks the list entry of a passcode moved from one index to another
+void moveLRUEntry(uint8_t from, uint8_t to);
+
+// Removes the least recently used passcode from the store
+void evictLeastRecentlyUsedPasscode();
+
+#else
+#define resetLRUList()
+#define pushLRUEntry(index)
+#define unlinkLRUEntry(index)
+#define touchLRUEntry(index)
+#define moveLRUEntry(from, to)
+#endif // USE_LRU_EVICTION
+
+/*******************************************************************************
+ * Passcode CAM related functionality
+ ******************************************************************************/
+#ifdef USE_PASSCODE_CAM
+
+// Waits for the CAM's verdict (and the result of any command) to be valid
+u32 waitPasscodeCAMStatus();
+
+// Applies a command (PASSCODE_CAM_SLAVE_CMD_OP_*) to a packed passcode
+u32 commandPasscodeCAM(u32 command, uint16_t packedPasscode);
+
+// Inserts a packed passcode into the CAM, tagged with its store index
+u32 insertPasscodeCAM(uint16_t packedPasscode, uint8_t index);
+
+// Looks a packed passcode up in the CAM and gets its store index
+int lookupPasscodeCAM(uint16_t packedPasscode);
+
+#endif // USE_PASSCODE_CAM
+
+/*******************************************************************************
+ * Enrollment session related functionality
+ ******************************************************************************/
+#ifdef USE_ENROLLMENT_SESSION
+
+// Codes accepted since MODE_2_SET_CODE was entered (packed, ascending), stored
+// together when it is left
+uint16_t enrollmentBatch[MAX_NUM_STORED_PASSCODES];
+uint8_t enrollmentBatchSize;
+
+// Status LED flash running in the background (two flashes in four phases)
+#define STATUS_FLASH_PHASE_MS 125
+#define STATUS_FLASH_PHASES   4
+uint8_t statusFlashColor;
+uint8_t statusFlashPhase;           // Phases left (0 when not flashing)
+uint32_t statusFlashPhaseStartMS;
+
+// Reads the keypad and enrolls the code once it is complete
+void handleEnrollmentInput();
+
+// Adds a complete passcode to enrollmentBatch
+StoreStatus enrollPasscode(uint8_t passcode[]);
+
+// Finds where a packed passcode is (or would go) in enrollmentBatch
+uint8_t findEnrolledPasscode(uint16_t packedPasscode);
+
+// Stores enrollmentBatch in the store and empties it
+uint8_t commitEnrollmentSession();
+
+// Empties enrollmentBatch without storing it
+void resetEnrollmentSession();
+
+// Starts flashing the status led without waiting for the flash to end
+void startStatusFlash(uint8_t statusColor);
+
+// Moves the status led flash on to its next phase when it is due
+void serviceStatusFlash();
+
+#ifdef USE_TICKLESS_IDLE
+// Limits an idle timeout to the next status led flash phase
+uint32_t limitStatusFlashTimeoutMS(uint32_t timeoutMS);
+#endif
+
+#else
+#define resetEnrollmentSession()
+#define serviceStatusFlash()
+#define limitStatusFlashTimeoutMS(timeoutMS) (timeoutMS)
+#endif // USE_ENROLLMENT_SESSION
+
+/*******************************************************************************
+ * Rolling code related functionality
+ ******************************************************************************/
+#ifdef USE_ROLLING_CODES
+
+// Shared service accounts. Their secrets (HMAC-SHA1 keys, as provisioned in
+// their authenticator apps) are not in the firmware image: each is set over
+// UART (see setRollingCodeSecret), and only its prepared key is kept.
+#define NUM_ROLLING_CODE_ACCOUNTS      2
+#define ROLLING_CODE_MAX_SECRET_LENGTH 20   // At most SHA1_BLOCK_SIZE
+
+// Time steps (RFC 6238 defaults: 30 s steps counted from the Unix epoch) and
+// the steps either side of now whose codes are accepted (clock drift)
+#define ROLLING_CODE_STEP_S  30
+#define ROLLING_CODE_WINDOW  1
+#define ROLLING_CODE_STEPS   ((2 * ROLLING_CODE_WINDOW) + 1)
+#define ROLLING_CODE_MODULUS 10000  // 10^PASSCODE_LENGTH
+
+// Unix time at boot, once setRollingCodeTime() is called (the board has no
+// real time clock, so no codes are accepted until then)
+uint64_t rollingCodeBootUnixTime;
+bool isRollingCodeTimeSet;
+
+#define SHA1_BLOCK_SIZE  64
+#define SHA1_DIGEST_SIZE 20
+
+// SHA-1 state after the inner and outer padded key blocks of an HMAC key, so
+// a code costs two compressions instead of four
+typedef struct
+{
+    uint32_t inner[SHA1_DIGEST_SIZE / 4];
+    uint32_t outer[SHA1_DIGEST_SIZE / 4];
+} HMACKey;
+HMACKey rollingCodeKeys[NUM_ROLLING_CODE_ACCOUNTS];
+uint8_t rollingCodeAccounts;    // Bit per account whose secret is set
+
+// Packed codes of each account for the steps in the window, indexed by
+// (step + ROLLING_CODE_WINDOW) % ROLLING_CODE_STEPS, so moving on one step
+// computes one new code per account
+uint16_t rollingCodeRing[NUM_ROLLING_CODE_ACCOUNTS][ROLLING_CODE_STEPS];
+
+// Every code of the accounts whose secret is set in the window, sorted for a
+// binary search
+#define ROLLING_CODE_TABLE_SIZE (NUM_ROLLING_CODE_ACCOUNTS * ROLLING_CODE_STEPS)
+uint16_t rollingCodeTable[ROLLING_CODE_TABLE_SIZE];
+uint8_t rollingCodeTableSize;
+uint64_t rollingCodeStep;        // Step at the centre of the window
+bool isRollingCodeTableValid;
+
+// Sets the Unix time now, which the time steps count from
+void setRollingCodeTime(uint64_t unixTime);
+
+// Sets the secret of an account
+bool setRollingCodeSecret(uint8_t account, const uint8_t secret[],
+                          uint8_t secretLength);
+
+// Gets the current time step
+uint64_t getRollingCodeStep();
+
+// Moves the window of valid codes on to the current time step
+void serviceRollingCodes();
+
+// Checks if passcode is in the window of valid rolling codes
+bool isRollingCode(uint8_t passcode[]);
+
+// Prepares an HMAC-SHA1 key
+void prepareHMACKey(const uint8_t key[], uint8_t keyLength, HMACKey *hmacKey);
+
+// Computes the HOTP value (RFC 4226) of counter, before it is cut to digits
+uint32_t computeHOTP(const HMACKey *hmacKey, uint64_t counter);
+
+// Runs the SHA-1 compression function on one block
+void compressSHA1(uint32_t state[], const uint8_t block[]);
+
+// Packs a rolling code (0 to ROLLING_CODE_MODULUS - 1) like packPasscode
+uint16_t packRollingCode(uint32_t code);
+
+#ifdef USE_TICKLESS_IDLE
+// Limits an idle timeout to the next time step
+uint32_t limitRollingCodeTimeoutMS(uint32_t timeoutMS);
+#endif
+
+#else
+#define serviceRollingCodes()
+#define isRollingCode(passcode) false
+#define limitRollingCodeTimeoutMS(timeoutMS) (timeoutMS)
+#endif // USE_ROLLING_CODES
+
 /*******************************************************************************
  * Onboard LED related functionality
  ******************************************************************************/
@@ -149,6 +760,9 @@ bool isCurrentPasscodeComplete();
 // Sets the leds
 void setLEDS(uint8_t ledData);
 
+// Gets the LED_0 color of the current mode
+uint8_t getModeColor();
+
 // Sets mode LED color for current mode of operation
 void setModeLED();
 
@@ -156,545 +770,4707 @@ void setModeLED();
 void flashStatusLED(uint8_t statusColor);
 
 /*******************************************************************************
- * Miscellaneous functionality
+ * Idle related functionality
  ******************************************************************************/
-bool previousResetButtonState = false;
+#ifdef USE_TICKLESS_IDLE
 
-// Determines if reset button is pressed
-bool isResetButtonPressed();
+// Events that wake the processor from idle
+#define EVENT_INPUT   0x1  // Keypad key or button held (level interrupts)
+#define EVENT_TIMEOUT 0x2  // One-shot timer expired
+#define NO_TIMEOUT    0
 
-// Determines if reset button was released
-bool isResetButtonReleased();
+#ifndef HOST_BUILD
+// Interrupt controller and private timer
+#define INTC_DEVICE_ID  XPAR_SCUGIC_SINGLE_DEVICE_ID
+#define TIMER_DEVICE_ID XPAR_XSCUTIMER_0_DEVICE_ID
+#define TIMER_INTR_ID   XPAR_SCUTIMER_INTR
 
-// Determines if mode button has been pressed
-bool isModeButtonPressed();
+// Fabric interrupt IDs (IRQ_F2P[0] and IRQ_F2P[1])
+#define KEYPAD_INTR_ID  61
+#define BUTTON_INTR_ID  62
+#define INTR_PRIORITY   0xA0
+#define INTR_LEVEL_HIGH 0x1
 
-// Determines if keypad has been pressed
-bool isKeypadPressed();
+// Private timer ticks per millisecond (clocked at half the CPU clock)
+#define TIMER_PRESCALER    249
+#define TIMER_TICKS_PER_MS (XPAR_CPU_CORTEXA9_0_CPU_CLK_FREQ_HZ / 2 / \
+                            (TIMER_PRESCALER + 1) / 1000)
 
-// Gets the current keypad key pressed
-uint8_t getKeypadValue();
+XScuGic interruptController;
+XScuTimer idleTimer;
+#endif
 
-// Displays code to seven segment display
-void displayPasscode(uint8_t passcode[]);
+// Events that occurred while idle (set by the interrupt handlers)
+OCM_DATA volatile uint32_t pendingEvents;
 
-// Delay for ms milliseconds
-void delayMS(uint16_t ms);
+#ifdef MEASURE_IDLE_TIME
+#define IDLE_REPORT_PERIOD_MS 10000
+#define IDLE_TIMEOUT_MS       IDLE_REPORT_PERIOD_MS
 
-// Reset the system
-void resetSystem();
+XTime idleTime;              // Global timer counts spent idle
+XTime idleMeasureStartTime;  // Start of the current report period
 
-// Clear all outputs
-void clearOutputs();
+// Prints the fraction of time spent idle every IDLE_REPORT_PERIOD_MS
+void reportIdleTime();
+#else
+#define IDLE_TIMEOUT_MS NO_TIMEOUT
+#endif
 
-/*
- * This function is the main function of the project.
- *
- * Arguments: None
- *
- * Return:
- * - (int): Integer status of function exit. (0 -> good, anything else -> error)
- */
-int main(void)
+// Sets up the interrupts and timer that wake the processor from idle
+void initIdle();
+
+// Idles the processor until one of events occurs or timeoutMS passes
+uint32_t waitForEvent(uint32_t events, uint32_t timeoutMS);
+
+// Determines if a keypad key or button is being held
+bool isInputActive();
+
+#ifndef HOST_BUILD
+// Handles the one-shot timer interrupt
+void timerInterruptHandler(void *callbackRef);
+
+// Handles the keypad and button interrupts
+void inputInterruptHandler(void *callbackRef);
+#endif
+
+#endif // USE_TICKLESS_IDLE
+
+/*******************************************************************************
+ * Register trace related functionality
+ ******************************************************************************/
+#ifdef USE_REGISTER_TRACE
+
+// Trace clock = global timer >> REGISTER_TRACE_TIME_SHIFT (about 10 MHz on
+// the target, 1 MHz on the host)
+#ifdef HOST_BUILD
+#define REGISTER_TRACE_TIME_SHIFT 0
+#else
+#define REGISTER_TRACE_TIME_SHIFT 5
+#endif
+
+// Character received over UART that dumps the trace
+#define TRACE_DUMP_COMMAND 't'
+
+// Ring of trace blocks (see register_trace.h)
+OCM_DATA uint8_t registerTrace[REGISTER_TRACE_NUM_BLOCKS][REGISTER_TRACE_BLOCK_SIZE];
+uint32_t registerTraceBlocksStarted;  // Blocks started since boot
+uint16_t registerTraceBlockUsed;      // Bytes used in the current block
+uint64_t registerTraceLastTime;       // Trace clock of the last record
+
+// Appends an access record to the trace
+void recordRegisterAccess(bool isWrite, UINTPTR address, u32 value);
+
+// Starts a new trace block (overwriting the oldest block once full)
+void startRegisterTraceBlock(uint64_t time);
+
+// Encodes a record, returning its size
+uint8_t encodeRegisterTraceRecord(uint8_t record[], uint8_t header,
+                                  uint64_t delta, u32 value);
+
+// Prints the trace as hex, oldest block first
+void dumpRegisterTrace();
+
+#endif // USE_REGISTER_TRACE
+
+/*******************************************************************************
+ * Profiler related functionality
+ ******************************************************************************/
+#ifdef USE_PROFILER
+
+// Character received over UART that prints the profile
+#define PROFILE_REPORT_COMMAND 'p'
+
+// Cycle counter: the PMU CCNT (CPU clock) on the target, the TSC on x86 hosts
+// and nanoseconds on other hosts. CCNT is 32 bits, so a single call is timed
+// correctly for up to 2^32 cycles (6.4 s at 667 MHz).
+#if !defined(HOST_BUILD)
+typedef u32 ProfileCycles;
+#define PROFILE_CYCLE_UNIT "cycles"
+#define PMCR_ENABLE        0x1         // PMCR.E: enable the counters
+#define PMCR_RESET_CCNT    0x4         // PMCR.C: reset CCNT
+#define PMCNTEN_CCNT       0x80000000  // PMCNTENSET.C: enable CCNT
+#elif defined(__x86_64__) || defined(__i386__)
+typedef uint64_t ProfileCycles;
+#define PROFILE_CYCLE_UNIT "tsc ticks"
+#else
+typedef uint64_t ProfileCycles;
+#define PROFILE_CYCLE_UNIT "ns"
+#endif
+
+// Instrumented functions
+typedef enum
 {
-    // Reset passcodes and current mode
-    resetSystem();
+    PROFILE_STORE_CURRENT_PASSCODE_DIGIT,
+    PROFILE_IS_EXISTING_PASSCODE,
+    PROFILE_ERASE_PASSCODE,
+    PROFILE_DISPLAY_PASSCODE,
+    PROFILE_FLASH_STATUS_LED,
+    NUM_PROFILED_FUNCTIONS
+} ProfiledFunction;
 
-    while (true)  // Main program execution loop
-    {
-        if (isResetButtonPressed())  // Is reset button being held down?
-        {
-            clearOutputs();  // Clear all outputs
-        }
+const char *PROFILED_FUNCTION_NAMES[NUM_PROFILED_FUNCTIONS] = {
+    "storeCurrentPasscodeDigit",
+    "isExistingPasscode",
+    "erasePasscode",
+    "displayPasscode",
+    "flashStatusLED"
+};
 
-        if (isResetButtonReleased())  // Is reset button being released (falling edge)?
-        {
-            resetSystem();                     // Reset passcodes and mode
-            delayMS(250);                      // Delay program
-            flashStatusLED(LED_1_GREEN_MASK);  // Flash green status led
-        }
-        else if (isModeButtonPressed())  // Is mode button being pressed?
-        {
-            toggleMode();  // Toggle the current mode and reset passcode
-            delayMS(500);  // Delay 500 ms
-        }
-        else if (isKeypadPressed())  // Is a key on keypad being pressed?
-        {
-            // Add to currentPasscode
-            storeCurrentPasscodeDigit(getKeypadValue());
+// Cycles spent in one instrumented function (including its callees)
+typedef struct
+{
+    uint32_t calls;
+    uint64_t totalCycles;
+    uint64_t minCycles;
+    uint64_t maxCycles;
+} ProfileEntry;
 
-            // Delay program to prevent same press being registered constantly
-            delayMS(450);
+ProfileEntry profileTable[NUM_PROFILED_FUNCTIONS];
 
-            // Check if full passcode has been entered
-            if (isCurrentPasscodeComplete())
-            {
-               switch (currentMode)
-               {
-                    case MODE_1_CHECK_CODE:
-                        if (isMasterPasscode(currentPasscode) ||
-                            isExistingPasscode(currentPasscode))
-                        {
-                            // Flash green status led
-                            // (Indicating passcode valid)
-                            flashStatusLED(LED_1_GREEN_MASK);
-                        }
-                        else
-                        {
-                            // Flash red status led
-                            // (Indicating passcode invalid)
-                            flashStatusLED(LED_1_RED_MASK);
-                        }
-                        break;
-                    case MODE_2_SET_CODE:
-                        if (!isMasterPasscode(currentPasscode) &&
-                            !isExistingPasscode(currentPasscode) &&
-                            !isStoredPasscodesFull())
-                        {
-                            // Flash green status led
-                            // (Indicating passcode stored)
-                            flashStatusLED(LED_1_GREEN_MASK);
-                            storePasscode(currentPasscode);
-                        }
-                        else
-                        {
-                            // Flash red status led
-                            // (Indicating passcode not stored)
-                            flashStatusLED(LED_1_RED_MASK);
-                        }
-                        break;
-                    case MODE_3_REMOVE_CODE:
-                        if (!isMasterPasscode(currentPasscode) &&
-                            isExistingPasscode(currentPasscode))
-                        {
-                            // Flash green status led
-                            // (Indicating passcode removed)
-                            flashStatusLED(LED_1_GREEN_MASK);
-                            removePasscode(currentPasscode);
-                        }
-                        else
-                        {
-                            // Flash red status led
-                            // (Indicating passcode not removed)
-                            flashStatusLED(LED_1_RED_MASK);
-                        }
-                        break;
-                    default:
-                        break;
-               }
-               resetCurrentPasscode();  // Reset current passcode
-            }
+// A call being timed, ended by endProfileScope() when it goes out of scope
+typedef struct
+{
+    ProfiledFunction function;
+    ProfileCycles startCycles;
+} ProfileScope;
+
+// Times the rest of the enclosing function (every return path included)
+#define PROFILE_FUNCTION(function)                                          \
+    ProfileScope profileScope __attribute__((cleanup(endProfileScope))) =  \
+        {(function), readCycleCounter()}
+
+// Starts the cycle counter
+void initProfiler();
+
+// Reads the cycle counter
+ProfileCycles readCycleCounter();
+
+// Adds a timed call to profileTable
+void endProfileScope(ProfileScope *scope);
+
+// Prints profileTable
+void reportProfile();
+
+#else
+#define PROFILE_FUNCTION(function)
+#endif // USE_PROFILER
+
+/*******************************************************************************
+ * Console related functionality
+ ******************************************************************************/
+#ifdef USE_CONSOLE_COMMANDS
+
+#define NO_CONSOLE_COMMAND -1
+
+// Reads a command character from UART
+int readConsoleCommand();
+
+// Runs a command received over UART
+void handleConsoleCommand();
+
+// Prints a line of output of the store (through the I/O core, which owns the
+// UART, with USE_DUAL_CORE)
+void printStoreOutput(const char *format, ...);
+
+// Idle timeout while a command is being received (the 64 byte UART RX FIFO
+// fills in under 6 ms at 115200 baud)
+#define CONSOLE_POLL_MS 4
+
+#ifdef USE_TICKLESS_IDLE
+// Limits an idle timeout while a command is being received
+uint32_t limitConsoleTimeoutMS(uint32_t timeoutMS);
+#endif
+
+#ifdef USE_CONSOLE_LINES
+#ifdef USE_ZONE_COMMANDS
+#define SET_ZONES_COMMAND   'Z'   // Z<passcode> <zone bitmap in hex>
+#define REVOKE_ZONE_COMMAND 'R'   // R<zone>
+#define GRANT_ZONE_COMMAND  'G'   // G<zone>
+#endif
+#ifdef USE_ROLLING_CODES
+#define SET_TIME_COMMAND    'T'   // T<Unix time in seconds>
+#define SET_SECRET_COMMAND  'S'   // S<account> <secret in hex>
+#endif
+
+// Command whose line of arguments is being received (up to a line break)
+#define CONSOLE_LINE_LENGTH 48
+int consoleLineCommand = NO_CONSOLE_COMMAND;
+char consoleLine[CONSOLE_LINE_LENGTH + 1];
+uint8_t consoleLineLength;
+
+// Handles a character of the line of arguments being received
+void handleConsoleLineCharacter(int character);
+
+// Runs a command with its line of arguments on the store (on the store core
+// with USE_DUAL_CORE)
+void runConsoleLine(uint8_t command, const char line[]);
+
+// Runs a command with its line of arguments and reports its outcome
+void handleConsoleLine(uint8_t command, const char line[]);
+
+// Parses a passcode of PASSCODE_LENGTH digits at the start of text
+bool parseConsolePasscode(const char text[], uint8_t passcode[]);
+#endif // USE_CONSOLE_LINES
+
+#ifdef USE_CODE_SET_LOAD
+#define LOAD_BEGIN_COMMAND  'L'   // Open a code set (dropping an unfinished one)
+#define LOAD_COMMIT_COMMAND 'C'   // Make the code set live
+#define LOAD_ABORT_COMMAND  'X'   // Drop the code set
+
+// Steps of a code set load, as carried out on the store
+typedef enum
+{
+    LOAD_BEGIN = 1,
+    LOAD_PASSCODE,
+    LOAD_COMMIT,
+    LOAD_ABORT
+} LoadStep;
+
+// Code set being received (codes of PASSCODE_LENGTH digits, optionally
+// separated by spaces, commas or line breaks)
+bool isConsoleLoadOpen;
+uint8_t consoleLoadPasscode[PASSCODE_LENGTH];
+uint8_t consoleLoadDigits;
+
+// Handles a character received while a code set is open
+void handleConsoleLoadCharacter(int character);
+
+// Carries out a step of a code set load on the store (on the store core with
+// USE_DUAL_CORE)
+void runPasscodeLoadStep(uint8_t step, uint8_t passcode[]);
+
+// Carries out a step of a code set load and reports its outcome
+void handlePasscodeLoad(uint8_t step, uint8_t passcode[]);
+#endif // USE_CODE_SET_LOAD
+
+#else
+#define limitConsoleTimeoutMS(timeoutMS) (timeoutMS)
+#endif // USE_CONSOLE_COMMANDS
+
+/*******************************************************************************
+ * Telemetry related functionality
+ ******************************************************************************/
+#ifdef USE_TELEMETRY
+
+// Milliseconds between status frames
+#define TELEMETRY_INTERVAL_MS 1000
+
+// Idle timeout while bytes wait in the TX buffer (the 64 byte UART FIFO
+// empties in under 6 ms at 115200 baud)
+#define TELEMETRY_DRAIN_MS 6
+
+// Frames are queued here and moved to the UART FIFO as it has room, so the
+// main loop never waits for the UART (a power of 2)
+#define TELEMETRY_TX_BUFFER_SIZE 1024
+OCM_DATA uint8_t telemetryTxBuffer[TELEMETRY_TX_BUFFER_SIZE];
+uint16_t telemetryTxHead;  // Next byte to queue
+uint16_t telemetryTxTail;  // Next byte to send
+
+// Counters reported in status frames
+uint16_t telemetrySequence;
+uint32_t telemetryNextStatusMS;
+uint32_t telemetryIntervalLoops;
+uint32_t telemetryKeyPresses;
+uint16_t telemetryVerdicts[TELEMETRY_NUM_OPERATIONS][2];  // [op][accepted]
+uint16_t telemetryExpiredPasscodes;
+uint16_t telemetryDroppedFrames;
+
+// Adds one to a telemetry counter
+#define countTelemetry(counter) ((counter)++)
+
+// Queues a status frame when one is due and sends queued bytes
+void serviceTelemetry();
+
+#ifdef USE_TICKLESS_IDLE
+// Gets how long the processor may idle before serviceTelemetry() is due
+uint32_t getTelemetryTimeoutMS();
+#endif
+
+// Counts the outcome of a passcode entered in currentMode and queues a
+// verdict frame
+void recordTelemetryVerdict(bool accepted);
+
+// Queues a status frame
+void queueTelemetryStatus(uint32_t now);
+
+// Queues a frame, dropping it if the TX buffer is full
+void queueTelemetryFrame(uint8_t type, const uint8_t payload[], uint8_t length);
+
+// Appends a byte to the TX buffer
+void queueTelemetryByte(uint8_t byte);
+
+// Moves queued bytes to the UART without waiting
+void sendTelemetry();
+
+// Writes a little endian value to buffer, returning the byte after it
+uint8_t *putTelemetryU16(uint8_t *buffer, uint16_t value);
+uint8_t *putTelemetryU32(uint8_t *buffer, uint32_t value);
+
+#else
+#define countTelemetry(counter)
+#define recordTelemetryVerdict(accepted)
+#endif // USE_TELEMETRY
+
+/*******************************************************************************
+ * Dual core related functionality
+ ******************************************************************************/
+#ifdef USE_DUAL_CORE
+
+// The queues live in the top 64 KB of OCM, outside both cores' linker
+// regions, mapped strongly ordered (not cached) on both cores
+#define DUAL_CORE_SHARED_BASE_ADDR   0xFFFF0000
+#define DUAL_CORE_SHARED_ATTRIBUTES  0x14DE2  // S, TEX=b100, AP=b11, no C/B
+
+// CPU1 waits in the boot ROM until an address is written here and an event
+// is sent, then jumps to it
+#define CPU1_START_ADDR_REG  0xFFFFFFF0
+#define IO_CORE_START_ADDR   0x10000000  // CPU1 application (its lscript.ld)
+
+#define STORE_CORE 0  // CPU0
+#define IO_CORE    1  // CPU1
+#define NUM_CORES  2
+
+// Messages per queue (a power of 2)
+#define CORE_QUEUE_SIZE 8
+
+// Keeps the producer and consumer indexes of a queue on separate cache lines
+#define CORE_QUEUE_PADDING 64
+
+// Message types
+typedef enum
+{
+    MESSAGE_PASSCODE = 1,  // I/O core -> store core: handle passcode in mode
+    MESSAGE_RESET,         // I/O core -> store core: reset the store
+    MESSAGE_VERDICT,       // Store core -> I/O core: accepted, numStored
+    MESSAGE_LOAD,          // I/O core -> store core: code set load step
+    MESSAGE_CONSOLE_LINE,  // I/O core -> store core: command and its line
+    MESSAGE_OUTPUT,        // Store core -> I/O core: a line to print
+    MESSAGE_DONE           // Store core -> I/O core: load step or line handled
+} CoreMessageType;
+
+// A console line, or a line of store output (the I/O core owns the UART)
+#define CORE_TEXT_LENGTH 64
+#if defined(USE_CONSOLE_LINES) && ((CONSOLE_LINE_LENGTH + 1) > CORE_TEXT_LENGTH)
+#error "CoreMessage text does not hold a console line"
+#endif
+
+typedef struct
+{
+    uint8_t type;
+    uint8_t mode;
+    uint8_t accepted;
+    uint8_t numStored;
+    uint8_t loadStep;
+    uint8_t command;
+    uint8_t passcode[PASSCODE_LENGTH];
+    char text[CORE_TEXT_LENGTH];
+} CoreMessage;
+
+// Lock-free single producer, single consumer ring. head is only written by
+// the producer and tail only by the consumer (both count messages forever).
+typedef struct
+{
+    uint32_t head;
+    uint8_t headPadding[CORE_QUEUE_PADDING - sizeof(uint32_t)];
+    uint32_t tail;
+    uint8_t tailPadding[CORE_QUEUE_PADDING - sizeof(uint32_t)];
+    CoreMessage messages[CORE_QUEUE_SIZE];
+} CoreQueue;
+
+typedef struct
+{
+    CoreQueue requests;  // I/O core -> store core
+    CoreQueue replies;   // Store core -> I/O core
+} DualCoreSharedMemory;
+
+#ifdef HOST_BUILD
+// The cores are threads sharing this, and WFE/SEV is modelled with a
+// condition variable and one event flag per core
+DualCoreSharedMemory dualCoreSharedMemory;
+#define dualCoreShared (&dualCoreSharedMemory)
+
+pthread_t storeCoreThread;
+pthread_mutex_t coreEventMutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t coreEventCondition = PTHREAD_COND_INITIALIZER;
+bool coreEventRegisters[NUM_CORES];
+#else
+#define dualCoreShared ((DualCoreSharedMemory *)DUAL_CORE_SHARED_BASE_ADDR)
+#endif
+
+// Maps the shared memory and starts the other core
+void initDualCore();
+
+// Runs the store core, handling requests from the I/O core (never returns)
+void runStoreCore();
+
+// Runs runStoreCore() on its own thread
+#ifdef HOST_BUILD
+void *runStoreCoreThread(void *argument);
+#endif
+
+// Has the store core handle passcode and waits for its verdict
+bool requestPasscodeVerdict(uint8_t mode, uint8_t passcode[]);
+
+// Has the store core reset the store
+void requestStoreReset();
+
+#ifdef USE_CODE_SET_LOAD
+// Has the store core carry out a step of a code set load
+void requestPasscodeLoad(uint8_t step, uint8_t passcode[]);
+#endif
+
+#ifdef USE_CONSOLE_LINES
+// Has the store core run a command with its line of arguments
+void requestConsoleLine(uint8_t command, const char line[]);
+#endif
+
+// Waits for the store core to finish a request, printing its output
+void waitForStoreCore();
+
+// Prints an access log line for a handled passcode
+void logPasscodeVerdict(uint8_t mode, bool accepted, uint8_t numStored);
+
+// Sends a message, waiting while the queue is full
+void sendCoreMessage(CoreQueue *queue, const CoreMessage *message);
+
+// Receives a message, waiting while the queue is empty
+void receiveCoreMessage(CoreQueue *queue, CoreMessage *message, uint8_t core);
+
+// Adds a message to a queue if it has room
+bool pushCoreMessage(CoreQueue *queue, const CoreMessage *message);
+
+// Takes the oldest message from a queue if there is one
+bool popCoreMessage(CoreQueue *queue, CoreMessage *message);
+
+// Waits for an event from the other core (WFE)
+void waitForCoreEvent(uint8_t core);
+
+// Sends an event to both cores (SEV)
+void sendCoreEvent();
+
+#endif // USE_DUAL_CORE
+
+/*******************************************************************************
+ * Diagnostics related functionality
+ ******************************************************************************/
+#ifdef USE_DIAGNOSTICS
+
+// Mode button presses within DIAGNOSTICS_SEQUENCE_MS that start diagnostics
+#define DIAGNOSTICS_MODE_PRESSES 5
+#define DIAGNOSTICS_SEQUENCE_MS  4000
+
+// Repetitions of each benchmark
+#define DIAGNOSTICS_AXI_ACCESSES 1000
+#define DIAGNOSTICS_LOOP_PASSES  1000
+#define DIAGNOSTICS_STORE_OPS    100
+
+// Each result is shown on the seven segment display for DIAGNOSTICS_PAGE_MS
+// as its page number (0-9) followed by its value (saturated to 3 digits)
+#define DIAGNOSTICS_PAGE_MS       1500
+#define DIAGNOSTICS_POLL_MS       50
+#define DIAGNOSTICS_MAX_VALUE     999
+#define NUM_DIAGNOSTICS_PAGES     10
+
+// Bytes moved per register access
+#define AXI_ACCESS_BYTES 4
+
+// Cold lookups timed in each memory by the placement benchmark
+#define DIAGNOSTICS_PLACEMENT_LOOKUPS 200
+
+// Waits for earlier register writes to complete
+#ifdef HOST_BUILD
+#define completeRegisterWrites() __asm__ volatile("" ::: "memory")
+#else
+#define completeRegisterWrites() dsb()
+#endif
+
+// The register benchmarked on each AXI slave. Writing back the value read
+// from it leaves the slave unchanged.
+#define NUM_DIAGNOSTICS_SLAVES 4
+const char *DIAGNOSTICS_SLAVE_NAMES[NUM_DIAGNOSTICS_SLAVES] = {
+    "keypad", "button", "led", "seven_segment"
+};
+const UINTPTR DIAGNOSTICS_REGISTERS[NUM_DIAGNOSTICS_SLAVES] = {
+    KEYPAD_BINARY_SLAVE_SCAN_DIVIDER_ADDR,
+    AXILAB_SLAVE_BUTTON_BUTTONS_ADDR,
+    AXILAB_SLAVE_LED_LEDS_ADDR,
+    SEVEN_SEGMENT_DISPLAY_SLAVE_DIGITS_ADDR
+};
+
+// Memories compared by the placement benchmark
+typedef enum
+{
+    PLACEMENT_DDR = 0,
+    PLACEMENT_OCM,
+    NUM_PLACEMENTS
+} Placement;
+
+// Results of a diagnostics run (nanoseconds per operation)
+typedef struct
+{
+    uint32_t readNS[NUM_DIAGNOSTICS_SLAVES];         // Read latency
+    uint32_t writeNS[NUM_DIAGNOSTICS_SLAVES];        // Completed write latency
+    uint32_t postedWriteNS[NUM_DIAGNOSTICS_SLAVES];  // Back-to-back writes
+    uint32_t loopsPerSecond;                         // Main loop polling rate
+    uint32_t findNS;                                 // Absent passcode lookup
+    uint32_t storeNS;
+    uint32_t removeNS;
+    uint32_t lookupMinNS[NUM_PLACEMENTS];            // Cold full store lookup
+    uint32_t lookupMeanNS[NUM_PLACEMENTS];
+    uint32_t lookupMaxNS[NUM_PLACEMENTS];
+} DiagnosticsResults;
+
+// Copies of the store searched by the placement benchmark, one left to
+// the default linker placement (DDR) and one in OCM (with USE_OCM_PLACEMENT)
+uint16_t ddrBenchmarkPasscodes[MAX_NUM_STORED_PASSCODES];
+OCM_DATA uint16_t ocmBenchmarkPasscodes[MAX_NUM_STORED_PASSCODES];
+
+// Key press latency (keypad slave cycles from the key being pressed to the
+// main loop noticing it) since the last diagnostics run
+uint32_t keyLatencyCount;
+uint32_t keyLatencyMinCycles;
+uint32_t keyLatencyMaxCycles;
+uint64_t keyLatencyTotalCycles;
+
+// Recent mode button presses (ring) and the mode before each of them
+uint32_t modePressTimes[DIAGNOSTICS_MODE_PRESSES];
+Mode modePressModes[DIAGNOSTICS_MODE_PRESSES];
+uint8_t modePressNext;    // Ring slot of the next press
+uint8_t modePressCount;   // Presses in the ring (up to DIAGNOSTICS_MODE_PRESSES)
+
+// Records a mode button press, detecting the diagnostics sequence
+bool recordModePress(Mode previousMode, Mode *sequenceStartMode);
+
+// Records the latency of a key press from its hardware timestamp
+void recordKeyLatency(uint32_t cycles);
+
+// Prints the key press latencies over UART and starts counting them again
+void printKeyLatency();
+
+// Runs the benchmarks, reports them and restores restoreMode
+void runDiagnostics(Mode restoreMode);
+
+// Measures register read and write times of an AXI slave
+void benchmarkAXISlave(uint8_t slave, DiagnosticsResults *results);
+
+// Measures the rate of the main loop's input polling
+void benchmarkMainLoop(DiagnosticsResults *results);
+
+// Measures passcode store operation times
+void benchmarkStore(DiagnosticsResults *results);
+
+// Measures cold lookup time spread with the store in DDR and in OCM
+void benchmarkPlacement(DiagnosticsResults *results);
+
+// Prints diagnostics results over UART
+void printDiagnostics(const DiagnosticsResults *results);
+
+// Shows diagnostics results one page at a time on the seven segment display
+void showDiagnostics(const DiagnosticsResults *results);
+
+// Gets the mean nanoseconds per operation since start
+uint32_t getNanosecondsPerOperation(XTime start, uint32_t operations);
+
+// Converts global timer counts for some operations to ns per operation
+uint32_t countsToNanoseconds(XTime counts, uint32_t operations);
+
+#else
+#define recordKeyLatency(cycles)
+#endif // USE_DIAGNOSTICS
+
+/*******************************************************************************
+ * Miscellaneous functionality
+ ******************************************************************************/
+bool previousResetButtonState = false;
+
+// Determines if reset button is pressed
+bool isResetButtonPressed();
+
+// Determines if reset button was released
+bool isResetButtonReleased();
+
+// Determines if mode button has been pressed
+bool isModeButtonPressed();
+
+// Determines if keypad has been pressed
+bool isKeypadPressed();
+
+// Gets the current keypad key pressed
+uint8_t getKeypadValue();
+
+// Sets the keypad scan divider
+void setKeypadScanDivider(uint8_t scanDivider);
+
+// Gets the bitmap of all keypad keys being pressed
+uint32_t getKeypadKeyState();
+
+// Determines if more than one key on the keypad is being pressed
+bool isKeypadRollover();
+
+// Gets the keypad slave clock cycles since the keypad state last changed
+uint32_t getKeypadKeyAge();
+
+// Determines if the keypad key being pressed has just gone down
+bool isNewKeypadPress();
+
+// Records that no key is held (ends the current press)
+void recordKeypadRelease();
+
+// Displays code to seven segment display
+void displayPasscode(uint8_t passcode[]);
+
+// Delay for ms milliseconds
+void delayMS(uint16_t ms);
+
+// Reset the system
+void resetSystem();
+
+// Clear all outputs
+void clearOutputs();
+
+/*
+ * This function is the main function of the project.
+ *
+ * Arguments: None
+ *
+ * Return:
+ * - (int): Integer status of function exit. (0 -> good, anything else -> error)
+ */
+int main(void)
+{
+#ifdef USE_DUAL_CORE
+    // Start the other core. The store core (CPU0 on the target) never returns
+    // from here, the I/O core carries on below.
+    initDualCore();
+#endif
+
+    // Set the keypad scan rate
+    setKeypadScanDivider(DEFAULT_KEYPAD_SCAN_DIVIDER);
+
+#ifdef USE_TICKLESS_IDLE
+    // Set up the interrupts that wake the processor from idle
+    initIdle();
+#endif
+
+#ifdef USE_PROFILER
+    // Start the cycle counter
+    initProfiler();
+#endif
+
+    // Reset passcodes and current mode
+    resetSystem();
+
+    while (true)  // Main program execution loop
+    {
+#ifdef USE_CONSOLE_COMMANDS
+        handleConsoleCommand();  // Run a command received over UART
+#endif
+
+#ifdef USE_TELEMETRY
+        serviceTelemetry();  // Send telemetry without blocking
+#endif
+
+        serviceStatusFlash();  // Flash the last verdict without blocking
+
+#ifndef USE_DUAL_CORE
+        // Move the rolling code window on at each time step, ahead of the
+        // checks (the store core otherwise does it before its next check)
+        serviceRollingCodes();
+
+        // Blank what the last store reset left behind, a little at a time
+        sweepStoredPasscodes();
+#endif
+
+        if (isResetButtonPressed())  // Is reset button being held down?
+        {
+            clearOutputs();  // Clear all outputs
+        }
+
+        if (isResetButtonReleased())  // Is reset button being released (falling edge)?
+        {
+            resetSystem();                     // Reset passcodes and mode
+            delayMS(250);                      // Delay program
+            flashStatusLED(LED_1_GREEN_MASK);  // Flash green status led
+        }
+        else if (isModeButtonPressed())  // Is mode button being pressed?
+        {
+#ifdef USE_DIAGNOSTICS
+            Mode previousMode = currentMode;
+#endif
+            toggleMode();  // Toggle the current mode and reset passcode
+            delayMS(500);  // Delay 500 ms
+
+#ifdef USE_DIAGNOSTICS
+            // Was this the last press of the diagnostics sequence?
+            Mode sequenceStartMode;
+            if (recordModePress(previousMode, &sequenceStartMode))
+            {
+                runDiagnostics(sequenceStartMode);
+            }
+#endif
+        }
+        else if (isFunctionKeyPressed())  // Is a function key being pressed?
+        {
+            handleFunctionKey();  // Select a mode or edit the passcode
+        }
+#ifdef USE_ENROLLMENT_SESSION
+        else if (currentMode == MODE_2_SET_CODE)
+        {
+            handleEnrollmentInput();  // Take codes back-to-back
+        }
+#endif
+        else if (isKeypadPressed() &&  // Is a key on keypad being pressed?
+                 !isKeypadRollover())  // (Ignore ambiguous multi-key presses)
+        {
+            // Time since the keypad slave saw the key go down
+            recordKeyLatency(getKeypadKeyAge());
+
+            // Add to currentPasscode
+            storeCurrentPasscodeDigit(getKeypadValue());
+            countTelemetry(telemetryKeyPresses);
+
+            // Delay program to prevent same press being registered constantly
+            delayMS(450);
+
+            // Check if full passcode has been entered
+            if (isCurrentPasscodeComplete())
+            {
+#ifdef USE_DUAL_CORE
+                // Let the store core check, store or remove it
+                bool accepted = requestPasscodeVerdict(currentMode,
+                                                       currentPasscode);
+#else
+                bool accepted = handlePasscode(currentMode, currentPasscode);
+#endif
+
+                // Flash green (accepted) or red (rejected) status led
+                flashStatusLED(accepted ? LED_1_GREEN_MASK : LED_1_RED_MASK);
+                recordTelemetryVerdict(accepted);
+
+                resetCurrentPasscode();  // Reset current passcode
+            }
+        }
+        else if (!isKeypadPressed())
+        {
+            recordKeypadRelease();  // The next key to go down is a new press
+        }
+
+#ifdef USE_TICKLESS_IDLE
+        // Sleep until a key or button is pressed
+        if (!isInputActive())
+        {
+            // (The next key may go down before the loop runs again)
+            recordKeypadRelease();
+
+#ifdef USE_TELEMETRY
+            // (or the next telemetry frame is due)
+            uint32_t timeoutMS = getTelemetryTimeoutMS();
+#else
+            uint32_t timeoutMS = IDLE_TIMEOUT_MS;
+#endif
+            // (or the status led flash changes, the next time step starts or
+            // the next characters of a console command arrive)
+            timeoutMS = limitStatusFlashTimeoutMS(timeoutMS);
+            timeoutMS = limitConsoleTimeoutMS(timeoutMS);
+            waitForEvent(EVENT_INPUT, limitRollingCodeTimeoutMS(timeoutMS));
+        }
+#endif
+
+#ifdef MEASURE_IDLE_TIME
+        reportIdleTime();
+#endif
+    }
+
+    // Return with no errors
+    return 0;
+}
+
+/*
+ * This function checks, stores or removes a complete passcode depending on
+ * the mode it was entered in.
+ *
+ * Param: mode: The mode the passcode was entered in.
+ * Param: passcode: The complete passcode.
+ * Return: (bool): Passcode valid (MODE_1), stored (MODE_2, MODE_4) or removed
+ *                 (MODE_3)?
+ */
+OCM_CODE bool handlePasscode(uint8_t mode, uint8_t passcode[])
+{
+    // Drop expired passcodes first (lookups never check expiry)
+    expirePasscodes();
+
+    switch (mode)
+    {
+        case MODE_1_CHECK_CODE:
+            // (Only computes codes if the window is behind the time step)
+            serviceRollingCodes();
+
+            return (isMasterPasscode(passcode) ||
+                    isRollingCode(passcode) ||
+                    checkPasscode(passcode, KEYPAD_ZONE));
+        case MODE_2_SET_CODE:
+            return (insertPasscode(passcode) == STORE_INSERTED);
+        case MODE_3_REMOVE_CODE:
+            return (erasePasscode(passcode) == STORE_REMOVED);
+        case MODE_4_SET_TEMP_CODE:
+            return (insertTemporaryPasscode(passcode,
+                                            TEMPORARY_PASSCODE_LIFETIME_S) ==
+                    STORE_INSERTED);
+        default:
+            return false;
+    }
+}
+
+/*
+ * This function toggles the current mode.
+ *
+ * Return: None (void)
+ */
+void toggleMode()
+{
+    // Toggle the current mode
+    switch (currentMode)
+    {
+        case MODE_1_CHECK_CODE:
+            setMode(MODE_2_SET_CODE);    // Change mode to check mode
+            break;
+        case MODE_2_SET_CODE:
+            setMode(MODE_3_REMOVE_CODE);    // Change mode to set mode
+            break;
+        case MODE_3_REMOVE_CODE:
+            setMode(MODE_4_SET_TEMP_CODE);  // Change mode to temporary set mode
+            break;
+        case MODE_4_SET_TEMP_CODE:
+            setMode(MODE_1_CHECK_CODE);  // Change mode to check mode
+            break;
+        default:
+            setMode(DEFAULT_MODE);
+            break;
+    }
+}
+
+/*
+ * This function sets the current mode, changes mode led, and
+ * resets current entry code.
+ *
+ * Return: None (void)
+ */
+void setMode(Mode mode)
+{
+#ifdef USE_ENROLLMENT_SESSION
+    // Leaving MODE_2_SET_CODE ends the enrollment session
+    if ((currentMode == MODE_2_SET_CODE) && (mode != MODE_2_SET_CODE))
+    {
+        commitEnrollmentSession();
+    }
+    statusFlashPhase = 0;
+#endif
+
+    // Set the current mode
+    currentMode = mode;
+
+    // Set the mode LED to the current mode color
+    setModeLED();
+
+    // Reset currentPasscode to null values of 0xF
+    resetCurrentPasscode();
+}
+
+/*
+ * This function toggles the current mode backwards (the reverse of
+ * toggleMode()).
+ *
+ * Return: None (void)
+ */
+void toggleModeBackward()
+{
+    // Toggle the current mode backwards
+    switch (currentMode)
+    {
+        case MODE_1_CHECK_CODE:
+            setMode(MODE_4_SET_TEMP_CODE);  // Change mode to temporary set mode
+            break;
+        case MODE_2_SET_CODE:
+            setMode(MODE_1_CHECK_CODE);     // Change mode to check mode
+            break;
+        case MODE_3_REMOVE_CODE:
+            setMode(MODE_2_SET_CODE);       // Change mode to set mode
+            break;
+        case MODE_4_SET_TEMP_CODE:
+            setMode(MODE_3_REMOVE_CODE);    // Change mode to remove mode
+            break;
+        default:
+            setMode(DEFAULT_MODE);
+            break;
+    }
+}
+
+/*
+ * This function determines if a keypad function key (A-F, H or L) is being
+ * pressed rather than a digit.
+ *
+ * Return: (bool): Function key is being pressed?
+ */
+bool isFunctionKeyPressed()
+{
+    uint8_t key = getKeypadValue();
+    return ((key != KEYPAD_NO_KEY) && (key >= KEYPAD_KEY_A));
+}
+
+/*
+ * This function acts on a keypad function key once per press. A-D select a
+ * mode directly and H and L step through them like the mode button, so any
+ * mode is one press away. E clears the current passcode and F deletes its
+ * last digit.
+ *
+ * Return: None (void)
+ */
+void handleFunctionKey()
+{
+    // Held since the last call, bouncing, or ambiguous multi-key press?
+    if (!isNewKeypadPress() || isKeypadRollover()) { return; }
+
+    uint8_t key = getKeypadValue();
+    switch (key)
+    {
+        case KEYPAD_KEY_A:
+        case KEYPAD_KEY_B:
+        case KEYPAD_KEY_C:
+        case KEYPAD_KEY_D:
+            // (Keys A-D line up with MODE_1-MODE_4)
+            setMode((Mode)(MODE_1_CHECK_CODE + (key - KEYPAD_KEY_A)));
+            break;
+        case KEYPAD_KEY_E:
+            resetCurrentPasscode();
+            break;
+        case KEYPAD_KEY_F:
+            if (currentPasscodeIndex > 0)
+            {
+                currentPasscode[--currentPasscodeIndex] = 0xF;
+                displayPasscode(currentPasscode);
+            }
+            break;
+        case KEYPAD_KEY_H:
+            toggleMode();
+            break;
+        case KEYPAD_KEY_L:
+            toggleModeBackward();
+            break;
+        default:
+            break;
+    }
+}
+
+/*
+ * This function resets the store in constant time, whatever its size.
+ * Nothing is cleared: the store and the expiry wheel move to a new generation
+ * and sweepStoredPasscodes() cleans the wheel slots left behind later on.
+ *
+ * Return: None (void)
+ */
+void resetStoredPasscodes()
+{
+    // Start a new generation (searches stop at the index)
+    storeEpoch++;
+    liveStore->numPasscodes = 0;
+
+    // Drop all expiry timers and recency
+    resetExpiryWheel();
+    resetLRUList();
+
+#ifdef USE_PASSCODE_CAM
+    commandPasscodeCAM(PASSCODE_CAM_SLAVE_CMD_OP_CLEAR, 0);
+#endif
+}
+
+/*
+ * This function sweeps up to STORE_SWEEP_ENTRIES wheel slots that the last
+ * reset left behind. It is called when the store is not busy, so a reset
+ * costs the same at any store size.
+ *
+ * Return: None (void)
+ */
+void sweepStoredPasscodes()
+{
+    sweepExpiryWheel(STORE_SWEEP_ENTRIES);
+}
+
+/*
+ * This function resets currentPasscode.
+ *
+ * Return: None (void)
+ */
+void resetCurrentPasscode()
+{
+    // Clear current passcode
+    memset(currentPasscode, 0xF, sizeof(currentPasscode[0]) * PASSCODE_LENGTH);
+    currentPasscodeIndex = 0;
+
+    // Display the current passcode to the seven segment display
+    displayPasscode(currentPasscode);
+}
+
+/*
+ * This function stores passcode to the store unless it is the master
+ * passcode, is already stored or there is no room.
+ *
+ * Param: passcode: The passcode to store.
+ * Return: (StoreStatus): STORE_INSERTED, STORE_MASTER, STORE_DUPLICATE or
+ *                        STORE_FULL.
+ */
+StoreStatus insertPasscode(uint8_t passcode[])
+{
+    return insertPackedPasscode(packPasscode(passcode));
+}
+
+/*
+ * This function stores a packed passcode to the store unless it is the
+ * master passcode, is already stored or there is no room. The store is
+ * probed once for the passcode (see probePasscode), instead of separate
+ * master, existing and full checks before a store that checks fullness
+ * again.
+ *
+ * Param: packedPasscode: The packed passcode to store.
+ * Return: (StoreStatus): STORE_INSERTED, STORE_MASTER, STORE_DUPLICATE or
+ *                        STORE_FULL.
+ */
+StoreStatus insertPackedPasscode(uint16_t packedPasscode)
+{
+    StoreStatus status = probePasscode(liveStore, packedPasscode);
+    if (status != STORE_ABSENT) { return status; }
+
+    return (storePackedPasscode(packedPasscode) ? STORE_INSERTED : STORE_FULL);
+}
+
+/*
+ * This function probes a bank once for a packed passcode. Every path that
+ * adds passcodes to a bank starts with it, so each takes one lookup (one
+ * CAM round trip for the live bank with the CAM) and gets one StoreStatus.
+ *
+ * Param: bank: The bank to probe.
+ * Param: packedPasscode: The packed passcode.
+ * Return: (StoreStatus): STORE_MASTER, STORE_DUPLICATE (stored) or
+ *                        STORE_ABSENT.
+ */
+OCM_CODE StoreStatus probePasscode(const PasscodeBank *bank,
+                                   uint16_t packedPasscode)
+{
+    if (packedPasscode == MASTER_PACKED_PASSCODE) { return STORE_MASTER; }
+    if (findBankPasscode(bank, packedPasscode) != PASSCODE_NOT_FOUND)
+    {
+        return STORE_DUPLICATE;
+    }
+    return STORE_ABSENT;
+}
+
+/*
+ * This function stores a packed passcode to the store. It does not
+ * check for the passcode being stored already, so callers must know it is
+ * not (see insertPackedPasscode and commitEnrollmentSession).
+ *
+ * Param: packedPasscode: The packed passcode to store.
+ * Return: (bool): Passcode stored successfully (false if full)?
+ */
+bool storePackedPasscode(uint16_t packedPasscode)
+{
+    // Ensure the store is not full
+    if (isStoredPasscodesFull())
+    {
+#ifdef USE_LRU_EVICTION
+        evictLeastRecentlyUsedPasscode();
+#else
+        return false;
+#endif
+    }
+
+    // Add passcode with default attributes and increment index
+    uint8_t index = liveStore->numPasscodes++;
+    setPasscodeBankSlot(liveStore, index, packedPasscode);
+    pushLRUEntry(index);
+
+#ifdef USE_PASSCODE_CAM
+    insertPasscodeCAM(packedPasscode, index);
+#endif
+
+    return true;
+}
+
+/*
+ * This function sets a slot of a bank to a packed passcode with the default
+ * attributes (a permanent user passcode stored from the keypad, never used).
+ *
+ * Param: bank: The bank.
+ * Param: index: The slot.
+ * Param: packedPasscode: The packed passcode.
+ * Return: None (void)
+ */
+void setPasscodeBankSlot(PasscodeBank *bank, uint8_t index,
+                         uint16_t packedPasscode)
+{
+    bank->passcodes[index] = packedPasscode;
+    bank->roles[index] = ROLE_USER;
+    bank->zones[index] = ALL_ZONES_MASK;
+    bank->useCounts[index] = 0;
+    bank->lastUsed[index] = NEVER_USED;
+    bank->creators[index] = CREATOR_KEYPAD;
+    bank->timers[index] = NO_TIMER;
+}
+
+/*
+ * This function removes passcode from the store if it is stored. The
+ * one probe finds the slot to remove, so there is no separate existence check.
+ *
+ * Param: passcode: The passcode to remove.
+ * Return: (StoreStatus): STORE_REMOVED, STORE_MASTER or STORE_ABSENT.
+ */
+StoreStatus erasePasscode(uint8_t passcode[])
+{
+    PROFILE_FUNCTION(PROFILE_ERASE_PASSCODE);
+
+    if (isMasterPasscode(passcode)) { return STORE_MASTER; }
+
+    // Find passcode index and remove it
+    int index = findPasscode(packPasscode(passcode));
+    if (index == PASSCODE_NOT_FOUND) { return STORE_ABSENT; }
+
+    removeStoredPasscodeAt(index);
+    return STORE_REMOVED;
+}
+
+/*
+ * This function stores passcode to the store until lifetimeS seconds
+ * from now, when expirePasscodes() removes it again. It is stored on the same
+ * terms as insertPasscode.
+ *
+ * Param: passcode: The passcode to store.
+ * Param: lifetimeS: Seconds until the passcode expires (1 to WHEEL_RANGE_S-1).
+ * Return: (StoreStatus): STORE_INSERTED, STORE_MASTER, STORE_DUPLICATE or
+ *                        STORE_FULL.
+ */
+StoreStatus insertTemporaryPasscode(uint8_t passcode[], uint32_t lifetimeS)
+{
+    // Bring the wheel up to date so the lifetime counts from now
+    expirePasscodes();
+
+    StoreStatus status = insertPasscode(passcode);
+    if (status != STORE_INSERTED) { return status; }
+
+    // Keep the expiry within the range of the wheel
+    if (lifetimeS < 1) { lifetimeS = 1; }
+    if (lifetimeS >= WHEEL_RANGE_S) { lifetimeS = WHEEL_RANGE_S - 1; }
+
+    // Take a freed timer, or one not used since the reset (there is one for
+    // every store slot)
+    uint8_t timer = freeExpiryTimers;
+    if (timer != NO_TIMER) { freeExpiryTimers = expiryTimers[timer].next; }
+    else { timer = usedExpiryTimers++; }
+    numExpiryTimers++;
+
+    expiryTimers[timer].expiryTime = expiryWheelTime + lifetimeS;
+    expiryTimers[timer].storeIndex = liveStore->numPasscodes - 1;
+    liveStore->timers[liveStore->numPasscodes - 1] = timer;
+    liveStore->roles[liveStore->numPasscodes - 1] = ROLE_TEMPORARY;
+    scheduleExpiryTimer(timer);
+
+    return STORE_INSERTED;
+}
+
+/*
+ * This function removes the passcode at index from the store by moving
+ * the last passcode into its place.
+ *
+ * Param: index: The index of the passcode to remove.
+ * Return: None (void)
+ */
+void removeStoredPasscodeAt(uint8_t index)
+{
+    uint8_t last = liveStore->numPasscodes - 1;
+
+#ifdef USE_PASSCODE_CAM
+    commandPasscodeCAM(PASSCODE_CAM_SLAVE_CMD_OP_DELETE, liveStore->passcodes[index]);
+#endif
+
+    // Drop the passcode's expiry timer and recency
+    if (liveStore->timers[index] != NO_TIMER)
+    {
+        cancelExpiryTimer(liveStore->timers[index]);
+    }
+    unlinkLRUEntry(index);
+
+    // Move the last passcode (and its attributes and timer) into the gap
+    liveStore->passcodes[index] = liveStore->passcodes[last];
+    liveStore->roles[index] = liveStore->roles[last];
+    liveStore->zones[index] = liveStore->zones[last];
+    liveStore->useCounts[index] = liveStore->useCounts[last];
+    liveStore->lastUsed[index] = liveStore->lastUsed[last];
+    liveStore->creators[index] = liveStore->creators[last];
+    liveStore->timers[index] = liveStore->timers[last];
+    if (liveStore->timers[index] != NO_TIMER)
+    {
+        expiryTimers[liveStore->timers[index]].storeIndex = index;
+    }
+    if (index != last) { moveLRUEntry(last, index); }
+#ifdef USE_PASSCODE_CAM
+    // Retag the moved passcode with its new index
+    if (index != last)
+    {
+        commandPasscodeCAM(PASSCODE_CAM_SLAVE_CMD_OP_DELETE, liveStore->passcodes[index]);
+        insertPasscodeCAM(liveStore->passcodes[index], index);
+    }
+#endif
+
+    // Blank out last code
+    liveStore->numPasscodes--;
+    liveStore->passcodes[last] = BLANK_PACKED_PASSCODE;
+}
+
+/*
+ * This function advances the timing wheel to the current second and removes
+ * the passcodes of every timer that expired on the way. Each timer is moved
+ * down at most once per level, so expiry never scans the store, and seconds
+ * with no timer to expire or cascade are skipped, so catching up after a long
+ * idle costs a few steps per timer rather than one per second.
+ *
+ * Return: None (void)
+ */
+void expirePasscodes()
+{
+    uint32_t now = getTimeSeconds();
+
+    while ((int32_t)(now - expiryWheelTime) > 0)
+    {
+        // Nothing can expire, skip ahead
+        if (numExpiryTimers == 0)
+        {
+            expiryWheelTime = now;
+            break;
+        }
+
+        // Nothing to do before the next occupied slot comes round
+        uint32_t nextTime = getNextExpiryWheelTime();
+        if ((int32_t)(nextTime - now) > 0)
+        {
+            expiryWheelTime = now;
+            break;
+        }
+        expiryWheelTime = nextTime;
+
+        // When a level wraps, move the next slot of the level above down
+        for (uint8_t level = 1; level < WHEEL_LEVELS; level++)
+        {
+            if (expiryWheelTime & ((1UL << (level * WHEEL_SLOT_BITS)) - 1))
+            {
+                break;
+            }
+            cascadeExpiryWheel(level);
+        }
+
+        // Remove the passcodes expiring this second
+        uint8_t slot = (expiryWheelTime & WHEEL_SLOT_MASK);
+        while (getExpiryWheelSlot(slot) != NO_TIMER)
+        {
+            removeStoredPasscodeAt(expiryTimers[getExpiryWheelSlot(slot)].storeIndex);
+            countTelemetry(telemetryExpiredPasscodes);
+        }
+    }
+}
+
+/*
+ * This function empties every wheel slot and frees every expiry timer in
+ * constant time: the slots of the previous store generation read as empty
+ * (see getExpiryWheelSlot) and timers are handed out afresh from the first.
+ * Stored passcodes get their timer slot set when they are stored.
+ *
+ * Return: None (void)
+ */
+void resetExpiryWheel()
+{
+    freeExpiryTimers = NO_TIMER;
+    usedExpiryTimers = 0;
+    numExpiryTimers = 0;
+    memset(expiryWheelOccupied, 0, sizeof(expiryWheelOccupied));
+
+    // Sweep a few slots now, so no slot is left stale for 256 generations
+    staleExpiryWheelSlots = WHEEL_TOTAL_SLOTS;
+    sweepExpiryWheel(WHEEL_SWEEP_SLOTS_PER_RESET);
+
+    expiryWheelTime = getTimeSeconds();
+}
+
+/*
+ * This function gets the first timer of a wheel slot. A slot last written in
+ * an earlier store generation is empty.
+ *
+ * Param: slot: The wheel slot.
+ * Return: (uint8_t): First timer of the slot (NO_TIMER if empty).
+ */
+uint8_t getExpiryWheelSlot(uint8_t slot)
+{
+    if (expiryWheelEpochs[slot] != storeEpoch) { return NO_TIMER; }
+    return expiryWheel[slot];
+}
+
+/*
+ * This function sets the first timer of a wheel slot, in the current store
+ * generation.
+ *
+ * Param: slot: The wheel slot.
+ * Param: timer: The first timer (NO_TIMER to empty the slot).
+ * Return: None (void)
+ */
+void setExpiryWheelSlot(uint8_t slot, uint8_t timer)
+{
+    expiryWheel[slot] = timer;
+    expiryWheelEpochs[slot] = storeEpoch;
+
+    uint64_t slotMask = (1ULL << (slot & WHEEL_SLOT_MASK));
+    if (timer == NO_TIMER)
+    {
+        expiryWheelOccupied[slot / WHEEL_SLOTS] &= ~slotMask;
+    }
+    else
+    {
+        expiryWheelOccupied[slot / WHEEL_SLOTS] |= slotMask;
+    }
+}
+
+/*
+ * This function gets the next second after expiryWheelTime at which a timer
+ * expires or an occupied slot cascades. Level n next does something at the
+ * start of its next occupied slot, found from its occupancy bitmap with one
+ * count of trailing zeros; the seconds before the earliest of these can be
+ * skipped.
+ *
+ * Return: (uint32_t): The next second with work for the wheel.
+ */
+uint32_t getNextExpiryWheelTime()
+{
+    uint32_t untilNext = WHEEL_RANGE_S;
+    for (uint8_t level = 0; level < WHEEL_LEVELS; level++)
+    {
+        uint64_t occupied = expiryWheelOccupied[level];
+        if (occupied == 0) { continue; }
+
+        // Rotate the bitmap to start at the slot after the current one
+        uint8_t shift = level * WHEEL_SLOT_BITS;
+        uint32_t block = (expiryWheelTime >> shift);
+        uint8_t start = ((block + 1) & WHEEL_SLOT_MASK);
+        if (start != 0)
+        {
+            occupied = (occupied >> start) | (occupied << (WHEEL_SLOTS - start));
+        }
+
+        uint32_t levelTime = (block + 1 + __builtin_ctzll(occupied)) << shift;
+        if ((levelTime - expiryWheelTime) < untilNext)
+        {
+            untilNext = levelTime - expiryWheelTime;
+        }
+    }
+    return expiryWheelTime + untilNext;
+}
+
+/*
+ * This function empties up to numSlots wheel slots of earlier store
+ * generations, going round the wheel from where the last sweep stopped.
+ *
+ * Param: numSlots: Most slots to sweep.
+ * Return: None (void)
+ */
+void sweepExpiryWheel(uint16_t numSlots)
+{
+    for (; (numSlots > 0) && (staleExpiryWheelSlots > 0);
+         numSlots--, staleExpiryWheelSlots--)
+    {
+        if (expiryWheelEpochs[expiryWheelSweepSlot] != storeEpoch)
+        {
+            setExpiryWheelSlot(expiryWheelSweepSlot, NO_TIMER);
+        }
+        expiryWheelSweepSlot = (expiryWheelSweepSlot + 1) % WHEEL_TOTAL_SLOTS;
+    }
+}
+
+/*
+ * This function links a timer into the slot for its expiry time. The level is
+ * the lowest one whose range covers the time left; timers due now go into
+ * the level 0 slot being processed.
+ *
+ * Param: timer: The timer to schedule.
+ * Return: None (void)
+ */
+void scheduleExpiryTimer(uint8_t timer)
+{
+    ExpiryTimer *expiryTimer = &expiryTimers[timer];
+    uint32_t timeLeft = expiryTimer->expiryTime - expiryWheelTime;
+
+    // Find the level and slot index
+    uint8_t level = 0;
+    while ((level < (WHEEL_LEVELS - 1)) &&
+           (timeLeft >= (1UL << ((level + 1) * WHEEL_SLOT_BITS))))
+    {
+        level++;
+    }
+    uint8_t slot = (level * WHEEL_SLOTS) +
+                   ((expiryTimer->expiryTime >> (level * WHEEL_SLOT_BITS)) &
+                    WHEEL_SLOT_MASK);
+
+    // Push onto the front of the slot
+    expiryTimer->slot = slot;
+    expiryTimer->prev = NO_TIMER;
+    expiryTimer->next = getExpiryWheelSlot(slot);
+    if (expiryTimer->next != NO_TIMER)
+    {
+        expiryTimers[expiryTimer->next].prev = timer;
+    }
+    setExpiryWheelSlot(slot, timer);
+}
+
+/*
+ * This function unlinks a timer from its wheel slot and frees it.
+ *
+ * Param: timer: The timer to cancel.
+ * Return: None (void)
+ */
+void cancelExpiryTimer(uint8_t timer)
+{
+    ExpiryTimer *expiryTimer = &expiryTimers[timer];
+
+    if (expiryTimer->prev == NO_TIMER)
+    {
+        setExpiryWheelSlot(expiryTimer->slot, expiryTimer->next);
+    }
+    else
+    {
+        expiryTimers[expiryTimer->prev].next = expiryTimer->next;
+    }
+    if (expiryTimer->next != NO_TIMER)
+    {
+        expiryTimers[expiryTimer->next].prev = expiryTimer->prev;
+    }
+
+    expiryTimer->next = freeExpiryTimers;
+    freeExpiryTimers = timer;
+    numExpiryTimers--;
+}
+
+/*
+ * This function reschedules every timer in the current slot of a level. They
+ * expire within the next 64^level seconds, so each lands on a lower level.
+ *
+ * Param: level: The level to cascade (1 to WHEEL_LEVELS - 1).
+ * Return: None (void)
+ */
+void cascadeExpiryWheel(uint8_t level)
+{
+    uint8_t slot = (level * WHEEL_SLOTS) +
+                   ((expiryWheelTime >> (level * WHEEL_SLOT_BITS)) &
+                    WHEEL_SLOT_MASK);
+
+    uint8_t timer = getExpiryWheelSlot(slot);
+    setExpiryWheelSlot(slot, NO_TIMER);
+    while (timer != NO_TIMER)
+    {
+        uint8_t next = expiryTimers[timer].next;
+        scheduleExpiryTimer(timer);
+        timer = next;
+    }
+}
+
+/*
+ * This function gets the time since boot from the global timer.
+ *
+ * Return: (uint32_t): Seconds since boot.
+ */
+uint32_t getTimeSeconds()
+{
+    XTime now;
+    XTime_GetTime(&now);
+    return (uint32_t)(now / COUNTS_PER_SECOND);
+}
+
+/*
+ * This function gets the time since boot in milliseconds from the global
+ * timer.
+ *
+ * Return: (uint32_t): Milliseconds since boot.
+ */
+uint32_t getTimeMS()
+{
+    XTime now;
+    XTime_GetTime(&now);
+    return (uint32_t)(now / (COUNTS_PER_SECOND / 1000));
+}
+
+#ifdef USE_LRU_EVICTION
+/*
+ * This function empties the recency list.
+ *
+ * Return: None (void)
+ */
+void resetLRUList()
+{
+    lruHead = NO_LRU_ENTRY;
+    lruTail = NO_LRU_ENTRY;
+}
+
+/*
+ * This function links the passcode at index in at the head of the recency
+ * list (most recently used).
+ *
+ * Param: index: The index of the passcode in the store.
+ * Return: None (void)
+ */
+void pushLRUEntry(uint8_t index)
+{
+    storedPasscodeLRUPrev[index] = NO_LRU_ENTRY;
+    storedPasscodeLRUNext[index] = lruHead;
+    if (lruHead != NO_LRU_ENTRY)
+    {
+        storedPasscodeLRUPrev[lruHead] = index;
+    }
+    else
+    {
+        lruTail = index;
+    }
+    lruHead = index;
+}
+
+/*
+ * This function unlinks the passcode at index from the recency list.
+ *
+ * Param: index: The index of the passcode in the store.
+ * Return: None (void)
+ */
+void unlinkLRUEntry(uint8_t index)
+{
+    uint8_t prev = storedPasscodeLRUPrev[index];
+    uint8_t next = storedPasscodeLRUNext[index];
+
+    if (prev == NO_LRU_ENTRY) { lruHead = next; }
+    else { storedPasscodeLRUNext[prev] = next; }
+
+    if (next == NO_LRU_ENTRY) { lruTail = prev; }
+    else { storedPasscodeLRUPrev[next] = prev; }
+}
+
+/*
+ * This function moves the passcode at index to the head of the recency list.
+ *
+ * Param: index: The index of the passcode in the store.
+ * Return: None (void)
+ */
+void touchLRUEntry(uint8_t index)
+{
+    if (index == lruHead) { return; }
+
+    unlinkLRUEntry(index);
+    pushLRUEntry(index);
+}
+
+/*
+ * This function relinks the recency list entry of a passcode that was moved
+ * within the store (see removeStoredPasscodeAt), keeping its place in
+ * the list. The entry at to must already be unlinked.
+ *
+ * Param: from: The old index of the passcode.
+ * Param: to: The new index of the passcode.
+ * Return: None (void)
+ */
+void moveLRUEntry(uint8_t from, uint8_t to)
+{
+    uint8_t prev = storedPasscodeLRUPrev[from];
+    uint8_t next = storedPasscodeLRUNext[from];
+    storedPasscodeLRUPrev[to] = prev;
+    storedPasscodeLRUNext[to] = next;
+
+    if (prev == NO_LRU_ENTRY) { lruHead = to; }
+    else { storedPasscodeLRUNext[prev] = to; }
+
+    if (next == NO_LRU_ENTRY) { lruTail = to; }
+    else { storedPasscodeLRUPrev[next] = to; }
+}
+
+/*
+ * This function removes the passcode at the tail of the recency list, the one
+ * stored or checked longest ago.
+ *
+ * Return: None (void)
+ */
+void evictLeastRecentlyUsedPasscode()
+{
+    if (lruTail == NO_LRU_ENTRY) { return; }
+
+    removeStoredPasscodeAt(lruTail);
+}
+#endif // USE_LRU_EVICTION
+
+#ifdef USE_PASSCODE_CAM
+/*
+ * This function waits for the CAM's verdict on the passcode in its CODE
+ * register, and the result of any pending command, to become valid.
+ *
+ * Return: (u32): The CAM status register.
+ */
+u32 waitPasscodeCAMStatus()
+{
+    u32 status;
+    do
+    {
+        status = PASSCODE_CAM_SLAVE_ReadStatus();
+    } while (!(status & PASSCODE_CAM_SLAVE_STATUS_VALID_MASK));
+
+    return status;
+}
+
+/*
+ * This function applies a command to a packed passcode in the CAM and waits
+ * for it to complete.
+ *
+ * Param: command: The command (PASSCODE_CAM_SLAVE_CMD_OP_*).
+ * Param: packedPasscode: The packed passcode (ignored by a clear).
+ * Return: (u32): The CAM status register.
+ */
+u32 commandPasscodeCAM(u32 command, uint16_t packedPasscode)
+{
+    PASSCODE_CAM_SLAVE_WriteCode(packedPasscode);
+    PASSCODE_CAM_SLAVE_WriteCmd(command);
+    return waitPasscodeCAMStatus();
+}
+
+/*
+ * This function inserts a packed passcode into the CAM. The CAM keeps the
+ * store index as the tag of the entry and returns it on a match.
+ *
+ * Param: packedPasscode: The packed passcode.
+ * Param: index: The index of the passcode in the live bank.
+ * Return: (u32): The CAM status register.
+ */
+u32 insertPasscodeCAM(uint16_t packedPasscode, uint8_t index)
+{
+    PASSCODE_CAM_SLAVE_WriteCode(packedPasscode |
+                                 ((u32)index << PASSCODE_CAM_SLAVE_CODE_TAG_SHIFT));
+    PASSCODE_CAM_SLAVE_WriteCmd(PASSCODE_CAM_SLAVE_CMD_OP_INSERT);
+    return waitPasscodeCAMStatus();
+}
+
+/*
+ * This function looks a packed passcode up in the CAM (constant time). The
+ * match carries the tag the passcode was inserted with, its store index.
+ *
+ * Param: packedPasscode: The packed passcode.
+ * Return: (int): Index of the passcode (PASSCODE_NOT_FOUND if not stored).
+ */
+OCM_CODE int lookupPasscodeCAM(uint16_t packedPasscode)
+{
+    PASSCODE_CAM_SLAVE_WriteCode(packedPasscode);
+    u32 status = waitPasscodeCAMStatus();
+    if (!(status & PASSCODE_CAM_SLAVE_STATUS_MATCH_MASK))
+    {
+        return PASSCODE_NOT_FOUND;
+    }
+    return ((status & PASSCODE_CAM_SLAVE_STATUS_TAG_MASK) >>
+            PASSCODE_CAM_SLAVE_STATUS_TAG_SHIFT);
+}
+#endif // USE_PASSCODE_CAM
+
+#ifdef USE_ENROLLMENT_SESSION
+/*
+ * This function reads the keypad in an enrollment session. A digit is taken
+ * on the press edge of a key instead of after a fixed delay, and a complete
+ * code is enrolled at once: its verdict flashes in the background and stays
+ * on the display until the first digit of the next code.
+ *
+ * Return: None (void)
+ */
+void handleEnrollmentInput()
+{
+    // Released, held since the last call, or bouncing just after a release?
+    if (!isNewKeypadPress()) { return; }
+
+    // (Ignore ambiguous multi-key presses)
+    if (isKeypadRollover()) { return; }
+
+    // Time since the keypad slave saw the key go down
+    recordKeyLatency(getKeypadKeyAge());
+
+    // Add to currentPasscode
+    storeCurrentPasscodeDigit(getKeypadValue());
+    countTelemetry(telemetryKeyPresses);
+
+    if (isCurrentPasscodeComplete())
+    {
+        bool accepted = (enrollPasscode(currentPasscode) == STORE_INSERTED);
+
+        // Flash green (accepted) or red (rejected) status led
+        startStatusFlash(accepted ? LED_1_GREEN_MASK : LED_1_RED_MASK);
+        recordTelemetryVerdict(accepted);
+
+        // Start the next code, leaving this one on the display
+        memset(currentPasscode, 0xF, sizeof(currentPasscode[0]) * PASSCODE_LENGTH);
+        currentPasscodeIndex = 0;
+    }
+}
+
+/*
+ * This function adds a complete passcode to enrollmentBatch, keeping it
+ * sorted. It accepts the same passcodes handlePasscode() would store in
+ * MODE_2_SET_CODE (see insertPasscode), counting the batch as already stored.
+ *
+ * Param: passcode: The passcode to enroll.
+ * Return: (StoreStatus): STORE_INSERTED (into the batch), STORE_MASTER,
+ *                        STORE_DUPLICATE or STORE_FULL.
+ */
+StoreStatus enrollPasscode(uint8_t passcode[])
+{
+    // Drop expired passcodes first (lookups never check expiry)
+    expirePasscodes();
+
+    uint16_t packedPasscode = packPasscode(passcode);
+    StoreStatus status = probePasscode(liveStore, packedPasscode);
+    if (status != STORE_ABSENT) { return status; }
+    if (enrollmentBatchSize == MAX_NUM_STORED_PASSCODES) { return STORE_FULL; }
+#ifndef USE_LRU_EVICTION
+    if ((liveStore->numPasscodes + enrollmentBatchSize) >=
+        MAX_NUM_STORED_PASSCODES)
+    {
+        return STORE_FULL;
+    }
+#endif
+
+    uint8_t index = findEnrolledPasscode(packedPasscode);
+    if ((index < enrollmentBatchSize) && (enrollmentBatch[index] == packedPasscode))
+    {
+        return STORE_DUPLICATE;
+    }
+
+    memmove(&enrollmentBatch[index + 1], &enrollmentBatch[index],
+            (enrollmentBatchSize - index) * sizeof(enrollmentBatch[0]));
+    enrollmentBatch[index] = packedPasscode;
+    enrollmentBatchSize++;
+    return STORE_INSERTED;
+}
+
+/*
+ * This function binary searches enrollmentBatch for a packed passcode.
+ *
+ * Param: packedPasscode: The packed passcode to find.
+ * Return: (uint8_t): Index of the passcode, or where it would be inserted
+ *                    (enrollmentBatchSize if after every enrolled passcode).
+ */
+uint8_t findEnrolledPasscode(uint16_t packedPasscode)
+{
+    uint8_t low = 0;
+    uint8_t high = enrollmentBatchSize;
+    while (low < high)
+    {
+        uint8_t middle = (low + high) / 2;
+        if (enrollmentBatch[middle] < packedPasscode) { low = middle + 1; }
+        else { high = middle; }
+    }
+    return low;
+}
+
+/*
+ * This function stores enrollmentBatch in the store in one pass over the
+ * store: each stored passcode is looked up in the sorted batch, marking the
+ * codes stored since they were enrolled (by a code set load), and the rest
+ * of the batch is stored without probing the store again.
+ *
+ * Return: (uint8_t): The number of passcodes stored.
+ */
+uint8_t commitEnrollmentSession()
+{
+    // Drop expired passcodes first (lookups never check expiry)
+    expirePasscodes();
+
+    bool isStored[MAX_NUM_STORED_PASSCODES] = {false};
+    for (uint8_t i = 0; i < liveStore->numPasscodes; i++)
+    {
+        uint8_t index = findEnrolledPasscode(liveStore->passcodes[i]);
+        if ((index < enrollmentBatchSize) &&
+            (enrollmentBatch[index] == liveStore->passcodes[i]))
+        {
+            isStored[index] = true;
+        }
+    }
+
+    uint8_t numStored = 0;
+    for (uint8_t i = 0; i < enrollmentBatchSize; i++)
+    {
+        if (!isStored[i] && storePackedPasscode(enrollmentBatch[i]))
+        {
+            numStored++;
+        }
+    }
+
+    enrollmentBatchSize = 0;
+    return numStored;
+}
+
+/*
+ * This function empties enrollmentBatch without storing it.
+ *
+ * Return: None (void)
+ */
+void resetEnrollmentSession()
+{
+    enrollmentBatchSize = 0;
+    statusFlashPhase = 0;
+}
+
+/*
+ * This function starts flashing the status led a certain color. Unlike
+ * flashStatusLED() it returns at once, serviceStatusFlash() runs the flash.
+ *
+ * Param: statusColor: The color to flash status led with.
+ * Return: None (void)
+ */
+void startStatusFlash(uint8_t statusColor)
+{
+    // Ensure only led1 is being set
+    statusFlashColor = (statusColor & 0b111000);
+    statusFlashPhase = STATUS_FLASH_PHASES;
+    statusFlashPhaseStartMS = getTimeMS();
+    setLEDS(getModeColor() | statusFlashColor);  // Flash status led on
+}
+
+/*
+ * This function moves the status led flash on to its next phase once the
+ * current one has lasted STATUS_FLASH_PHASE_MS.
+ *
+ * Return: None (void)
+ */
+void serviceStatusFlash()
+{
+    if (statusFlashPhase == 0) { return; }
+
+    uint32_t now = getTimeMS();
+    if ((now - statusFlashPhaseStartMS) < STATUS_FLASH_PHASE_MS) { return; }
+
+    statusFlashPhase--;
+    statusFlashPhaseStartMS = now;
+
+    // Even phases are on, odd phases (and the end) off
+    bool isOn = ((statusFlashPhase != 0) && ((statusFlashPhase % 2) == 0));
+    setLEDS(getModeColor() | (isOn ? statusFlashColor : 0));
+}
+
+#ifdef USE_TICKLESS_IDLE
+/*
+ * This function limits an idle timeout so that the processor wakes for the
+ * next status led flash phase.
+ *
+ * Param: timeoutMS: The idle timeout in milliseconds (or NO_TIMEOUT).
+ * Return: (uint32_t): The limited idle timeout in milliseconds.
+ */
+uint32_t limitStatusFlashTimeoutMS(uint32_t timeoutMS)
+{
+    if (statusFlashPhase == 0) { return timeoutMS; }
+
+    int32_t untilPhase = (int32_t)((statusFlashPhaseStartMS + STATUS_FLASH_PHASE_MS) -
+                                   getTimeMS());
+    uint32_t flashTimeoutMS = (untilPhase > 0) ? untilPhase : 1;
+    if ((timeoutMS == NO_TIMEOUT) || (flashTimeoutMS < timeoutMS))
+    {
+        return flashTimeoutMS;
+    }
+    return timeoutMS;
+}
+#endif
+#endif // USE_ENROLLMENT_SESSION
+
+#ifdef USE_ROLLING_CODES
+/*
+ * This function sets the Unix time now. The time steps count from the Unix
+ * epoch, so the window of valid codes is computed again from scratch.
+ *
+ * Param: unixTime: Seconds since the Unix epoch.
+ * Return: None (void)
+ */
+void setRollingCodeTime(uint64_t unixTime)
+{
+    rollingCodeBootUnixTime = unixTime - getTimeSeconds();
+    isRollingCodeTimeSet = true;
+    isRollingCodeTableValid = false;
+}
+
+/*
+ * This function sets the secret of an account. Only the prepared HMAC key is
+ * kept, and the window of valid codes is computed again from scratch.
+ *
+ * Param: account: The account (0 to NUM_ROLLING_CODE_ACCOUNTS - 1).
+ * Param: secret: The secret.
+ * Param: secretLength: Length of the secret in bytes (1 to
+ *                      ROLLING_CODE_MAX_SECRET_LENGTH).
+ * Return: (bool): Secret set (false if the account or length is invalid)?
+ */
+bool setRollingCodeSecret(uint8_t account, const uint8_t secret[],
+                          uint8_t secretLength)
+{
+    if ((account >= NUM_ROLLING_CODE_ACCOUNTS) || (secretLength == 0) ||
+        (secretLength > ROLLING_CODE_MAX_SECRET_LENGTH))
+    {
+        return false;
+    }
+
+    prepareHMACKey(secret, secretLength, &rollingCodeKeys[account]);
+    rollingCodeAccounts |= (1 << account);
+    isRollingCodeTableValid = false;
+    return true;
+}
+
+/*
+ * This function gets the current time step (RFC 6238 T).
+ *
+ * Return: (uint64_t): ROLLING_CODE_STEP_S steps since the Unix epoch.
+ */
+uint64_t getRollingCodeStep()
+{
+    return ((rollingCodeBootUnixTime + getTimeSeconds()) / ROLLING_CODE_STEP_S);
+}
+
+/*
+ * This function moves the window of valid codes on to the current time step
+ * and sorts it into rollingCodeTable. Nothing is computed within a step, and
+ * a step on computes only the newest code of each account; the whole window
+ * is computed after the time or a secret is set or steps were missed. Until
+ * the time is set the table stays empty, rather than holding the codes of
+ * the Unix epoch.
+ *
+ * Return: None (void)
+ */
+void serviceRollingCodes()
+{
+    if (!isRollingCodeTimeSet) { return; }
+
+    uint64_t step = getRollingCodeStep();
+    if (isRollingCodeTableValid && (step == rollingCodeStep)) { return; }
+
+    // Window positions are steps plus ROLLING_CODE_WINDOW (never negative)
+    uint64_t firstPosition = step;
+    if (isRollingCodeTableValid && (step > rollingCodeStep) &&
+        ((step - rollingCodeStep) < ROLLING_CODE_STEPS))
+    {
+        // Keep the codes still in the window
+        firstPosition = rollingCodeStep + ROLLING_CODE_STEPS;
+    }
+
+    for (uint64_t position = firstPosition;
+         position < (step + ROLLING_CODE_STEPS); position++)
+    {
+        // (Steps before the epoch wrap around, their codes are never valid)
+        uint64_t codeStep = position - ROLLING_CODE_WINDOW;
+        for (uint8_t account = 0; account < NUM_ROLLING_CODE_ACCOUNTS; account++)
+        {
+            if (!(rollingCodeAccounts & (1 << account))) { continue; }
+            uint32_t code = computeHOTP(&rollingCodeKeys[account], codeStep);
+            rollingCodeRing[account][position % ROLLING_CODE_STEPS] =
+                packRollingCode(code % ROLLING_CODE_MODULUS);
+        }
+    }
+
+    // Insertion sort the window into the table (a handful of codes)
+    rollingCodeTableSize = 0;
+    for (uint8_t account = 0; account < NUM_ROLLING_CODE_ACCOUNTS; account++)
+    {
+        if (!(rollingCodeAccounts & (1 << account))) { continue; }
+        memcpy(&rollingCodeTable[rollingCodeTableSize], rollingCodeRing[account],
+               sizeof(rollingCodeRing[account]));
+        rollingCodeTableSize += ROLLING_CODE_STEPS;
+    }
+    for (uint8_t i = 1; i < rollingCodeTableSize; i++)
+    {
+        uint16_t packedCode = rollingCodeTable[i];
+        uint8_t j = i;
+        for (; (j > 0) && (rollingCodeTable[j - 1] > packedCode); j--)
+        {
+            rollingCodeTable[j] = rollingCodeTable[j - 1];
+        }
+        rollingCodeTable[j] = packedCode;
+    }
+
+    rollingCodeStep = step;
+    isRollingCodeTableValid = true;
+}
+
+/*
+ * This function checks if passcode is one of the rolling codes valid now, by
+ * a binary search of rollingCodeTable (see serviceRollingCodes).
+ *
+ * Param: passcode: The passcode to check.
+ * Return: (bool): passcode is a valid rolling code?
+ */
+OCM_CODE bool isRollingCode(uint8_t passcode[])
+{
+    if (!isRollingCodeTableValid) { return false; }
+
+    uint16_t packedPasscode = packPasscode(passcode);
+    uint8_t low = 0;
+    uint8_t high = rollingCodeTableSize;
+    while (low < high)
+    {
+        uint8_t middle = (low + high) / 2;
+        if (rollingCodeTable[middle] < packedPasscode) { low = middle + 1; }
+        else { high = middle; }
+    }
+    return ((low < rollingCodeTableSize) &&
+            (rollingCodeTable[low] == packedPasscode));
+}
+
+/*
+ * This function prepares an HMAC-SHA1 key: it compresses the key padded with
+ * the inner and outer pads once, so every code starts from those states.
+ *
+ * Param: key: The key.
+ * Param: keyLength: Length of the key in bytes (at most SHA1_BLOCK_SIZE).
+ * Param: hmacKey: Where to put the prepared key.
+ * Return: None (void)
+ */
+void prepareHMACKey(const uint8_t key[], uint8_t keyLength, HMACKey *hmacKey)
+{
+    static const uint32_t SHA1_INITIAL_STATE[SHA1_DIGEST_SIZE / 4] = {
+        0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0
+    };
+    uint8_t block[SHA1_BLOCK_SIZE];
+
+    for (int i = 0; i < SHA1_BLOCK_SIZE; i++)
+    {
+        block[i] = ((i < keyLength) ? key[i] : 0) ^ 0x36;
+    }
+    memcpy(hmacKey->inner, SHA1_INITIAL_STATE, sizeof(hmacKey->inner));
+    compressSHA1(hmacKey->inner, block);
+
+    for (int i = 0; i < SHA1_BLOCK_SIZE; i++)
+    {
+        block[i] = ((i < keyLength) ? key[i] : 0) ^ 0x5C;
+    }
+    memcpy(hmacKey->outer, SHA1_INITIAL_STATE, sizeof(hmacKey->outer));
+    compressSHA1(hmacKey->outer, block);
+}
+
+/*
+ * This function computes the HOTP value of a counter (RFC 4226): the dynamic
+ * truncation of HMAC-SHA1(key, counter). TOTP (RFC 6238) is HOTP of the time
+ * step. Both messages fit in one padded block after the prepared key block.
+ *
+ * Param: hmacKey: The prepared key.
+ * Param: counter: The counter (time step).
+ * Return: (uint32_t): 31-bit HOTP value (the code is its last digits).
+ */
+uint32_t computeHOTP(const HMACKey *hmacKey, uint64_t counter)
+{
+    uint8_t block[SHA1_BLOCK_SIZE] = {0};
+    uint32_t state[SHA1_DIGEST_SIZE / 4];
+
+    // Inner hash of the 8 byte big endian counter
+    for (int i = 0; i < 8; i++)
+    {
+        block[i] = (uint8_t)(counter >> (56 - (8 * i)));
+    }
+    block[8] = 0x80;
+    block[62] = (((SHA1_BLOCK_SIZE + 8) * 8) >> 8);
+    block[63] = (((SHA1_BLOCK_SIZE + 8) * 8) & 0xFF);
+    memcpy(state, hmacKey->inner, sizeof(state));
+    compressSHA1(state, block);
+
+    // Outer hash of the inner digest
+    memset(block, 0, sizeof(block));
+    for (int i = 0; i < SHA1_DIGEST_SIZE; i++)
+    {
+        block[i] = (uint8_t)(state[i / 4] >> (24 - (8 * (i % 4))));
+    }
+    block[SHA1_DIGEST_SIZE] = 0x80;
+    block[62] = (((SHA1_BLOCK_SIZE + SHA1_DIGEST_SIZE) * 8) >> 8);
+    block[63] = (((SHA1_BLOCK_SIZE + SHA1_DIGEST_SIZE) * 8) & 0xFF);
+    memcpy(state, hmacKey->outer, sizeof(state));
+    compressSHA1(state, block);
+
+    uint8_t digest[SHA1_DIGEST_SIZE];
+    for (int i = 0; i < SHA1_DIGEST_SIZE; i++)
+    {
+        digest[i] = (uint8_t)(state[i / 4] >> (24 - (8 * (i % 4))));
+    }
+
+    // Dynamic truncation: 31 bits at the offset in the last nibble
+    uint8_t offset = (digest[SHA1_DIGEST_SIZE - 1] & 0xF);
+    return (((uint32_t)(digest[offset] & 0x7F) << 24) |
+            ((uint32_t)digest[offset + 1] << 16) |
+            ((uint32_t)digest[offset + 2] << 8) |
+            ((uint32_t)digest[offset + 3]));
+}
+
+/*
+ * This function runs the SHA-1 compression function (FIPS 180-4) on one
+ * block, keeping only 16 words of the message schedule.
+ *
+ * Param: state: The five word state to update.
+ * Param: block: The SHA1_BLOCK_SIZE byte block.
+ * Return: None (void)
+ */
+void compressSHA1(uint32_t state[], const uint8_t block[])
+{
+    uint32_t w[16];
+    for (int i = 0; i < 16; i++)
+    {
+        w[i] = (((uint32_t)block[4 * i] << 24) | ((uint32_t)block[(4 * i) + 1] << 16) |
+                ((uint32_t)block[(4 * i) + 2] << 8) | ((uint32_t)block[(4 * i) + 3]));
+    }
+
+    uint32_t a = state[0];
+    uint32_t b = state[1];
+    uint32_t c = state[2];
+    uint32_t d = state[3];
+    uint32_t e = state[4];
+    for (int i = 0; i < 80; i++)
+    {
+        if (i >= 16)
+        {
+            uint32_t next = w[(i + 13) & 15] ^ w[(i + 8) & 15] ^
+                            w[(i + 2) & 15] ^ w[i & 15];
+            w[i & 15] = (next << 1) | (next >> 31);
+        }
+
+        uint32_t f;
+        uint32_t k;
+        if (i < 20)      { f = (b & c) | (~b & d);          k = 0x5A827999; }
+        else if (i < 40) { f = b ^ c ^ d;                   k = 0x6ED9EBA1; }
+        else if (i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDC; }
+        else             { f = b ^ c ^ d;                   k = 0xCA62C1D6; }
+
+        uint32_t temp = ((a << 5) | (a >> 27)) + f + e + k + w[i & 15];
+        e = d;
+        d = c;
+        c = (b << 30) | (b >> 2);
+        b = a;
+        a = temp;
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+}
+
+/*
+ * This function packs a rolling code like packPasscode packs the digits of a
+ * passcode, so it can be compared with an entered one.
+ *
+ * Param: code: The code (0 to ROLLING_CODE_MODULUS - 1).
+ * Return: (uint16_t): Packed code.
+ */
+uint16_t packRollingCode(uint32_t code)
+{
+    uint16_t packedCode = 0;
+    for (int digit = 0; digit < PASSCODE_LENGTH; digit++)
+    {
+        packedCode |= ((code % 10) << (4 * digit));
+        code /= 10;
+    }
+    return packedCode;
+}
+
+#ifdef USE_TICKLESS_IDLE
+/*
+ * This function limits an idle timeout so that the processor wakes when the
+ * next time step starts, to move the window on before the next check.
+ *
+ * Param: timeoutMS: The idle timeout in milliseconds (or NO_TIMEOUT).
+ * Return: (uint32_t): The limited idle timeout in milliseconds.
+ */
+uint32_t limitRollingCodeTimeoutMS(uint32_t timeoutMS)
+{
+    // (Nothing to move on until the time is set)
+    if (!isRollingCodeTimeSet) { return timeoutMS; }
+
+    XTime now;
+    XTime_GetTime(&now);
+    uint64_t unixMS = (rollingCodeBootUnixTime * 1000) +
+                      (now / (COUNTS_PER_SECOND / 1000));
+    uint32_t stepTimeoutMS = (ROLLING_CODE_STEP_S * 1000) -
+                             (unixMS % (ROLLING_CODE_STEP_S * 1000));
+    if ((timeoutMS == NO_TIMEOUT) || (stepTimeoutMS < timeoutMS))
+    {
+        return stepTimeoutMS;
+    }
+    return timeoutMS;
+}
+#endif
+#endif // USE_ROLLING_CODES
+
+/*
+ * This function stores a digit to currentPasscode.
+ *
+ * Param: digitData: The digit to store.
+ * Return: (bool): Digit stored successfully?
+ */
+OCM_CODE bool storeCurrentPasscodeDigit(uint8_t digitData)
+{
+    PROFILE_FUNCTION(PROFILE_STORE_CURRENT_PASSCODE_DIGIT);
+
+    // Ensure passcode is not complete
+    if (isCurrentPasscodeComplete()) { return false; }
+
+    // Store passcode
+    currentPasscode[currentPasscodeIndex++] = (digitData & 0xF);
+
+    // Display the current passcode to the seven segment display
+    displayPasscode(currentPasscode);
+
+    return true;
+}
+
+/*
+ * This function checks if passcode is equal to MASTER_PASSCODE.
+ *
+ * Param: passcode: The passcode to check.
+ * Return: (bool): passcode equals MASTER_PASSCODE?
+ */
+OCM_CODE bool isMasterPasscode(uint8_t passcode[])
+{
+    return ((passcode[0] == MASTER_PASSCODE[0]) &&
+            (passcode[1] == MASTER_PASSCODE[1]) &&
+            (passcode[2] == MASTER_PASSCODE[2]) &&
+            (passcode[3] == MASTER_PASSCODE[3]));
+}
+
+/*
+ * This function checks if passcode exists in the store.
+ *
+ * Param: passcode: The passcode to check.
+ * Return: (bool): passcode exists in the store?
+ */
+OCM_CODE bool isExistingPasscode(uint8_t passcode[])
+{
+    PROFILE_FUNCTION(PROFILE_IS_EXISTING_PASSCODE);
+
+    return (findPasscode(packPasscode(passcode)) != PASSCODE_NOT_FOUND);
+}
+
+/*
+ * This function checks if passcode exists in the store and opens zone
+ * (one lookup and one AND with its zone bitmap). If it does, the use is
+ * counted and when it happened recorded.
+ *
+ * Param: passcode: The passcode to check.
+ * Param: zone: The zone to open (0 to NUM_ZONES - 1).
+ * Return: (bool): passcode exists in the store and opens zone?
+ */
+OCM_CODE bool checkPasscode(uint8_t passcode[], uint8_t zone)
+{
+    int index = findPasscode(packPasscode(passcode));
+    if (index == PASSCODE_NOT_FOUND) { return false; }
+    if (!(liveStore->zones[index] & ZONE_MASK(zone))) { return false; }
+
+    // Update the attributes of the matched passcode only
+    if (liveStore->useCounts[index] < UINT16_MAX)
+    {
+        liveStore->useCounts[index]++;
+    }
+    liveStore->lastUsed[index] = getTimeSeconds();
+    touchLRUEntry(index);
+
+    return true;
+}
+
+/*
+ * This function sets the zones a stored passcode opens.
+ *
+ * Param: passcode: The passcode.
+ * Param: zones: Bitmap of the zones it opens (bit n for zone n).
+ * Return: (bool): passcode exists in the store?
+ */
+bool setPasscodeZones(uint8_t passcode[], uint32_t zones)
+{
+    int index = findPasscode(packPasscode(passcode));
+    if (index == PASSCODE_NOT_FOUND) { return false; }
+
+    liveStore->zones[index] = zones;
+    return true;
+}
+
+/*
+ * This function takes a zone away from every stored passcode in one pass over
+ * the zone bitmaps; no passcode is looked up. Passcodes left with no zones
+ * stay stored (see setPasscodeZones and grantZone).
+ *
+ * Param: zone: The zone to revoke (0 to NUM_ZONES - 1).
+ * Return: None (void)
+ */
+void revokeZone(uint8_t zone)
+{
+    uint32_t keepMask = ~ZONE_MASK(zone);
+    for (int i = 0; i < liveStore->numPasscodes; i++)
+    {
+        liveStore->zones[i] &= keepMask;
+    }
+}
+
+/*
+ * This function gives a zone to every stored passcode in one pass over the
+ * zone bitmaps.
+ *
+ * Param: zone: The zone to grant (0 to NUM_ZONES - 1).
+ * Return: None (void)
+ */
+void grantZone(uint8_t zone)
+{
+    for (int i = 0; i < liveStore->numPasscodes; i++)
+    {
+        liveStore->zones[i] |= ZONE_MASK(zone);
+    }
+}
+
+/*
+ * This function finds a packed passcode in the store.
+ *
+ * Param: packedPasscode: The packed passcode to find.
+ * Return: (int): Index of the passcode (PASSCODE_NOT_FOUND if not stored).
+ */
+OCM_CODE int findPasscode(uint16_t packedPasscode)
+{
+    return findBankPasscode(liveStore, packedPasscode);
+}
+
+/*
+ * This function finds a packed passcode in a bank. Only the packed
+ * passcodes are read, two bytes per stored passcode. With the CAM, the live
+ * bank is not read at all: one lookup gives the index of a match.
+ *
+ * Param: bank: The bank to search.
+ * Param: packedPasscode: The packed passcode to find.
+ * Return: (int): Index of the passcode (PASSCODE_NOT_FOUND if not stored).
+ */
+OCM_CODE int findBankPasscode(const PasscodeBank *bank, uint16_t packedPasscode)
+{
+#ifdef USE_PASSCODE_CAM
+    // The CAM holds the live bank only (a code set being loaded is searched)
+    if (bank == liveStore) { return lookupPasscodeCAM(packedPasscode); }
+#endif
+    return searchPasscodes(bank->passcodes, bank->numPasscodes, packedPasscode);
+}
+
+/*
+ * This function finds a packed passcode in an array of packed passcodes.
+ *
+ * Param: passcodes: The packed passcodes to search.
+ * Param: numPasscodes: Number of passcodes to search.
+ * Param: packedPasscode: The packed passcode to find.
+ * Return: (int): Index of the passcode (PASSCODE_NOT_FOUND if not there).
+ */
+OCM_CODE int searchPasscodes(const uint16_t passcodes[], uint8_t numPasscodes,
+                             uint16_t packedPasscode)
+{
+    for (int i = 0; i < numPasscodes; i++)
+    {
+        if (passcodes[i] == packedPasscode)
+        {
+            return i;
+        }
+    }
+    return PASSCODE_NOT_FOUND;
+}
+
+/*
+ * This function checks if the store is full.
+ *
+ * Return: (bool): The store is full?
+ */
+bool isStoredPasscodesFull()
+{
+    return (liveStore->numPasscodes == MAX_NUM_STORED_PASSCODES);
+}
+
+/*
+ * This function gets the bank of the store that is not live, where code sets
+ * are loaded.
+ *
+ * Return: (PasscodeBank *): The shadow bank.
+ */
+PasscodeBank *getShadowStore()
+{
+    return (liveStore == &passcodeBanks[0]) ? &passcodeBanks[1]
+                                            : &passcodeBanks[0];
+}
+
+/*
+ * This function starts loading a new code set into the shadow bank, dropping
+ * any load that was not committed. As in resetStoredPasscodes(), nothing is
+ * cleared: loaded codes overwrite the bank's slots, and slots past the count
+ * are never searched.
+ *
+ * Return: None (void)
+ */
+void beginPasscodeLoad()
+{
+    getShadowStore()->numPasscodes = 0;
+
+    isPasscodeLoadOpen = true;
+    isPasscodeLoadFailed = false;
+}
+
+/*
+ * This function adds passcode to the code set being loaded, with the default
+ * attributes of a passcode stored from the keypad. The live bank is not
+ * touched. A code set that does not fit fails its load, rather than evicting
+ * part of itself.
+ *
+ * Param: passcode: The passcode to load.
+ * Return: (StoreStatus): STORE_INSERTED, STORE_MASTER, STORE_DUPLICATE,
+ *                        STORE_FULL or STORE_NO_LOAD.
+ */
+StoreStatus loadPasscode(uint8_t passcode[])
+{
+    if (!isPasscodeLoadOpen) { return STORE_NO_LOAD; }
+
+    PasscodeBank *shadowStore = getShadowStore();
+    uint16_t packedPasscode = packPasscode(passcode);
+    StoreStatus status = probePasscode(shadowStore, packedPasscode);
+    if (status != STORE_ABSENT) { return status; }
+
+    if (shadowStore->numPasscodes == MAX_NUM_STORED_PASSCODES)
+    {
+        isPasscodeLoadFailed = true;
+        return STORE_FULL;
+    }
+
+    uint8_t index = shadowStore->numPasscodes++;
+    setPasscodeBankSlot(shadowStore, index, packedPasscode);
+    return STORE_INSERTED;
+}
+
+/*
+ * This function makes the code set being loaded live. The passcode CAM is
+ * loaded with the new set first, then one release store of liveStore swaps
+ * the banks, and the expiry timers and the recency list are rebuilt for the
+ * new set. Checks run on the same core between calls of this (the store
+ * core with USE_DUAL_CORE), so each is served from either the old code set
+ * or the new one, never a mix of them. The temporary passcodes of the old
+ * set go with it.
+ *
+ * Return: (bool): Code set made live (false if no load was open or it failed,
+ *                 leaving the live bank as it was)?
+ */
+bool commitPasscodeLoad()
+{
+    if (!isPasscodeLoadOpen || isPasscodeLoadFailed)
+    {
+        abortPasscodeLoad();
+        return false;
+    }
+    isPasscodeLoadOpen = false;
+    PasscodeBank *shadowStore = getShadowStore();
+
+#ifdef USE_PASSCODE_CAM
+    commandPasscodeCAM(PASSCODE_CAM_SLAVE_CMD_OP_CLEAR, 0);
+    for (uint8_t i = 0; i < shadowStore->numPasscodes; i++)
+    {
+        insertPasscodeCAM(shadowStore->passcodes[i], i);
+    }
+#endif
+
+    // The bank is complete before it is published
+    __atomic_store_n(&liveStore, shadowStore, __ATOMIC_RELEASE);
+
+    // The loaded passcodes are permanent: start an empty wheel generation
+    storeEpoch++;
+    resetExpiryWheel();
+
+#ifdef USE_LRU_EVICTION
+    // Oldest loaded passcode first to be evicted
+    resetLRUList();
+    for (uint8_t i = 0; i < liveStore->numPasscodes; i++)
+    {
+        pushLRUEntry(i);
+    }
+#endif
+
+    return true;
+}
+
+/*
+ * This function drops the code set being loaded. The shadow bank is left as
+ * it is until the next load starts.
+ *
+ * Return: None (void)
+ */
+void abortPasscodeLoad()
+{
+    isPasscodeLoadOpen = false;
+    isPasscodeLoadFailed = false;
+}
+
+/*
+ * This function checks if currentPasscode is complete.
+ *
+ * Return: (bool): currentPasscode is complete?
+ */
+OCM_CODE bool isCurrentPasscodeComplete()
+{
+    return (currentPasscodeIndex == PASSCODE_LENGTH);
+}
+
+/*
+ * This function packs a passcode into a 16-bit number with the first digit in
+ * the most significant nibble.
+ *
+ * Param: passcode: The passcode to pack.
+ * Return: (uint16_t): Packed passcode.
+ */
+OCM_CODE uint16_t packPasscode(const uint8_t passcode[])
+{
+    return ((passcode[0] << 12) |
+            (passcode[1] << 8) |
+            (passcode[2] << 4) |
+            (passcode[3]));
+}
+
+/*
+ * This function writes to the onboard leds.
+ *
+ * Param: ledData: Data to write to leds (lower 6 bits only).
+ * Return: None (void)
+ */
+void setLEDS(uint8_t ledData)
+{
+    AXILAB_SLAVE_LED_WriteLeds(ledData & 0x3F);
+}
+
+/*
+ * This function sets the LED color for the current mode.
+ *
+ * Return: None (void)
+ */
+void setModeLED()
+{
+    uint8_t modeColor = getModeColor();
+    if (modeColor != 0) { setLEDS(modeColor); }
+}
+
+/*
+ * This function gets the LED_0 color of the current mode.
+ *
+ * Return: (uint8_t): Mode color (0 for an unknown mode).
+ */
+uint8_t getModeColor()
+{
+    switch (currentMode)
+    {
+        case MODE_1_CHECK_CODE:
+            return LED_0_BLUE_MASK;
+        case MODE_2_SET_CODE:
+            return LED_0_YELLOW_MASK;
+        case MODE_3_REMOVE_CODE:
+            return LED_0_PURPLE_MASK;
+        case MODE_4_SET_TEMP_CODE:
+            return LED_0_CYAN_MASK;
+        default:
+            return 0;
+    }
+}
+
+/*
+ * This function flashes the status led a certain color indicating the
+ * status of an operation.
+ *
+ * Param: statusColor: The color to flash status led with.
+ * Return: None (void)
+ */
+void flashStatusLED(uint8_t statusColor)
+{
+    PROFILE_FUNCTION(PROFILE_FLASH_STATUS_LED);
+
+    // Ensure only led1 is being set
+    statusColor = (statusColor & 0b111000);
+
+    // Determine mode color
+    uint8_t modeColor = getModeColor();
+
+    // Flash status led twice (total of 0.5 seconds)
+    for (int i = 0; i < 2; i++)
+    {
+        setLEDS(modeColor | statusColor);  // Flash status led on
+        delayMS(125);                      // Delay program
+        setLEDS(modeColor);                // Flash status led off
+        delayMS(125);                      // Delay program
+    }
+}
+
+/*
+ * This function determines if the reset button is being pressed.
+ *
+ * Return: (bool): Reset button is being pressed?
+ */
+OCM_CODE bool isResetButtonPressed()
+{
+    return (AXILAB_SLAVE_BUTTON_ReadButtons() &
+            RESET_BUTTON_MASK);
+}
+
+/*
+ * This function determines if the reset button has been released. This is
+ * indicated by a falling edge on button state.
+ *
+ * Return: (bool): Reset button has been released?
+ */
+OCM_CODE bool isResetButtonReleased()
+{
+    // Get whether the reset button was pressed
+    bool currentResetButtonState = isResetButtonPressed();
+
+    // Check if a falling edge has occurred
+    bool fallingEdgeReset = (previousResetButtonState &&
+                             !currentResetButtonState);
+
+    // Set the previous state to the current state
+    previousResetButtonState = currentResetButtonState;
+
+    return fallingEdgeReset;
+}
+
+/*
+ * This function determines if the mode button is being pressed.
+ *
+ * Return: (bool): Mode button is being pressed?
+ */
+OCM_CODE bool isModeButtonPressed()
+{
+    return (AXILAB_SLAVE_BUTTON_ReadButtons() &
+            MODE_BUTTON_MASK);
+}
+
+/*
+ * This function determines if a key on the keypad is being pressed.
+ *
+ * Return: (bool): Key on the keypad is being pressed?
+ */
+OCM_CODE bool isKeypadPressed()
+{
+    return (KEYPAD_BINARY_SLAVE_ReadKey() & KEYPAD_KEY_PRESSED_MASK);
+}
+
+/*
+ * This function gets the keypad key that is being pressed. The key register
+ * flags a hex key (0-F, in its value) and the H and L function keys, so one
+ * read tells every key, including F, apart from no key.
+ *
+ * Return: (uint8_t): Digit value, KEYPAD_KEY_A-L or KEYPAD_NO_KEY.
+ */
+OCM_CODE uint8_t getKeypadValue()
+{
+    uint32_t key = KEYPAD_BINARY_SLAVE_ReadKey();
+
+    // (H and L leave the last hex key in the value)
+    if (key & KEYPAD_BINARY_SLAVE_KEY_H_MASK) { return KEYPAD_KEY_H; }
+    if (key & KEYPAD_BINARY_SLAVE_KEY_L_MASK) { return KEYPAD_KEY_L; }
+    if (key & KEYPAD_BINARY_SLAVE_KEY_HEX_MASK)
+    {
+        return (key & KEYPAD_BINARY_SLAVE_KEY_VALUE_MASK);
+    }
+
+    // No key is being pressed
+    return KEYPAD_NO_KEY;
+}
+
+/*
+ * This function sets the keypad scan divider. The keypad advances one scan
+ * step every (scanDivider + 1) clock ticks, so lower values trade scan power
+ * for input latency.
+ *
+ * Param: scanDivider: The scan divider to set (lower 7 bits only).
+ * Return: None (void)
+ */
+void setKeypadScanDivider(uint8_t scanDivider)
+{
+    KEYPAD_BINARY_SLAVE_WriteScanDivider(scanDivider & KEYPAD_SCAN_DIVIDER_MASK);
+}
+
+/*
+ * This function gets the bitmap of every key on the keypad being pressed,
+ * including the H and L function keys.
+ *
+ * Return: (uint32_t): Key state bitmap (lower 20 bits only).
+ */
+OCM_CODE uint32_t getKeypadKeyState()
+{
+    return (KEYPAD_BINARY_SLAVE_ReadKeyState() & KEYPAD_KEY_STATE_MASK);
+}
+
+/*
+ * This function determines if more than one key on the keypad is being
+ * pressed at once (rollover).
+ *
+ * Return: (bool): More than one key is being pressed?
+ */
+OCM_CODE bool isKeypadRollover()
+{
+    uint32_t keyState = getKeypadKeyState();
+
+    // Clearing the lowest set bit leaves a non-zero value if another key is set
+    return ((keyState & (keyState - 1)) != 0);
+}
+
+/*
+ * This function gets the time since the keypad state last changed (a key was
+ * pressed or released). The keypad slave timestamps every change in hardware,
+ * so this is exact however late the firmware looks.
+ *
+ * Return: (uint32_t): KEYPAD_CLOCK_HZ cycles since the last change.
+ */
+uint32_t getKeypadKeyAge()
+{
+    return KEYPAD_BINARY_SLAVE_ReadKeyAge();
+}
+
+/*
+ * This function determines if the key being pressed has just gone down, for
+ * keys acted on once per press instead of after a fixed delay. A press within
+ * KEYPAD_DEBOUNCE_MS of the last release is contact bounce, not a new press.
+ *
+ * Return: (bool): Key went down since the last call?
+ */
+bool isNewKeypadPress()
+{
+    if (!isKeypadPressed())
+    {
+        recordKeypadRelease();
+        return false;
+    }
+
+    // Held since the last call?
+    if (keypadWasPressed) { return false; }
+    keypadWasPressed = true;
+
+    // (or bouncing just after a release)
+    return ((getTimeMS() - keypadReleaseMS) >= KEYPAD_DEBOUNCE_MS);
+}
+
+/*
+ * This function records that no key is held, so that the next key to go down
+ * is a new press.
+ *
+ * Return: None (void)
+ */
+void recordKeypadRelease()
+{
+    if (keypadWasPressed)
+    {
+        keypadWasPressed = false;
+        keypadReleaseMS = getTimeMS();
+    }
+}
+
+/*
+ * This function displays a passcode to the seven segment display.
+ *
+ * Param: passcode: The passcode to display.
+ * Return: None (void)
+ */
+void displayPasscode(uint8_t passcode[])
+{
+    PROFILE_FUNCTION(PROFILE_DISPLAY_PASSCODE);
+
+    SEVEN_SEGMENT_DISPLAY_SLAVE_WriteDigits(packPasscode(passcode));
+}
+
+/*
+ * This function delays (blocking) by approximately (ms) milliseconds.
+ *
+ * Param: ms: The number of milliseconds to delay by.
+ * Return: None (void)
+ */
+void delayMS(uint16_t ms)
+{
+#ifdef USE_TICKLESS_IDLE
+    // Sleep until the one-shot timer expires
+    if (ms > 0) { waitForEvent(0, ms); }
+#elif defined(HOST_BUILD)
+    // Let the host backend advance target time
+    hostDelayMS(ms);
+#else
+    for (int i = 0; i < ms; i++)
+    {
+        for(int i = 0; i < 80000; i++) {}
+    }
+#endif
+}
+
+/*
+ * This function clears all outputs including the onboard leds and seven
+ * segment display.
+ *
+ * Return: None (void)
+ */
+void clearOutputs()
+{
+    setLEDS(0);
+    uint8_t blankPasscode[] = {0xF, 0xF, 0xF, 0xF};
+    displayPasscode(blankPasscode);
+}
+
+/*
+ * This function resets the system by reseting the current and stored
+ * passcode, and reseting the current mode.
+ *
+ * Return: None (void)
+ */
+void resetSystem()
+{
+    // Drop the codes of an enrollment session rather than storing them
+    resetEnrollmentSession();
+
+#ifdef USE_DUAL_CORE
+    // Have the store core (which owns the store) reset it and drop any code
+    // set being loaded
+    requestStoreReset();
+#else
+    // Drop any code set being loaded, so it cannot be committed after the
+    // reset
+    abortPasscodeLoad();
+
+    // Initialize the store to blank passcodes (0xFFFF)
+    resetStoredPasscodes();
+#endif
+
+    // Initialize currentPasscode to null values of 0xF
+    resetCurrentPasscode();
+
+    // Initialize current mode to default mode
+    setMode(DEFAULT_MODE);
+}
+
+#ifdef USE_TICKLESS_IDLE
+/*
+ * This function sets up the private timer as a one-shot timer and connects
+ * the timer, keypad and button interrupts. The keypad and button interrupts
+ * stay disabled until the processor goes idle.
+ *
+ * Return: None (void)
+ */
+void initIdle()
+{
+#ifndef HOST_BUILD
+    // Initialize the interrupt controller
+    XScuGic_Config *intcConfig = XScuGic_LookupConfig(INTC_DEVICE_ID);
+    XScuGic_CfgInitialize(&interruptController, intcConfig,
+                          intcConfig->CpuBaseAddress);
+
+    // Initialize the private timer (one-shot, no periodic tick)
+    XScuTimer_Config *timerConfig = XScuTimer_LookupConfig(TIMER_DEVICE_ID);
+    XScuTimer_CfgInitialize(&idleTimer, timerConfig, timerConfig->BaseAddr);
+    XScuTimer_SetPrescaler(&idleTimer, TIMER_PRESCALER);
+    XScuTimer_DisableAutoReload(&idleTimer);
+    XScuTimer_EnableInterrupt(&idleTimer);
+
+    // Connect the interrupt handlers
+    Xil_ExceptionInit();
+    Xil_ExceptionRegisterHandler(XIL_EXCEPTION_ID_INT,
+                                 (Xil_ExceptionHandler)XScuGic_InterruptHandler,
+                                 &interruptController);
+    XScuGic_Connect(&interruptController, TIMER_INTR_ID,
+                    (Xil_ExceptionHandler)timerInterruptHandler, &idleTimer);
+    XScuGic_SetPriorityTriggerType(&interruptController, KEYPAD_INTR_ID,
+                                   INTR_PRIORITY, INTR_LEVEL_HIGH);
+    XScuGic_Connect(&interruptController, KEYPAD_INTR_ID,
+                    (Xil_ExceptionHandler)inputInterruptHandler,
+                    (void *)(UINTPTR)KEYPAD_INTR_ID);
+    XScuGic_SetPriorityTriggerType(&interruptController, BUTTON_INTR_ID,
+                                   INTR_PRIORITY, INTR_LEVEL_HIGH);
+    XScuGic_Connect(&interruptController, BUTTON_INTR_ID,
+                    (Xil_ExceptionHandler)inputInterruptHandler,
+                    (void *)(UINTPTR)BUTTON_INTR_ID);
+    XScuGic_Enable(&interruptController, TIMER_INTR_ID);
+    Xil_ExceptionEnable();
+#endif
+
+#ifdef MEASURE_IDLE_TIME
+    // Start the first report period
+    idleTime = 0;
+    XTime_GetTime(&idleMeasureStartTime);
+#endif
+}
+
+/*
+ * This function idles the processor until one of events occurs or timeoutMS
+ * milliseconds pass. On the target the processor sleeps in WFI and is woken
+ * by the keypad and button interrupts (EVENT_INPUT) or by the one-shot timer
+ * armed for the timeout, so no periodic tick runs while idle.
+ *
+ * Param: events: The events to wake on (EVENT_INPUT or 0).
+ * Param: timeoutMS: Milliseconds to idle for at most (NO_TIMEOUT for none).
+ * Return: (uint32_t): The events that occurred.
+ */
+uint32_t waitForEvent(uint32_t events, uint32_t timeoutMS)
+{
+    uint32_t occurredEvents = 0;
+
+#ifdef MEASURE_IDLE_TIME
+    XTime idleStartTime;
+    XTime idleEndTime;
+    XTime_GetTime(&idleStartTime);
+#endif
+
+#ifdef HOST_BUILD
+    // Let the host backend block until input or the timeout
+    if (events & EVENT_INPUT)
+    {
+        occurredEvents = (hostWaitForInput(timeoutMS) ? EVENT_INPUT :
+                                                        EVENT_TIMEOUT);
+    }
+    else
+    {
+        hostDelayMS(timeoutMS);
+        occurredEvents = EVENT_TIMEOUT;
+    }
+#else
+    // Mask interrupts so none is handled between checking pendingEvents and
+    // WFI (a pending interrupt still wakes the processor while masked)
+    Xil_ExceptionDisable();
+    pendingEvents = 0;
+
+    // Arm the one-shot timer for the timeout
+    if (timeoutMS != NO_TIMEOUT)
+    {
+        XScuTimer_LoadTimer(&idleTimer, timeoutMS * TIMER_TICKS_PER_MS);
+        XScuTimer_Start(&idleTimer);
+        events |= EVENT_TIMEOUT;
+    }
+
+    // Let a held key or button wake the processor
+    if (events & EVENT_INPUT)
+    {
+        XScuGic_Enable(&interruptController, KEYPAD_INTR_ID);
+        XScuGic_Enable(&interruptController, BUTTON_INTR_ID);
+    }
+
+    while (!(pendingEvents & events))
+    {
+        wfi();                   // Sleep until an interrupt is pending
+        Xil_ExceptionEnable();   // Handle it
+        Xil_ExceptionDisable();
+    }
+
+    XScuTimer_Stop(&idleTimer);
+    XScuGic_Disable(&interruptController, KEYPAD_INTR_ID);
+    XScuGic_Disable(&interruptController, BUTTON_INTR_ID);
+    occurredEvents = (pendingEvents & events);
+    Xil_ExceptionEnable();
+#endif
+
+#ifdef MEASURE_IDLE_TIME
+    XTime_GetTime(&idleEndTime);
+    idleTime += (idleEndTime - idleStartTime);
+#endif
+
+    return occurredEvents;
+}
+
+/*
+ * This function determines if a key on the keypad or an onboard button is
+ * being held (the same conditions that raise the input interrupts).
+ *
+ * Return: (bool): Key or button is being held?
+ */
+OCM_CODE bool isInputActive()
+{
+    return ((AXILAB_SLAVE_BUTTON_ReadButtons() &
+             (RESET_BUTTON_MASK | MODE_BUTTON_MASK)) ||
+            (getKeypadKeyState() != 0));
+}
+
+#ifndef HOST_BUILD
+/*
+ * This function handles the one-shot timer interrupt.
+ *
+ * Param: callbackRef: The private timer instance.
+ * Return: None (void)
+ */
+void timerInterruptHandler(void *callbackRef)
+{
+    XScuTimer_ClearInterruptStatus((XScuTimer *)callbackRef);
+    pendingEvents |= EVENT_TIMEOUT;
+}
+
+/*
+ * This function handles the keypad and button interrupts. They are level
+ * interrupts that stay high while an input is held, so each one is disabled
+ * until the processor next goes idle.
+ *
+ * Param: callbackRef: The interrupt ID.
+ * Return: None (void)
+ */
+void inputInterruptHandler(void *callbackRef)
+{
+    XScuGic_Disable(&interruptController, (u32)(UINTPTR)callbackRef);
+    pendingEvents |= EVENT_INPUT;
+}
+#endif
+
+#ifdef MEASURE_IDLE_TIME
+/*
+ * This function prints the fraction of time spent idle once every
+ * IDLE_REPORT_PERIOD_MS milliseconds and starts a new report period.
+ *
+ * Return: None (void)
+ */
+void reportIdleTime()
+{
+    XTime now;
+    XTime_GetTime(&now);
+
+    // Wait for the end of the report period
+    XTime elapsed = (now - idleMeasureStartTime);
+    if (elapsed < ((XTime)IDLE_REPORT_PERIOD_MS * (COUNTS_PER_SECOND / 1000)))
+    {
+        return;
+    }
+
+    // Print idle time in tenths of a percent
+    uint32_t idlePermille = (uint32_t)((idleTime * 1000) / elapsed);
+    printf("Idle: %lu.%lu%% of %lu ms\r\n",
+           (unsigned long)(idlePermille / 10),
+           (unsigned long)(idlePermille % 10),
+           (unsigned long)(elapsed / (COUNTS_PER_SECOND / 1000)));
+
+    idleTime = 0;
+    idleMeasureStartTime = now;
+}
+#endif
+#endif // USE_TICKLESS_IDLE
+
+#ifdef USE_REGISTER_TRACE
+/*
+ * This function reads a peripheral register and records the access.
+ *
+ * Param: address: The register address.
+ * Return: (u32): The register value.
+ */
+u32 traceReadReg(UINTPTR address)
+{
+    u32 value = Xil_In32(address);
+    recordRegisterAccess(false, address, value);
+    return value;
+}
+
+/*
+ * This function writes a peripheral register and records the access.
+ *
+ * Param: address: The register address.
+ * Param: value: The value to write.
+ * Return: None (void)
+ */
+void traceWriteReg(UINTPTR address, u32 value)
+{
+    Xil_Out32(address, value);
+    recordRegisterAccess(true, address, value);
+}
+
+/*
+ * This function appends a record of a register access to the current trace
+ * block, starting a new block if the record does not fit.
+ *
+ * Param: isWrite: The access was a write?
+ * Param: address: The register address.
+ * Param: value: The value read or written.
+ * Return: None (void)
+ */
+void recordRegisterAccess(bool isWrite, UINTPTR address, u32 value)
+{
+    XTime now;
+    XTime_GetTime(&now);
+    uint64_t time = (now >> REGISTER_TRACE_TIME_SHIFT);
+
+    // Build the record header
+    uint8_t peripheral = REGISTER_TRACE_UNKNOWN;
+    if ((address >= KEYPAD_BINARY_SLAVE_BASE_ADDR) &&
+        (address < (PASSCODE_CAM_SLAVE_BASE_ADDR + 0x10000)))
+    {
+        peripheral = ((address - KEYPAD_BINARY_SLAVE_BASE_ADDR) >> 16);
+    }
+    uint8_t header = ((isWrite ? REGISTER_TRACE_WRITE_BIT : 0) |
+                      (peripheral << REGISTER_TRACE_PERIPHERAL_SHIFT) |
+                      (((address >> 2) & REGISTER_TRACE_REGISTER_MASK) <<
+                       REGISTER_TRACE_REGISTER_SHIFT));
+
+    uint8_t record[REGISTER_TRACE_MAX_RECORD_SIZE];
+    uint8_t size = encodeRegisterTraceRecord(record, header,
+                                             time - registerTraceLastTime,
+                                             value);
+
+    // Start a new block (timed from this record) if it does not fit
+    if ((registerTraceBlocksStarted == 0) ||
+        ((registerTraceBlockUsed + size) > REGISTER_TRACE_BLOCK_SIZE))
+    {
+        startRegisterTraceBlock(time);
+        size = encodeRegisterTraceRecord(record, header, 0, value);
+    }
+
+    uint8_t *block = registerTrace[(registerTraceBlocksStarted - 1) %
+                                   REGISTER_TRACE_NUM_BLOCKS];
+    memcpy(&block[registerTraceBlockUsed], record, size);
+    registerTraceBlockUsed += size;
+    registerTraceLastTime = time;
+}
+
+/*
+ * This function starts the next block of the trace ring and writes its
+ * header. Once the ring is full this overwrites the oldest block.
+ *
+ * Param: time: The trace clock at the start of the block.
+ * Return: None (void)
+ */
+void startRegisterTraceBlock(uint64_t time)
+{
+    uint8_t *block = registerTrace[registerTraceBlocksStarted %
+                                   REGISTER_TRACE_NUM_BLOCKS];
+    uint32_t ticksPerSecond = (COUNTS_PER_SECOND >> REGISTER_TRACE_TIME_SHIFT);
+
+    memset(block, REGISTER_TRACE_PADDING, REGISTER_TRACE_BLOCK_SIZE);
+    block[0] = (REGISTER_TRACE_MAGIC & 0xFF);
+    block[1] = (REGISTER_TRACE_MAGIC >> 8);
+    block[2] = (registerTraceBlocksStarted & 0xFF);
+    block[3] = ((registerTraceBlocksStarted >> 8) & 0xFF);
+    for (int i = 0; i < 4; i++)
+    {
+        block[4 + i] = ((ticksPerSecond >> (8 * i)) & 0xFF);
+    }
+    for (int i = 0; i < 8; i++)
+    {
+        block[8 + i] = ((time >> (8 * i)) & 0xFF);
+    }
+
+    registerTraceBlocksStarted++;
+    registerTraceBlockUsed = REGISTER_TRACE_HEADER_SIZE;
+    registerTraceLastTime = time;
+}
+
+/*
+ * This function encodes a trace record using the smallest delta size and a
+ * LEB128 varint value (see register_trace.h).
+ *
+ * Param: record: Buffer of REGISTER_TRACE_MAX_RECORD_SIZE bytes.
+ * Param: header: The record header without the delta size.
+ * Param: delta: Trace clock ticks since the previous record.
+ * Param: value: The register value.
+ * Return: (uint8_t): Size of the record in bytes.
+ */
+uint8_t encodeRegisterTraceRecord(uint8_t record[], uint8_t header,
+                                  uint64_t delta, u32 value)
+{
+    uint8_t size = 1;
+
+    // Time delta
+    if (delta == 0)
+    {
+        header |= REGISTER_TRACE_DELTA_NONE;
+    }
+    else if (delta <= 0xFF)
+    {
+        header |= REGISTER_TRACE_DELTA_U8;
+        record[size++] = delta;
+    }
+    else if (delta <= 0xFFFF)
+    {
+        header |= REGISTER_TRACE_DELTA_U16;
+        record[size++] = (delta & 0xFF);
+        record[size++] = (delta >> 8);
+    }
+    else
+    {
+        header |= REGISTER_TRACE_DELTA_VARINT;
+        while (delta >= 0x80)
+        {
+            record[size++] = ((delta & 0x7F) | 0x80);
+            delta >>= 7;
+        }
+        record[size++] = delta;
+    }
+    record[0] = header;
+
+    // Value
+    while (value >= 0x80)
+    {
+        record[size++] = ((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    record[size++] = value;
+
+    return size;
+}
+
+/*
+ * This function prints the trace ring as hex lines, oldest block first, for
+ * host/trace/trace_decode to read back from a UART log.
+ *
+ * Return: None (void)
+ */
+void dumpRegisterTrace()
+{
+    uint32_t firstBlock = 0;
+    if (registerTraceBlocksStarted > REGISTER_TRACE_NUM_BLOCKS)
+    {
+        firstBlock = (registerTraceBlocksStarted - REGISTER_TRACE_NUM_BLOCKS);
+    }
+
+    printf(REGISTER_TRACE_DUMP_BEGIN "\r\n");
+    for (uint32_t i = firstBlock; i < registerTraceBlocksStarted; i++)
+    {
+        uint8_t *block = registerTrace[i % REGISTER_TRACE_NUM_BLOCKS];
+        for (int j = 0; j < REGISTER_TRACE_BLOCK_SIZE; j++)
+        {
+            printf("%02x", block[j]);
+            if ((j % REGISTER_TRACE_DUMP_LINE_SIZE) ==
+                (REGISTER_TRACE_DUMP_LINE_SIZE - 1))
+            {
+                printf("\r\n");
+            }
+        }
+    }
+    printf(REGISTER_TRACE_DUMP_END "\r\n");
+}
+#endif // USE_REGISTER_TRACE
+
+#ifdef USE_PROFILER
+/*
+ * This function enables the cycle counter. On the target this is the PMU
+ * cycle counter (CCNT), counting every CPU clock.
+ *
+ * Return: None (void)
+ */
+void initProfiler()
+{
+#ifndef HOST_BUILD
+    mtcp(XREG_CP15_PERF_MONITOR_CTRL,
+         mfcp(XREG_CP15_PERF_MONITOR_CTRL) | PMCR_ENABLE | PMCR_RESET_CCNT);
+    mtcp(XREG_CP15_COUNT_ENABLE_SET, PMCNTEN_CCNT);
+#endif
+}
+
+/*
+ * This function reads the cycle counter.
+ *
+ * Return: (ProfileCycles): The cycle counter (see PROFILE_CYCLE_UNIT).
+ */
+ProfileCycles readCycleCounter()
+{
+#if !defined(HOST_BUILD)
+    return mfcp(XREG_CP15_PERF_CYCLE_COUNTER);
+#elif defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000000) + now.tv_nsec;
+#endif
+}
+
+/*
+ * This function adds the cycles of a call to its function's profileTable
+ * entry. It runs when the ProfileScope of PROFILE_FUNCTION() goes out of scope.
+ *
+ * Param: scope: The call being timed.
+ * Return: None (void)
+ */
+void endProfileScope(ProfileScope *scope)
+{
+    // Unsigned subtraction handles the counter wrapping once
+    uint64_t cycles = (ProfileCycles)(readCycleCounter() - scope->startCycles);
+    ProfileEntry *entry = &profileTable[scope->function];
+
+    if ((entry->calls == 0) || (cycles < entry->minCycles))
+    {
+        entry->minCycles = cycles;
+    }
+    if (cycles > entry->maxCycles)
+    {
+        entry->maxCycles = cycles;
+    }
+    entry->totalCycles += cycles;
+    entry->calls++;
+}
+
+/*
+ * This function prints the calls and cycles of every instrumented function.
+ *
+ * Return: None (void)
+ */
+void reportProfile()
+{
+    printf("profile (" PROFILE_CYCLE_UNIT ", including callees):\r\n");
+    printf("%-26s %8s %12s %10s %10s %10s\r\n", "function", "calls", "total",
+           "min", "max", "mean");
+    for (int i = 0; i < NUM_PROFILED_FUNCTIONS; i++)
+    {
+        ProfileEntry *entry = &profileTable[i];
+        printf("%-26s %8lu %12llu %10llu %10llu %10llu\r\n",
+               PROFILED_FUNCTION_NAMES[i], (unsigned long)entry->calls,
+               (unsigned long long)entry->totalCycles,
+               (unsigned long long)entry->minCycles,
+               (unsigned long long)entry->maxCycles,
+               (unsigned long long)(entry->calls ?
+                                    (entry->totalCycles / entry->calls) : 0));
+    }
+}
+#endif // USE_PROFILER
+
+#ifdef USE_CONSOLE_COMMANDS
+/*
+ * This function reads a command character received over UART (from stdin on
+ * the host) without blocking.
+ *
+ * Return: (int): The command, or NO_CONSOLE_COMMAND if none was received.
+ */
+int readConsoleCommand()
+{
+#ifdef HOST_BUILD
+    return hostReadConsoleCommand();
+#else
+    if (!XUartPs_IsReceiveData(STDIN_BASEADDRESS)) { return NO_CONSOLE_COMMAND; }
+    return XUartPs_RecvByte(STDIN_BASEADDRESS);
+#endif
+}
+
+/*
+ * This function runs the command received over UART, if any. Unknown
+ * characters are ignored. While a line of arguments or a code set is open,
+ * every character received so far is taken as part of it.
+ *
+ * Return: None (void)
+ */
+void handleConsoleCommand()
+{
+    int command = readConsoleCommand();
+
+#ifdef USE_CONSOLE_LINES
+    if (consoleLineCommand != NO_CONSOLE_COMMAND)
+    {
+        for (; (command != NO_CONSOLE_COMMAND) &&
+               (consoleLineCommand != NO_CONSOLE_COMMAND);
+             command = readConsoleCommand())
+        {
+            handleConsoleLineCharacter(command);
+        }
+        return;
+    }
+#endif
+
+#ifdef USE_CODE_SET_LOAD
+    if (isConsoleLoadOpen)
+    {
+        for (; (command != NO_CONSOLE_COMMAND) && isConsoleLoadOpen;
+             command = readConsoleCommand())
+        {
+            handleConsoleLoadCharacter(command);
+        }
+        return;
+    }
+#endif
+
+    switch (command)
+    {
+#ifdef USE_REGISTER_TRACE
+        case TRACE_DUMP_COMMAND:
+            dumpRegisterTrace();
+            break;
+#endif
+#ifdef USE_PROFILER
+        case PROFILE_REPORT_COMMAND:
+            reportProfile();
+            break;
+#endif
+#ifdef USE_CODE_SET_LOAD
+        case LOAD_BEGIN_COMMAND:
+            isConsoleLoadOpen = true;
+            consoleLoadDigits = 0;
+            runPasscodeLoadStep(LOAD_BEGIN, NULL);
+            break;
+#endif
+#ifdef USE_ZONE_COMMANDS
+        case SET_ZONES_COMMAND:
+        case REVOKE_ZONE_COMMAND:
+        case GRANT_ZONE_COMMAND:
+            consoleLineCommand = command;
+            consoleLineLength = 0;
+            break;
+#endif
+#ifdef USE_ROLLING_CODES
+        case SET_TIME_COMMAND:
+        case SET_SECRET_COMMAND:
+            consoleLineCommand = command;
+            consoleLineLength = 0;
+            break;
+#endif
+        default:
+            break;
+    }
+}
+
+/*
+ * This function prints a line of output of the store. With USE_DUAL_CORE it
+ * runs on the store core, so the line is sent to the I/O core, which owns the
+ * UART and prints it (see waitForStoreCore); a line longer than
+ * CORE_TEXT_LENGTH is cut short.
+ *
+ * Param: format: The printf format of the line.
+ * Return: None (void)
+ */
+void printStoreOutput(const char *format, ...)
+{
+    va_list arguments;
+    va_start(arguments, format);
+#ifdef USE_DUAL_CORE
+    CoreMessage output = {.type = MESSAGE_OUTPUT};
+    vsnprintf(output.text, sizeof(output.text), format, arguments);
+    sendCoreMessage(&dualCoreShared->replies, &output);
+#else
+    vprintf(format, arguments);
+#endif
+    va_end(arguments);
+}
+
+#ifdef USE_TICKLESS_IDLE
+/*
+ * This function limits an idle timeout while a line of arguments or a code
+ * set is being received, so the characters are taken from the UART before
+ * its RX FIFO overflows.
+ *
+ * Param: timeoutMS: The idle timeout in milliseconds (or NO_TIMEOUT).
+ * Return: (uint32_t): The limited idle timeout in milliseconds.
+ */
+uint32_t limitConsoleTimeoutMS(uint32_t timeoutMS)
+{
+    bool isReceiving = false;
+#ifdef USE_CONSOLE_LINES
+    isReceiving |= (consoleLineCommand != NO_CONSOLE_COMMAND);
+#endif
+#ifdef USE_CODE_SET_LOAD
+    isReceiving |= isConsoleLoadOpen;
+#endif
+    if (!isReceiving) { return timeoutMS; }
+
+    if ((timeoutMS == NO_TIMEOUT) || (CONSOLE_POLL_MS < timeoutMS))
+    {
+        return CONSOLE_POLL_MS;
+    }
+    return timeoutMS;
+}
+#endif
+
+#ifdef USE_CONSOLE_LINES
+/*
+ * This function handles a character of the line of arguments being
+ * received. A line break ends the line and runs its command; a line longer
+ * than CONSOLE_LINE_LENGTH is dropped. The line is cleared once it has been
+ * taken, as it can hold a secret.
+ *
+ * Param: character: The character received.
+ * Return: None (void)
+ */
+void handleConsoleLineCharacter(int character)
+{
+    if ((character == '\r') || (character == '\n'))
+    {
+        consoleLine[consoleLineLength] = '\0';
+        runConsoleLine(consoleLineCommand, consoleLine);
+        consoleLineCommand = NO_CONSOLE_COMMAND;
+        memset(consoleLine, 0, sizeof(consoleLine));
+    }
+    else if (consoleLineLength < CONSOLE_LINE_LENGTH)
+    {
+        consoleLine[consoleLineLength++] = character;
+    }
+    else
+    {
+        printf("console: line too long\r\n");
+        consoleLineCommand = NO_CONSOLE_COMMAND;
+        memset(consoleLine, 0, sizeof(consoleLine));
+    }
+}
+
+/*
+ * This function runs a command with its line of arguments on the store,
+ * which is on the store core with USE_DUAL_CORE.
+ *
+ * Param: command: The command character.
+ * Param: line: Its arguments.
+ * Return: None (void)
+ */
+void runConsoleLine(uint8_t command, const char line[])
+{
+#ifdef USE_DUAL_CORE
+    requestConsoleLine(command, line);
+#else
+    handleConsoleLine(command, line);
+#endif
+}
+
+/*
+ * This function runs a command with its line of arguments and prints its
+ * outcome over UART (never a passcode).
+ *
+ * Param: command: The command character.
+ * Param: line: Its arguments.
+ * Return: None (void)
+ */
+void handleConsoleLine(uint8_t command, const char line[])
+{
+    char *end;
+    switch (command)
+    {
+#ifdef USE_ZONE_COMMANDS
+        case SET_ZONES_COMMAND:
+        {
+            uint8_t passcode[PASSCODE_LENGTH];
+            if (!parseConsolePasscode(line, passcode) ||
+                (line[PASSCODE_LENGTH] != ' '))
+            {
+                printStoreOutput("zones: usage Z<passcode> <zone bitmap in hex>\r\n");
+                break;
+            }
+            uint32_t zones = strtoul(&line[PASSCODE_LENGTH + 1], &end, 16);
+            if (*end != '\0')
+            {
+                printStoreOutput("zones: usage Z<passcode> <zone bitmap in hex>\r\n");
+                break;
+            }
+            printStoreOutput(setPasscodeZones(passcode, zones)
+                             ? "zones: set\r\n" : "zones: not stored\r\n");
+            break;
+        }
+        case REVOKE_ZONE_COMMAND:
+        case GRANT_ZONE_COMMAND:
+        {
+            unsigned long zone = strtoul(line, &end, 10);
+            if ((end == line) || (*end != '\0') || (zone >= NUM_ZONES))
+            {
+                printStoreOutput("zones: usage %c<zone 0-%u>\r\n", command,
+                                 NUM_ZONES - 1);
+                break;
+            }
+            if (command == REVOKE_ZONE_COMMAND) { revokeZone(zone); }
+            else { grantZone(zone); }
+            printStoreOutput("zones: zone %lu %s\r\n", zone,
+                             (command == REVOKE_ZONE_COMMAND) ? "revoked" : "granted");
+            break;
+        }
+#endif
+#ifdef USE_ROLLING_CODES
+        case SET_TIME_COMMAND:
+        {
+            unsigned long long unixTime = strtoull(line, &end, 10);
+            if ((end == line) || (*end != '\0'))
+            {
+                printStoreOutput("rolling: usage T<Unix time in seconds>\r\n");
+                break;
+            }
+            setRollingCodeTime(unixTime);
+            printStoreOutput("rolling: time set\r\n");
+            break;
+        }
+        case SET_SECRET_COMMAND:
+        {
+            // Two hex digits per byte of the secret
+            uint8_t secret[ROLLING_CODE_MAX_SECRET_LENGTH];
+            uint8_t secretLength = 0;
+            unsigned long account = strtoul(line, &end, 10);
+            bool isValid = ((end != line) && (*end == ' ') &&
+                            (account < NUM_ROLLING_CODE_ACCOUNTS));
+            const char *digits = end + 1;
+            for (; isValid && (*digits != '\0'); digits += 2)
+            {
+                isValid = (isxdigit((unsigned char)digits[0]) &&
+                           isxdigit((unsigned char)digits[1]) &&
+                           (secretLength < ROLLING_CODE_MAX_SECRET_LENGTH));
+                if (!isValid) { break; }
+                char byte[3] = {digits[0], digits[1], '\0'};
+                secret[secretLength++] = strtoul(byte, NULL, 16);
+            }
+            isValid = (isValid &&
+                       setRollingCodeSecret(account, secret, secretLength));
+            memset(secret, 0, sizeof(secret));
+            printStoreOutput(isValid
+                             ? "rolling: secret set\r\n"
+                             : "rolling: usage S<account> <secret in hex>\r\n");
+            break;
+        }
+#endif
+        default:
+            break;
+    }
+}
+
+/*
+ * This function parses a passcode of PASSCODE_LENGTH digits at the start of
+ * text.
+ *
+ * Param: text: The text.
+ * Param: passcode: Set to the passcode.
+ * Return: (bool): text starts with PASSCODE_LENGTH digits?
+ */
+bool parseConsolePasscode(const char text[], uint8_t passcode[])
+{
+    for (int i = 0; i < PASSCODE_LENGTH; i++)
+    {
+        if ((text[i] < '0') || (text[i] > '9')) { return false; }
+        passcode[i] = text[i] - '0';
+    }
+    return true;
+}
+#endif // USE_CONSOLE_LINES
+
+#ifdef USE_CODE_SET_LOAD
+/*
+ * This function handles a character of the open code set. Each code goes to
+ * the store as soon as its last digit arrives. Anything other than digits,
+ * separators between codes and LOAD_COMMIT_COMMAND drops the whole set, as
+ * does a commit in the middle of a code, so a garbled transfer never goes
+ * live.
+ *
+ * Param: character: The character received.
+ * Return: None (void)
+ */
+void handleConsoleLoadCharacter(int character)
+{
+    if ((character >= '0') && (character <= '9'))
+    {
+        consoleLoadPasscode[consoleLoadDigits++] = character - '0';
+        if (consoleLoadDigits == PASSCODE_LENGTH)
+        {
+            runPasscodeLoadStep(LOAD_PASSCODE, consoleLoadPasscode);
+            consoleLoadDigits = 0;
+        }
+        return;
+    }
+
+    bool isBetweenCodes = (consoleLoadDigits == 0);
+    if (isBetweenCodes && ((character == ' ') || (character == ',') ||
+                           (character == '\r') || (character == '\n')))
+    {
+        return;
+    }
+
+    // The set is complete, dropped or garbled
+    isConsoleLoadOpen = false;
+    if (isBetweenCodes && (character == LOAD_COMMIT_COMMAND))
+    {
+        runPasscodeLoadStep(LOAD_COMMIT, NULL);
+    }
+    else
+    {
+        runPasscodeLoadStep(LOAD_ABORT, NULL);
+    }
+}
+
+/*
+ * This function carries out a step of a code set load on the store, which is
+ * on the store core with USE_DUAL_CORE.
+ *
+ * Param: step: The step (LoadStep).
+ * Param: passcode: The passcode to load (LOAD_PASSCODE only, else NULL).
+ * Return: None (void)
+ */
+void runPasscodeLoadStep(uint8_t step, uint8_t passcode[])
+{
+#ifdef USE_DUAL_CORE
+    requestPasscodeLoad(step, passcode);
+#else
+    handlePasscodeLoad(step, passcode);
+#endif
+}
+
+/*
+ * This function carries out a step of a code set load and prints its
+ * outcome over UART (never the passcodes). Codes already in the set and
+ * MASTER_PASSCODE are skipped.
+ *
+ * Param: step: The step (LoadStep).
+ * Param: passcode: The passcode to load (LOAD_PASSCODE only, else NULL).
+ * Return: None (void)
+ */
+void handlePasscodeLoad(uint8_t step, uint8_t passcode[])
+{
+    switch (step)
+    {
+        case LOAD_BEGIN:
+            beginPasscodeLoad();
+            printStoreOutput("load: open\r\n");
+            break;
+        case LOAD_PASSCODE:
+            if (loadPasscode(passcode) == STORE_FULL)
+            {
+                printStoreOutput("load: more than %u codes\r\n",
+                                 MAX_NUM_STORED_PASSCODES);
+            }
+            break;
+        case LOAD_COMMIT:
+            if (commitPasscodeLoad())
+            {
+                printStoreOutput("load: %u codes live\r\n",
+                                 liveStore->numPasscodes);
+            }
+            else
+            {
+                printStoreOutput("load: failed, %u codes still live\r\n",
+                                 liveStore->numPasscodes);
+            }
+            break;
+        case LOAD_ABORT:
+            abortPasscodeLoad();
+            printStoreOutput("load: dropped, %u codes still live\r\n",
+                             liveStore->numPasscodes);
+            break;
+        default:
+            break;
+    }
+}
+
+#endif // USE_CODE_SET_LOAD
+#endif // USE_CONSOLE_COMMANDS
+
+#ifdef USE_TELEMETRY
+/*
+ * This function queues a status frame every TELEMETRY_INTERVAL_MS and moves
+ * queued bytes to the UART. It is called once per main loop iteration.
+ *
+ * Return: None (void)
+ */
+void serviceTelemetry()
+{
+    uint32_t now = getTimeMS();
+
+    telemetryIntervalLoops++;
+    if ((int32_t)(now - telemetryNextStatusMS) >= 0)
+    {
+        queueTelemetryStatus(now);
+        telemetryIntervalLoops = 0;
+        telemetryNextStatusMS = now + TELEMETRY_INTERVAL_MS;
+    }
+
+    sendTelemetry();
+}
+
+#ifdef USE_TICKLESS_IDLE
+/*
+ * This function gets how long the processor may idle before serviceTelemetry()
+ * has to run again, to queue the next status frame or to send bytes that did
+ * not fit in the UART FIFO.
+ *
+ * Return: (uint32_t): The idle timeout in milliseconds (never NO_TIMEOUT).
+ */
+uint32_t getTelemetryTimeoutMS()
+{
+    if (telemetryTxTail != telemetryTxHead) { return TELEMETRY_DRAIN_MS; }
+
+    int32_t untilStatus = (int32_t)(telemetryNextStatusMS - getTimeMS());
+    uint32_t timeoutMS = (untilStatus > 0) ? untilStatus : 1;
+    if ((IDLE_TIMEOUT_MS != NO_TIMEOUT) && (IDLE_TIMEOUT_MS < timeoutMS))
+    {
+        timeoutMS = IDLE_TIMEOUT_MS;
+    }
+    return timeoutMS;
+}
+#endif
+
+/*
+ * This function counts the outcome of a passcode entered in currentMode and
+ * queues a verdict frame.
+ *
+ * Param: accepted: The passcode was accepted (checked, stored or removed)?
+ * Return: None (void)
+ */
+void recordTelemetryVerdict(bool accepted)
+{
+    // Modes 1-4 are operations 0-3
+    uint8_t operation = (currentMode - MODE_1_CHECK_CODE);
+    if (operation >= TELEMETRY_NUM_OPERATIONS) { return; }
+    telemetryVerdicts[operation][accepted]++;
+
+    uint8_t payload[TELEMETRY_VERDICT_SIZE];
+    uint8_t *next = putTelemetryU32(payload, getTimeMS());
+    *next++ = operation;
+    *next++ = accepted;
+    *next++ = liveStore->numPasscodes;
+    queueTelemetryFrame(TELEMETRY_FRAME_VERDICT, payload, sizeof(payload));
+}
+
+/*
+ * This function queues a status frame (see telemetry.h).
+ *
+ * Param: now: Milliseconds since boot.
+ * Return: None (void)
+ */
+void queueTelemetryStatus(uint32_t now)
+{
+    // Loop rate over the interval that just ended
+    uint32_t intervalMS = now - (telemetryNextStatusMS - TELEMETRY_INTERVAL_MS);
+    uint32_t loopsPerSecond = 0;
+    if ((telemetrySequence > 0) && (intervalMS > 0))
+    {
+        loopsPerSecond = (uint32_t)(((uint64_t)telemetryIntervalLoops * 1000) /
+                                    intervalMS);
+    }
+
+    uint8_t payload[TELEMETRY_STATUS_SIZE];
+    uint8_t *next = putTelemetryU16(payload, telemetrySequence++);
+    next = putTelemetryU32(next, now);
+    next = putTelemetryU32(next, loopsPerSecond);
+    next = putTelemetryU32(next, telemetryKeyPresses);
+    *next++ = currentMode;
+    *next++ = liveStore->numPasscodes;
+    *next++ = MAX_NUM_STORED_PASSCODES;
+    for (int i = 0; i < TELEMETRY_NUM_OPERATIONS; i++)
+    {
+        next = putTelemetryU16(next, telemetryVerdicts[i][true]);
+        next = putTelemetryU16(next, telemetryVerdicts[i][false]);
+    }
+    next = putTelemetryU16(next, telemetryExpiredPasscodes);
+    next = putTelemetryU16(next, telemetryDroppedFrames);
+
+    queueTelemetryFrame(TELEMETRY_FRAME_STATUS, payload, sizeof(payload));
+}
+
+/*
+ * This function frames a payload into the TX buffer. Frames are dropped
+ * whole (and counted) when the buffer is full, so the decoder never sees a
+ * partial frame.
+ *
+ * Param: type: The frame type (TELEMETRY_FRAME_*).
+ * Param: payload: The payload.
+ * Param: length: The payload length in bytes.
+ * Return: None (void)
+ */
+void queueTelemetryFrame(uint8_t type, const uint8_t payload[], uint8_t length)
+{
+    uint16_t used = ((telemetryTxHead - telemetryTxTail) &
+                     (TELEMETRY_TX_BUFFER_SIZE - 1));
+    if ((used + length + TELEMETRY_FRAME_OVERHEAD) >= TELEMETRY_TX_BUFFER_SIZE)
+    {
+        telemetryDroppedFrames++;
+        return;
+    }
+
+    queueTelemetryByte(TELEMETRY_SYNC_0);
+    queueTelemetryByte(TELEMETRY_SYNC_1);
+    queueTelemetryByte(type);
+    queueTelemetryByte(length);
+
+    // The CRC covers the type, length and payload
+    uint16_t crc = updateTelemetryCRC(updateTelemetryCRC(TELEMETRY_CRC_INIT,
+                                                         type), length);
+    for (uint8_t i = 0; i < length; i++)
+    {
+        queueTelemetryByte(payload[i]);
+        crc = updateTelemetryCRC(crc, payload[i]);
+    }
+    queueTelemetryByte(crc & 0xFF);
+    queueTelemetryByte(crc >> 8);
+}
+
+/*
+ * This function appends a byte to the TX buffer (the caller checks for room).
+ *
+ * Param: byte: The byte to queue.
+ * Return: None (void)
+ */
+void queueTelemetryByte(uint8_t byte)
+{
+    telemetryTxBuffer[telemetryTxHead] = byte;
+    telemetryTxHead = ((telemetryTxHead + 1) & (TELEMETRY_TX_BUFFER_SIZE - 1));
+}
+
+/*
+ * This function moves queued bytes to the UART until its FIFO is full (to
+ * the host backend on the host), without waiting.
+ *
+ * Return: None (void)
+ */
+void sendTelemetry()
+{
+#ifdef HOST_BUILD
+    while (telemetryTxTail != telemetryTxHead)
+    {
+        // Contiguous bytes up to the head or the end of the buffer
+        uint16_t end = ((telemetryTxHead > telemetryTxTail) ?
+                        telemetryTxHead : TELEMETRY_TX_BUFFER_SIZE);
+        size_t sent = hostWriteUART(&telemetryTxBuffer[telemetryTxTail],
+                                    end - telemetryTxTail);
+        if (sent == 0) { break; }
+        telemetryTxTail = ((telemetryTxTail + sent) &
+                           (TELEMETRY_TX_BUFFER_SIZE - 1));
+    }
+#else
+    while ((telemetryTxTail != telemetryTxHead) &&
+           !XUartPs_IsTransmitFull(STDOUT_BASEADDRESS))
+    {
+        XUartPs_WriteReg(STDOUT_BASEADDRESS, XUARTPS_FIFO_OFFSET,
+                         telemetryTxBuffer[telemetryTxTail]);
+        telemetryTxTail = ((telemetryTxTail + 1) &
+                           (TELEMETRY_TX_BUFFER_SIZE - 1));
+    }
+#endif
+}
+
+/*
+ * This function writes a little endian 16 bit value.
+ *
+ * Param: buffer: Where to write the value.
+ * Param: value: The value.
+ * Return: (uint8_t *): The byte after the value.
+ */
+uint8_t *putTelemetryU16(uint8_t *buffer, uint16_t value)
+{
+    buffer[0] = (value & 0xFF);
+    buffer[1] = (value >> 8);
+    return &buffer[2];
+}
+
+/*
+ * This function writes a little endian 32 bit value.
+ *
+ * Param: buffer: Where to write the value.
+ * Param: value: The value.
+ * Return: (uint8_t *): The byte after the value.
+ */
+uint8_t *putTelemetryU32(uint8_t *buffer, uint32_t value)
+{
+    return putTelemetryU16(putTelemetryU16(buffer, (value & 0xFFFF)),
+                           (value >> 16));
+}
+#endif // USE_TELEMETRY
+
+#ifdef USE_DUAL_CORE
+/*
+ * This function maps the shared memory holding the queues and starts the
+ * other core. On the target, CPU0 (the store core) clears the queues, releases
+ * CPU1 from the boot ROM and runs the store core without returning. CPU1 (the
+ * I/O core) returns to run the main loop. On the host the store core is a
+ * thread and the calling thread is the I/O core.
+ *
+ * Return: None (void)
+ */
+void initDualCore()
+{
+#ifdef HOST_BUILD
+    memset(dualCoreShared, 0, sizeof(DualCoreSharedMemory));
+    pthread_create(&storeCoreThread, NULL, runStoreCoreThread, NULL);
+#else
+    Xil_SetTlbAttributes(DUAL_CORE_SHARED_BASE_ADDR,
+                         DUAL_CORE_SHARED_ATTRIBUTES);
+
+#if XPAR_CPU_ID == STORE_CORE
+    memset(dualCoreShared, 0, sizeof(DualCoreSharedMemory));
+
+    // Release CPU1
+    Xil_Out32(CPU1_START_ADDR_REG, IO_CORE_START_ADDR);
+    sendCoreEvent();
+
+    runStoreCore();
+#endif
+#endif
+}
+
+/*
+ * This function runs the store core: it handles the passcodes sent by the I/O
+ * core, replies with each verdict and only then does the slow work (the access
+ * log over UART and the sweep after a reset), so the I/O core never waits on
+ * it.
+ *
+ * Return: None (does not return)
+ */
+void runStoreCore()
+{
+    resetStoredPasscodes();
+
+    while (true)
+    {
+        CoreMessage request;
+        receiveCoreMessage(&dualCoreShared->requests, &request, STORE_CORE);
+
+        if (request.type == MESSAGE_RESET)
+        {
+            abortPasscodeLoad();
+            resetStoredPasscodes();
+        }
+        else if (request.type == MESSAGE_PASSCODE)
+        {
+            CoreMessage reply = {.type = MESSAGE_VERDICT};
+            reply.accepted = handlePasscode(request.mode, request.passcode);
+            reply.numStored = liveStore->numPasscodes;
+            sendCoreMessage(&dualCoreShared->replies, &reply);
+        }
+#ifdef USE_CODE_SET_LOAD
+        else if (request.type == MESSAGE_LOAD)
+        {
+            // (Its output goes to the I/O core, see printStoreOutput)
+            handlePasscodeLoad(request.loadStep, request.passcode);
+            CoreMessage reply = {.type = MESSAGE_DONE};
+            sendCoreMessage(&dualCoreShared->replies, &reply);
+        }
+#endif
+#ifdef USE_CONSOLE_LINES
+        else if (request.type == MESSAGE_CONSOLE_LINE)
+        {
+            handleConsoleLine(request.command, request.text);
+            memset(request.text, 0, sizeof(request.text));
+            CoreMessage reply = {.type = MESSAGE_DONE};
+            sendCoreMessage(&dualCoreShared->replies, &reply);
         }
-    }
+#endif
 
-    // Return with no errors
-    return 0;
+        // Blank what the last store reset left behind, a little at a time
+        sweepStoredPasscodes();
+    }
 }
 
+#ifdef HOST_BUILD
 /*
- * This function toggles the current mode.
+ * This function is the entry point of the store core thread.
  *
- * Return: None (void)
+ * Param: argument: Unused.
+ * Return: (void *): Does not return.
  */
-void toggleMode()
+void *runStoreCoreThread(void *argument)
 {
-    // Toggle the current mode
-    switch (currentMode)
-    {
-        case MODE_1_CHECK_CODE:
-            setMode(MODE_2_SET_CODE);    // Change mode to check mode
-            break;
-        case MODE_2_SET_CODE:
-            setMode(MODE_3_REMOVE_CODE);    // Change mode to set mode
-            break;
-        case MODE_3_REMOVE_CODE:
-            setMode(MODE_1_CHECK_CODE);  // Change mode to remove mode
-            break;
-        default:
-            setMode(DEFAULT_MODE);
-            break;
-    }
+    (void)argument;
+    runStoreCore();
+    return NULL;
 }
+#endif
 
 /*
- * This function sets the current mode, changes mode led, and
- * resets current entry code.
+ * This function sends a complete passcode to the store core and waits for
+ * its verdict, then logs it (the I/O core owns the UART).
  *
- * Return: None (void)
+ * Param: mode: The mode the passcode was entered in.
+ * Param: passcode: The complete passcode.
+ * Return: (bool): Passcode accepted (see handlePasscode())?
  */
-void setMode(Mode mode)
+bool requestPasscodeVerdict(uint8_t mode, uint8_t passcode[])
 {
-    // Set the current mode
-    currentMode = mode;
-
-    // Set the mode LED to the current mode color
-    setModeLED();
+    CoreMessage request = {.type = MESSAGE_PASSCODE, .mode = mode};
+    memcpy(request.passcode, passcode, PASSCODE_LENGTH);
+    sendCoreMessage(&dualCoreShared->requests, &request);
 
-    // Reset currentPasscode to null values of 0xF
-    resetCurrentPasscode();
+    CoreMessage reply;
+    receiveCoreMessage(&dualCoreShared->replies, &reply, IO_CORE);
+    logPasscodeVerdict(mode, reply.accepted, reply.numStored);
+    return reply.accepted;
 }
 
 /*
- * This function resets storedPasscodes.
+ * This function has the store core reset the store and drop any code set
+ * being loaded. Requests are handled in order, so this does not wait.
  *
  * Return: None (void)
  */
-void resetStoredPasscodes()
+void requestStoreReset()
 {
-    // Clear any stored passcodes and reset index
-    memset(storedPasscodes, 0xF, sizeof(storedPasscodes[0][0]) *
-                                 MAX_NUM_STORED_PASSCODES * PASSCODE_LENGTH);
-    currentStoredPasscodesIndex = 0;
+    CoreMessage request = {.type = MESSAGE_RESET};
+    sendCoreMessage(&dualCoreShared->requests, &request);
 }
 
+#ifdef USE_CODE_SET_LOAD
 /*
- * This function resets currentPasscode.
+ * This function has the store core carry out a step of a code set load, and
+ * prints its outcome once it is done. Checks are served from the live bank
+ * between steps, and checks sent after a commit from the new code set.
  *
+ * Param: step: The step (LoadStep).
+ * Param: passcode: The passcode to load (LOAD_PASSCODE only, else NULL).
  * Return: None (void)
  */
-void resetCurrentPasscode()
+void requestPasscodeLoad(uint8_t step, uint8_t passcode[])
 {
-    // Clear current passcode
-    memset(currentPasscode, 0xF, sizeof(currentPasscode[0]) * PASSCODE_LENGTH);
-    currentPasscodeIndex = 0;
-
-    // Display the current passcode to the seven segment display
-    displayPasscode(currentPasscode);
+    CoreMessage request = {.type = MESSAGE_LOAD, .loadStep = step};
+    if (passcode != NULL)
+    {
+        memcpy(request.passcode, passcode, PASSCODE_LENGTH);
+    }
+    sendCoreMessage(&dualCoreShared->requests, &request);
+    waitForStoreCore();
 }
+#endif
 
+#ifdef USE_CONSOLE_LINES
 /*
- * This function stores passcode to storedPasscodes.
+ * This function has the store core run a command with its line of
+ * arguments, and prints its outcome once it is done.
  *
- * Param: passcode: The passcode to store.
- * Return: (bool): Passcode stored successfully?
+ * Param: command: The command character.
+ * Param: line: Its arguments.
+ * Return: None (void)
  */
-bool storePasscode(uint8_t passcode[])
+void requestConsoleLine(uint8_t command, const char line[])
 {
-    // Ensure storedPasscodes is not full
-    if (isStoredPasscodesFull()) { return false; }
-
-    // Add passcode and increment index
-    storedPasscodes[currentStoredPasscodesIndex][0] = passcode[0];
-    storedPasscodes[currentStoredPasscodesIndex][1] = passcode[1];
-    storedPasscodes[currentStoredPasscodesIndex][2] = passcode[2];
-    storedPasscodes[currentStoredPasscodesIndex][3] = passcode[3];
-    currentStoredPasscodesIndex++;
-
-    return true;
+    CoreMessage request = {.type = MESSAGE_CONSOLE_LINE, .command = command};
+    snprintf(request.text, sizeof(request.text), "%s", line);
+    sendCoreMessage(&dualCoreShared->requests, &request);
+    memset(request.text, 0, sizeof(request.text));
+    waitForStoreCore();
 }
+#endif
 
 /*
- * This function removes passcode from storedPasscodes.
+ * This function waits for the store core to finish a load step or a console
+ * line, printing the output it sends on the way (see printStoreOutput).
  *
- * Param: passcode: The passcode to remove.
- * Return: (bool): Passcode removed successfully?
+ * Return: None (void)
  */
-bool removePasscode(uint8_t passcode[])
+void waitForStoreCore()
 {
-    // Ensure passcode in storedPasscodes
-    if (!isExistingPasscode(passcode)) { return false; }
-
-    // Find passcode index
-    int i = 0;
-    for (; i < currentStoredPasscodesIndex; i++)
-    {
-        if ((passcode[0] == storedPasscodes[i][0]) &&
-            (passcode[1] == storedPasscodes[i][1]) &&
-            (passcode[2] == storedPasscodes[i][2]) &&
-            (passcode[3] == storedPasscodes[i][3]))
-        {
-            break;
-        }
-    }
-
-    // Shift all elements back and remove passcode
-    for (; i < currentStoredPasscodesIndex - 1; i++)
+    CoreMessage reply;
+    receiveCoreMessage(&dualCoreShared->replies, &reply, IO_CORE);
+    while (reply.type == MESSAGE_OUTPUT)
     {
-        storedPasscodes[i][0] = storedPasscodes[i + 1][0];
-        storedPasscodes[i][1] = storedPasscodes[i + 1][1];
-        storedPasscodes[i][2] = storedPasscodes[i + 1][2];
-        storedPasscodes[i][3] = storedPasscodes[i + 1][3];
+        printf("%s", reply.text);
+        receiveCoreMessage(&dualCoreShared->replies, &reply, IO_CORE);
     }
-
-    // Blank out last code
-    currentStoredPasscodesIndex--;
-    storedPasscodes[currentStoredPasscodesIndex][0] = 0xF;
-    storedPasscodes[currentStoredPasscodesIndex][1] = 0xF;
-    storedPasscodes[currentStoredPasscodesIndex][2] = 0xF;
-    storedPasscodes[currentStoredPasscodesIndex][3] = 0xF;
-
-    return true;
 }
 
 /*
- * This function stores a digit to currentPasscode.
+ * This function prints an access log line for a handled passcode (never the
+ * passcode itself).
  *
- * Param: digitData: The digit to store.
- * Return: (bool): Digit stored successfully?
+ * Param: mode: The mode the passcode was entered in.
+ * Param: accepted: The passcode was accepted?
+ * Param: numStored: Passcodes stored after it was handled.
+ * Return: None (void)
  */
-bool storeCurrentPasscodeDigit(uint8_t digitData)
+void logPasscodeVerdict(uint8_t mode, bool accepted, uint8_t numStored)
 {
-    // Ensure passcode is not complete
-    if (isCurrentPasscodeComplete()) { return false; }
-
-    // Store passcode
-    currentPasscode[currentPasscodeIndex++] = (digitData & 0xF);
-
-    // Display the current passcode to the seven segment display
-    displayPasscode(currentPasscode);
-
-    return true;
+    printf("log: %lu s mode %u %s (%u stored)\r\n",
+           (unsigned long)getTimeSeconds(), mode,
+           accepted ? "accepted" : "rejected", numStored);
 }
 
 /*
- * This function checks if passcode is equal to MASTER_PASSCODE.
+ * This function sends a message to the other core, waiting while the queue
+ * is full.
  *
- * Param: passcode: The passcode to check.
- * Return: (bool): passcode equals MASTER_PASSCODE?
+ * Param: queue: The queue (this core must be its producer).
+ * Param: message: The message.
+ * Return: None (void)
  */
-bool isMasterPasscode(uint8_t passcode[])
+void sendCoreMessage(CoreQueue *queue, const CoreMessage *message)
 {
-    return ((passcode[0] == MASTER_PASSCODE[0]) &&
-            (passcode[1] == MASTER_PASSCODE[1]) &&
-            (passcode[2] == MASTER_PASSCODE[2]) &&
-            (passcode[3] == MASTER_PASSCODE[3]));
+    while (!pushCoreMessage(queue, message))
+    {
+        // The consumer sends an event once it has taken a message
+        waitForCoreEvent((queue == &dualCoreShared->requests) ? IO_CORE :
+                                                                STORE_CORE);
+    }
+    sendCoreEvent();
 }
 
 /*
- * This function checks if passcode exists in storedPasscodes.
+ * This function receives a message from the other core, waiting while the
+ * queue is empty.
  *
- * Param: passcode: The passcode to check.
- * Return: (bool): passcode exists in storedPasscodes?
+ * Param: queue: The queue (this core must be its consumer).
+ * Param: message: Where to put the message.
+ * Param: core: This core.
+ * Return: None (void)
  */
-bool isExistingPasscode(uint8_t passcode[])
+void receiveCoreMessage(CoreQueue *queue, CoreMessage *message, uint8_t core)
 {
-    for (int i = 0; i < currentStoredPasscodesIndex; i++)
+    while (!popCoreMessage(queue, message))
     {
-        if ((passcode[0] == storedPasscodes[i][0]) &&
-            (passcode[1] == storedPasscodes[i][1]) &&
-            (passcode[2] == storedPasscodes[i][2]) &&
-            (passcode[3] == storedPasscodes[i][3]))
-        {
-            return true;
-        }
+        waitForCoreEvent(core);
     }
-    return false;
+    sendCoreEvent();  // Wake a producer waiting for room
 }
 
 /*
- * This function checks if storedPasscodes is full.
+ * This function adds a message to a queue if it has room. The message is
+ * written before the new head is published (release), so the consumer never
+ * sees a partly written message.
  *
- * Return: (bool): storedPasscodes is full?
+ * Param: queue: The queue (this core must be its producer).
+ * Param: message: The message.
+ * Return: (bool): Message added?
  */
-bool isStoredPasscodesFull()
+bool pushCoreMessage(CoreQueue *queue, const CoreMessage *message)
 {
-    return (currentStoredPasscodesIndex == MAX_NUM_STORED_PASSCODES);
+    uint32_t head = queue->head;
+    if ((head - __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE)) ==
+        CORE_QUEUE_SIZE)
+    {
+        return false;
+    }
+
+    queue->messages[head & (CORE_QUEUE_SIZE - 1)] = *message;
+    __atomic_store_n(&queue->head, head + 1, __ATOMIC_RELEASE);
+    return true;
 }
 
 /*
- * This function checks if currentPasscode is complete.
+ * This function takes the oldest message from a queue if there is one. The
+ * message is copied out before the new tail is published (release), so the
+ * producer never overwrites it early.
  *
- * Return: (bool): currentPasscode is complete?
+ * Param: queue: The queue (this core must be its consumer).
+ * Param: message: Where to put the message.
+ * Return: (bool): Message taken?
  */
-bool isCurrentPasscodeComplete()
+bool popCoreMessage(CoreQueue *queue, CoreMessage *message)
 {
-    return (currentPasscodeIndex == PASSCODE_LENGTH);
+    uint32_t tail = queue->tail;
+    if (tail == __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE))
+    {
+        return false;
+    }
+
+    *message = queue->messages[tail & (CORE_QUEUE_SIZE - 1)];
+    __atomic_store_n(&queue->tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
 }
 
 /*
- * This function writes to the onboard leds.
+ * This function waits for an event from the other core. Like WFE, it returns
+ * at once if an event was sent since the last wait, so an event sent between
+ * checking a queue and waiting is not lost.
  *
- * Param: ledData: Data to write to leds (lower 6 bits only).
+ * Param: core: This core.
  * Return: None (void)
  */
-void setLEDS(uint8_t ledData)
+void waitForCoreEvent(uint8_t core)
 {
-    AXILAB_SLAVE_LED_mWriteReg(RGB_LEDS_BASE_ADDR, 0, (ledData & 0x3F));
+#ifdef HOST_BUILD
+    pthread_mutex_lock(&coreEventMutex);
+    while (!coreEventRegisters[core])
+    {
+        pthread_cond_wait(&coreEventCondition, &coreEventMutex);
+    }
+    coreEventRegisters[core] = false;
+    pthread_mutex_unlock(&coreEventMutex);
+#else
+    (void)core;
+    wfe();
+#endif
 }
 
 /*
- * This function sets the LED color for the current mode.
+ * This function sends an event to both cores (SEV) after its queue writes
+ * have completed.
  *
  * Return: None (void)
  */
-void setModeLED()
+void sendCoreEvent()
 {
-    switch (currentMode)
+#ifdef HOST_BUILD
+    pthread_mutex_lock(&coreEventMutex);
+    for (int core = 0; core < NUM_CORES; core++)
     {
-        case MODE_1_CHECK_CODE:
-            setLEDS(LED_0_BLUE_MASK);
-            break;
-        case MODE_2_SET_CODE:
-            setLEDS(LED_0_YELLOW_MASK);
-            break;
-        case MODE_3_REMOVE_CODE:
-            setLEDS(LED_0_PURPLE_MASK);
-            break;
-        default:
-            break;
+        coreEventRegisters[core] = true;
     }
+    pthread_cond_broadcast(&coreEventCondition);
+    pthread_mutex_unlock(&coreEventMutex);
+#else
+    dsb();
+    sev();
+#endif
 }
+#endif // USE_DUAL_CORE
 
+#ifdef USE_DIAGNOSTICS
 /*
- * This function flashes the status led a certain color indicating the
- * status of an operation.
+ * This function records a mode button press and detects the diagnostics
+ * sequence (DIAGNOSTICS_MODE_PRESSES presses within DIAGNOSTICS_SEQUENCE_MS).
  *
- * Param: statusColor: The color to flash status led with.
- * Return: None (void)
+ * Param: previousMode: The mode before this press.
+ * Param: sequenceStartMode: Set to the mode before the sequence started.
+ * Return: (bool): The diagnostics sequence is complete?
  */
-void flashStatusLED(uint8_t statusColor)
+bool recordModePress(Mode previousMode, Mode *sequenceStartMode)
 {
-    // Ensure only led1 is being set
-    statusColor = (statusColor & 0b111000);
+    uint32_t now = getTimeMS();
+    modePressTimes[modePressNext] = now;
+    modePressModes[modePressNext] = previousMode;
+    modePressNext = ((modePressNext + 1) % DIAGNOSTICS_MODE_PRESSES);
+    if (modePressCount < DIAGNOSTICS_MODE_PRESSES) { modePressCount++; }
+    if (modePressCount < DIAGNOSTICS_MODE_PRESSES) { return false; }
 
-    // Determine mode color
-    uint8_t modeColor = 0;
-    switch (currentMode)
+    // Oldest of the last DIAGNOSTICS_MODE_PRESSES presses (the next slot)
+    uint8_t oldest = modePressNext;
+    if ((now - modePressTimes[oldest]) > DIAGNOSTICS_SEQUENCE_MS)
     {
-        case MODE_1_CHECK_CODE:
-            modeColor = LED_0_BLUE_MASK;
-            break;
-        case MODE_2_SET_CODE:
-            modeColor = LED_0_YELLOW_MASK;
-            break;
-        case MODE_3_REMOVE_CODE:
-            modeColor = LED_0_PURPLE_MASK;
-            break;
+        return false;
     }
 
-    // Flash status led twice (total of 0.5 seconds)
-    for (int i = 0; i < 2; i++)
+    *sequenceStartMode = modePressModes[oldest];
+    modePressCount = 0;
+    return true;
+}
+
+/*
+ * This function records the latency of a key press noticed by the main loop.
+ *
+ * Param: cycles: Keypad slave cycles since the key was pressed.
+ * Return: None (void)
+ */
+void recordKeyLatency(uint32_t cycles)
+{
+    if ((keyLatencyCount == 0) || (cycles < keyLatencyMinCycles))
     {
-        setLEDS(modeColor | statusColor);  // Flash status led on
-        delayMS(125);                      // Delay program
-        setLEDS(modeColor);                // Flash status led off
-        delayMS(125);                      // Delay program
+        keyLatencyMinCycles = cycles;
     }
+    if (cycles > keyLatencyMaxCycles) { keyLatencyMaxCycles = cycles; }
+    keyLatencyTotalCycles += cycles;
+    keyLatencyCount++;
 }
 
 /*
- * This function determines if the reset button is being pressed.
+ * This function prints the key press latencies recorded since the last
+ * diagnostics run over UART and clears them. Comparing runs with and without
+ * USE_TICKLESS_IDLE shows the cost of waking on the keypad interrupt against
+ * polling.
  *
- * Return: (bool): Reset button is being pressed?
+ * Return: None (void)
  */
-bool isResetButtonPressed()
+void printKeyLatency()
 {
-    return (AXILAB_SLAVE_BUTTON_mReadReg(ONBOARD_PUSH_BASE_ADDR, 0) &
-            RESET_BUTTON_MASK);
+    if (keyLatencyCount == 0)
+    {
+        printf("key latency: no key presses\r\n");
+        return;
+    }
+
+    const uint32_t cyclesPerUS = (KEYPAD_CLOCK_HZ / 1000000);
+    printf("key latency: min %lu us, mean %lu us, max %lu us (%lu presses)\r\n",
+           (unsigned long)(keyLatencyMinCycles / cyclesPerUS),
+           (unsigned long)((keyLatencyTotalCycles / keyLatencyCount) /
+                           cyclesPerUS),
+           (unsigned long)(keyLatencyMaxCycles / cyclesPerUS),
+           (unsigned long)keyLatencyCount);
+
+    keyLatencyCount = 0;
+    keyLatencyMaxCycles = 0;
+    keyLatencyTotalCycles = 0;
 }
 
 /*
- * This function determines if the reset button has been released. This is
- * indicated by a falling edge on button state.
+ * This function runs the diagnostics: it benchmarks every AXI slave, the main
+ * loop and the passcode store, prints the results over UART and shows them on
+ * the seven segment display (mode led white). A key press ends the display
+ * early. The mode from before the button sequence is then restored.
  *
- * Return: (bool): Reset button has been released?
+ * Param: restoreMode: The mode to return to.
+ * Return: None (void)
  */
-bool isResetButtonReleased()
+void runDiagnostics(Mode restoreMode)
 {
-    // Get whether the reset button was pressed
-    bool currentResetButtonState = isResetButtonPressed();
+    setLEDS(LED_0_BLUE_MASK | LED_0_GREEN_MASK | LED_0_RED_MASK);
 
-    // Check if a falling edge has occurred
-    bool fallingEdgeReset = (previousResetButtonState &&
-                             !currentResetButtonState);
+    DiagnosticsResults results = {0};
+    for (uint8_t slave = 0; slave < NUM_DIAGNOSTICS_SLAVES; slave++)
+    {
+        benchmarkAXISlave(slave, &results);
+    }
+    benchmarkMainLoop(&results);
+#ifndef USE_DUAL_CORE
+    // (The store belongs to the other core in the dual core build)
+    benchmarkStore(&results);
+    benchmarkPlacement(&results);
+#endif
 
-    // Set the previous state to the current state
-    previousResetButtonState = currentResetButtonState;
+    printDiagnostics(&results);
+    showDiagnostics(&results);
 
-    return fallingEdgeReset;
+    setMode(restoreMode);
+    displayPasscode(currentPasscode);
 }
 
 /*
- * This function determines if the mode button is being pressed.
+ * This function measures the register read and write times of an AXI slave.
+ * Reads complete one at a time, so their mean time is the read latency.
+ * Writes are measured both waiting for each to complete (latency) and back to
+ * back (throughput of posted writes). The value read is written back, so the
+ * slave is left unchanged.
  *
- * Return: (bool): Mode button is being pressed?
+ * Param: slave: The slave (index into DIAGNOSTICS_REGISTERS).
+ * Param: results: Where to put the times.
+ * Return: None (void)
  */
-bool isModeButtonPressed()
+void benchmarkAXISlave(uint8_t slave, DiagnosticsResults *results)
 {
-    return (AXILAB_SLAVE_BUTTON_mReadReg(ONBOARD_PUSH_BASE_ADDR, 0) &
-            MODE_BUTTON_MASK);
+    UINTPTR address = DIAGNOSTICS_REGISTERS[slave];
+    u32 value = Xil_In32(address);
+    XTime start;
+
+    XTime_GetTime(&start);
+    for (int i = 0; i < DIAGNOSTICS_AXI_ACCESSES; i++)
+    {
+        value = Xil_In32(address);
+    }
+    results->readNS[slave] = getNanosecondsPerOperation(start,
+                                                        DIAGNOSTICS_AXI_ACCESSES);
+
+    XTime_GetTime(&start);
+    for (int i = 0; i < DIAGNOSTICS_AXI_ACCESSES; i++)
+    {
+        Xil_Out32(address, value);
+        completeRegisterWrites();
+    }
+    results->writeNS[slave] = getNanosecondsPerOperation(start,
+                                                         DIAGNOSTICS_AXI_ACCESSES);
+
+    XTime_GetTime(&start);
+    for (int i = 0; i < DIAGNOSTICS_AXI_ACCESSES; i++)
+    {
+        Xil_Out32(address, value);
+    }
+    completeRegisterWrites();
+    results->postedWriteNS[slave] =
+        getNanosecondsPerOperation(start, DIAGNOSTICS_AXI_ACCESSES);
 }
 
 /*
- * This function determines if a key on the keypad is being pressed.
+ * This function measures how many times per second the main loop can poll
+ * its inputs when nothing is pressed (the reset and mode buttons and the
+ * keypad, without the stateful release check).
  *
- * Return: (bool): Key on the keypad is being pressed?
+ * Param: results: Where to put the rate.
+ * Return: None (void)
  */
-bool isKeypadPressed()
+void benchmarkMainLoop(DiagnosticsResults *results)
 {
-    return (KEYPAD_BINARY_SLAVE_mReadReg(KEYPAD_BASE_ADDR, 0) != 0xF);
+    XTime start;
+    XTime_GetTime(&start);
+    for (int i = 0; i < DIAGNOSTICS_LOOP_PASSES; i++)
+    {
+        isResetButtonPressed();
+        isModeButtonPressed();
+        isKeypadPressed();
+        isKeypadRollover();
+#ifdef USE_TICKLESS_IDLE
+        isInputActive();
+#endif
+    }
+
+    uint32_t passNS = getNanosecondsPerOperation(start, DIAGNOSTICS_LOOP_PASSES);
+    results->loopsPerSecond = (passNS > 0) ? (1000000000UL / passNS) : 0;
 }
 
 /*
- * This function gets the keypad value that is being pressed.
+ * This function measures the time to look up a passcode that is not stored
+ * (the slowest lookup) and, unless the store is full, to store and
+ * remove one. The test passcode is removed again, so the store is left
+ * as it was.
  *
- * Return: (uint8_t): Digit value of keypad keypress.
+ * Param: results: Where to put the times.
+ * Return: None (void)
  */
-uint8_t getKeypadValue()
+void benchmarkStore(DiagnosticsResults *results)
 {
-    // Ensure keypad is pressed
-    if (!isKeypadPressed()) { return 0xF; }
+    // Find a passcode that is not stored (counting down from 9999)
+    uint8_t testPasscode[PASSCODE_LENGTH];
+    for (int code = 9999; code >= 0; code--)
+    {
+        for (int digit = (PASSCODE_LENGTH - 1), rest = code; digit >= 0;
+             digit--, rest /= 10)
+        {
+            testPasscode[digit] = (rest % 10);
+        }
+        if (!isMasterPasscode(testPasscode) && !isExistingPasscode(testPasscode))
+        {
+            break;
+        }
+    }
+
+    XTime start;
+    XTime_GetTime(&start);
+    for (int i = 0; i < DIAGNOSTICS_STORE_OPS; i++)
+    {
+        isExistingPasscode(testPasscode);
+    }
+    results->findNS = getNanosecondsPerOperation(start, DIAGNOSTICS_STORE_OPS);
+
+    if (isStoredPasscodesFull()) { return; }
+
+    XTime storeTime = 0;
+    XTime removeTime = 0;
+    for (int i = 0; i < DIAGNOSTICS_STORE_OPS; i++)
+    {
+        XTime stored;
+        XTime removed;
+        XTime_GetTime(&start);
+        insertPasscode(testPasscode);
+        XTime_GetTime(&stored);
+        erasePasscode(testPasscode);
+        XTime_GetTime(&removed);
 
-    // Return value of key press
-    return (KEYPAD_BINARY_SLAVE_mReadReg(KEYPAD_BASE_ADDR, 0) & 0xF);
+        storeTime += (stored - start);
+        removeTime += (removed - stored);
+    }
+    results->storeNS = countsToNanoseconds(storeTime, DIAGNOSTICS_STORE_OPS);
+    results->removeNS = countsToNanoseconds(removeTime, DIAGNOSTICS_STORE_OPS);
 }
 
 /*
- * This function displays a passcode to the seven segment display.
+ * This function measures the spread of lookup times with the passcode store
+ * in DDR and in OCM. A copy of the store (blank slots included) is
+ * placed in each memory and searched in full for an absent passcode. The
+ * copy is flushed from the data cache before every lookup, so each one pays
+ * for fetching the store from its memory, as a lookup after a cache miss
+ * does. The spread (max - min) is the jitter the placement causes.
  *
- * Param: passcode: The passcode to display.
+ * Param: results: Where to put the times.
  * Return: None (void)
  */
-void displayPasscode(uint8_t passcode[])
+void benchmarkPlacement(DiagnosticsResults *results)
 {
-    SEVEN_SEGMENT_DISPLAY_SLAVE_mWriteReg(SEVEN_SEGMENT_BASE_ADDR, 0,
-                                          (passcode[0] << 12) |
-                                          (passcode[1] << 8) |
-                                          (passcode[2] << 4) |
-                                          (passcode[3]));
+    uint16_t *copies[NUM_PLACEMENTS] = {ddrBenchmarkPasscodes,
+                                        ocmBenchmarkPasscodes};
+
+    for (uint8_t placement = 0; placement < NUM_PLACEMENTS; placement++)
+    {
+        uint16_t *passcodes = copies[placement];
+        memcpy(passcodes, liveStore->passcodes, sizeof(liveStore->passcodes));
+
+        XTime minTime = ~(XTime)0;
+        XTime maxTime = 0;
+        XTime totalTime = 0;
+        for (int i = 0; i < DIAGNOSTICS_PLACEMENT_LOOKUPS; i++)
+        {
+            Xil_DCacheFlushRange((INTPTR)passcodes, sizeof(liveStore->passcodes));
+
+            XTime start;
+            XTime end;
+            XTime_GetTime(&start);
+            searchPasscodes(passcodes, MAX_NUM_STORED_PASSCODES,
+                            BLANK_PACKED_PASSCODE - 1);
+            XTime_GetTime(&end);
+
+            XTime time = (end - start);
+            if (time < minTime) { minTime = time; }
+            if (time > maxTime) { maxTime = time; }
+            totalTime += time;
+        }
+
+        results->lookupMinNS[placement] = countsToNanoseconds(minTime, 1);
+        results->lookupMeanNS[placement] =
+            countsToNanoseconds(totalTime, DIAGNOSTICS_PLACEMENT_LOOKUPS);
+        results->lookupMaxNS[placement] = countsToNanoseconds(maxTime, 1);
+    }
 }
 
 /*
- * This function delays (blocking) by approximately (ms) milliseconds.
+ * This function prints diagnostics results over UART.
  *
- * Param: ms: The number of milliseconds to delay by.
+ * Param: results: The results.
  * Return: None (void)
  */
-void delayMS(uint16_t ms)
+void printDiagnostics(const DiagnosticsResults *results)
 {
-    for (int i = 0; i < ms; i++)
+    printf("diagnostics:\r\n");
+    printf("%-14s %8s %9s %10s %10s %11s\r\n", "slave", "read ns",
+           "write ns", "posted ns", "read MB/s", "write MB/s");
+    for (uint8_t slave = 0; slave < NUM_DIAGNOSTICS_SLAVES; slave++)
     {
-        for(int i = 0; i < 80000; i++) {}
+        uint32_t readNS = results->readNS[slave];
+        uint32_t postedWriteNS = results->postedWriteNS[slave];
+        printf("%-14s %8lu %9lu %10lu %10lu %11lu\r\n",
+               DIAGNOSTICS_SLAVE_NAMES[slave], (unsigned long)readNS,
+               (unsigned long)results->writeNS[slave],
+               (unsigned long)postedWriteNS,
+               (unsigned long)(readNS ? ((AXI_ACCESS_BYTES * 1000UL) / readNS) :
+                                        0),
+               (unsigned long)(postedWriteNS ?
+                               ((AXI_ACCESS_BYTES * 1000UL) / postedWriteNS) :
+                               0));
+    }
+    printf("main loop: %lu polls/s\r\n", (unsigned long)results->loopsPerSecond);
+#ifdef USE_DUAL_CORE
+    printf("store: on the store core\r\n");
+#else
+    printf("store: find %lu ns, store %lu ns, remove %lu ns (%u stored)\r\n",
+           (unsigned long)results->findNS, (unsigned long)results->storeNS,
+           (unsigned long)results->removeNS, liveStore->numPasscodes);
+    const char *PLACEMENT_NAMES[NUM_PLACEMENTS] = {"ddr", "ocm"};
+    for (uint8_t placement = 0; placement < NUM_PLACEMENTS; placement++)
+    {
+        printf("cold lookup %s: min %lu ns, mean %lu ns, max %lu ns, "
+               "jitter %lu ns\r\n", PLACEMENT_NAMES[placement],
+               (unsigned long)results->lookupMinNS[placement],
+               (unsigned long)results->lookupMeanNS[placement],
+               (unsigned long)results->lookupMaxNS[placement],
+               (unsigned long)(results->lookupMaxNS[placement] -
+                               results->lookupMinNS[placement]));
     }
+#ifndef USE_OCM_PLACEMENT
+    printf("(USE_OCM_PLACEMENT is off, both copies are in DDR)\r\n");
+#endif
+#endif // USE_DUAL_CORE
+    printKeyLatency();
 }
 
 /*
- * This function clears all outputs including the onboard leds and seven
- * segment display.
+ * This function shows diagnostics results on the seven segment display, one
+ * page of DIAGNOSTICS_PAGE_MS each, until all are shown or a key is pressed:
+ *  1-8: read / completed write ns of keypad, button, led, seven segment
+ *  9  : main loop polls per second (thousands)
+ *  0  : absent passcode lookup ns
  *
+ * Param: results: The results.
  * Return: None (void)
  */
-void clearOutputs()
+void showDiagnostics(const DiagnosticsResults *results)
 {
-    setLEDS(0);
-    uint8_t blankPasscode[] = {0xF, 0xF, 0xF, 0xF};
-    displayPasscode(blankPasscode);
+    uint32_t pages[NUM_DIAGNOSTICS_PAGES];
+    for (uint8_t slave = 0; slave < NUM_DIAGNOSTICS_SLAVES; slave++)
+    {
+        pages[2 * slave] = results->readNS[slave];
+        pages[(2 * slave) + 1] = results->writeNS[slave];
+    }
+    pages[8] = (results->loopsPerSecond / 1000);
+    pages[9] = results->findNS;
+
+    for (uint8_t page = 0; page < NUM_DIAGNOSTICS_PAGES; page++)
+    {
+        uint32_t value = pages[page];
+        if (value > DIAGNOSTICS_MAX_VALUE) { value = DIAGNOSTICS_MAX_VALUE; }
+
+        uint8_t digits[PASSCODE_LENGTH] = {((page + 1) % 10), (value / 100),
+                                           ((value / 10) % 10), (value % 10)};
+        displayPasscode(digits);
+
+        for (uint16_t waited = 0; waited < DIAGNOSTICS_PAGE_MS;
+             waited += DIAGNOSTICS_POLL_MS)
+        {
+            if (isKeypadPressed())
+            {
+                delayMS(450);  // Do not enter the key as a digit
+                return;
+            }
+            delayMS(DIAGNOSTICS_POLL_MS);
+        }
+    }
 }
 
 /*
- * This function resets the system by reseting the current and stored
- * passcode, and reseting the current mode.
+ * This function gets the mean time per operation since start.
  *
- * Return: None (void)
+ * Param: start: Global timer when the operations started.
+ * Param: operations: Number of operations.
+ * Return: (uint32_t): Nanoseconds per operation.
  */
-void resetSystem()
+uint32_t getNanosecondsPerOperation(XTime start, uint32_t operations)
 {
-    // Initialize storedPasscodes to null values of 0xF
-    resetStoredPasscodes();
-
-    // Initialize currentPasscode to null values of 0xF
-    resetCurrentPasscode();
+    XTime end;
+    XTime_GetTime(&end);
+    return countsToNanoseconds(end - start, operations);
+}
 
-    // Initialize current mode to default mode
-    setMode(DEFAULT_MODE);
+/*
+ * This function converts a global timer interval to nanoseconds per
+ * operation.
+ *
+ * Param: counts: Global timer counts taken by all the operations.
+ * Param: operations: Number of operations.
+ * Return: (uint32_t): Nanoseconds per operation.
+ */
+uint32_t countsToNanoseconds(XTime counts, uint32_t operations)
+{
+    return (uint32_t)((counts * 1000000000ULL) /
+                      ((uint64_t)COUNTS_PER_SECOND * operations));
 }
+#endif // USE_DIAGNOSTICS
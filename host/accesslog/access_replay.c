@@ -0,0 +1,810 @@
+/* -----------------------------------------------------------------------------
+ * Filename     : access_replay.c
+ * Author(s)    : Kyle Bielby, Chris Lloyd (Team 1)
+ * Class        : EE365 (Final Project)
+ * Target Board : Cora Z7-10 (host tools)
+ * Description  : Replays a recorded access log against one or more code sets
+ *                and counts the verdicts each code set gives, for incident
+ *                review ("would this code set have let them in?") and
+ *                capacity planning.
+ *
+ *                  access_replay [-t threads] [-s shard KB] [-b] [-v]
+ *                                -c CODES [-c CODES]... LOG
+ *                  access_replay -g records LOG CODES
+ *
+ *                A log line is one access attempt, "<seconds> <zone>
+ *                <passcode>" (seconds since boot, a zone 0-31 and 4 digits).
+ *                A code set line is "<passcode> [<zones> [<expires s>]]",
+ *                with zones a bitmap (all zones when left out) and the second
+ *                the passcode expires at (never when left out). Lines
+ *                starting with '#' are skipped in both.
+ *
+ *                Every attempt is decided like handlePasscode() in
+ *                Security_System.c decides a check in MODE_1_CHECK_CODE: the
+ *                master passcode is always accepted, any other passcode only
+ *                while it is stored, has not expired and opens the zone.
+ *
+ *                The log is split into shards of whole lines. Each worker
+ *                thread starts with a contiguous run of shards in its own
+ *                deque and takes them from the front; a worker whose deque is
+ *                empty steals from the back of another one. Each worker
+ *                parses and decides its shards against its own copy of the
+ *                code sets, so workers share nothing but the deques.
+ *
+ *                -b replays the log with 1, 2, 4... up to -t threads
+ *                (default: every CPU) and prints the scaling, -v prints the
+ *                time of every shard. -g writes a random log and code set.
+ * -------------------------------------------------------------------------- */
+
+// Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define PASSCODE_LENGTH  4
+#define CODE_SPACE       10000     // 10^PASSCODE_LENGTH
+#define MASTER_PASSCODE  0         // 0000, as in Security_System.c
+#define NUM_ZONES        32
+#define ALL_ZONES_MASK   0xFFFFFFFF
+#define NEVER_EXPIRES    UINT32_MAX
+#define NOT_STORED       0         // expiresS of a passcode not in the set
+
+#define MAX_CODE_SETS      8
+#define MAX_WORKERS        64
+#define DEFAULT_SHARD_KB   1024
+#define CACHE_LINE_BYTES   64
+
+// Random log written by -g
+#define GENERATED_CODES       100  // MAX_NUM_STORED_PASSCODES
+#define GENERATED_ZONES       4
+#define GENERATED_LOG_SECONDS (7 * 24 * 3600)
+
+typedef enum
+{
+    VERDICT_ACCEPTED,
+    VERDICT_MASTER,       // Accepted, master passcode
+    VERDICT_NOT_STORED,
+    VERDICT_WRONG_ZONE,
+    VERDICT_EXPIRED,
+    NUM_VERDICTS
+} Verdict;
+
+static const char *VERDICT_NAMES[NUM_VERDICTS] =
+{
+    "accepted", "master", "not stored", "wrong zone", "expired"
+};
+
+// A passcode of a code set
+typedef struct
+{
+    uint32_t zones;      // Bitmap of the zones it opens
+    uint32_t expiresS;   // Second it stops working (NOT_STORED if absent)
+} CodeEntry;
+
+// A code set, indexed by passcode (0-9999)
+typedef struct
+{
+    CodeEntry entries[CODE_SPACE];
+} CodeSet;
+
+// Lines of the log one worker replays at a time
+typedef struct
+{
+    _Alignas(CACHE_LINE_BYTES) const char *start;
+    const char *end;
+    uint64_t records;
+    uint64_t elapsedNS;
+    int worker;           // Worker that replayed it
+    bool stolen;          // Taken from another worker's deque?
+} Shard;
+
+// Shards a worker has left: [first, last) packed as last << 32 | first. The
+// owner takes the first, a thief the last, both with one compare and swap.
+typedef struct
+{
+    _Alignas(CACHE_LINE_BYTES) uint64_t range;
+} ShardDeque;
+
+// Totals of one worker (one cache line apart)
+typedef struct
+{
+    _Alignas(CACHE_LINE_BYTES) uint64_t verdicts[MAX_CODE_SETS][NUM_VERDICTS];
+    uint64_t changed[MAX_CODE_SETS];  // Verdict differs from the first set
+    uint64_t records;
+    uint64_t malformed;
+    uint64_t busyNS;
+    uint32_t shards;
+    uint32_t stolen;
+} WorkerTotals;
+
+typedef struct
+{
+    const CodeSet *codeSets;
+    int numCodeSets;
+    Shard *shards;
+    uint32_t numShards;
+    ShardDeque deques[MAX_WORKERS];
+    WorkerTotals totals[MAX_WORKERS];
+    int numWorkers;
+} Replay;
+
+typedef struct
+{
+    Replay *replay;
+    int worker;
+} WorkerArgument;
+
+/*
+ * This function gets a monotonic time in nanoseconds.
+ *
+ * Return: (uint64_t): Nanoseconds.
+ */
+static uint64_t getTimeNS()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000000ULL) + now.tv_nsec;
+}
+
+/*
+ * This function steps a xorshift generator.
+ *
+ * Return: (uint32_t): Next pseudo random number.
+ */
+static uint32_t nextRandom(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return (*state = x);
+}
+
+/*
+ * This function decides one access attempt against a code set, like
+ * handlePasscode() in MODE_1_CHECK_CODE (expired passcodes are removed before
+ * every check, so an expired passcode is not stored).
+ *
+ * Return: (Verdict): The verdict.
+ */
+static inline Verdict checkAccess(const CodeSet *codeSet, uint32_t seconds,
+                                  uint8_t zone, uint16_t passcode)
+{
+    if (passcode == MASTER_PASSCODE) { return VERDICT_MASTER; }
+
+    const CodeEntry *entry = &codeSet->entries[passcode];
+    if (entry->expiresS == NOT_STORED) { return VERDICT_NOT_STORED; }
+    if (seconds >= entry->expiresS) { return VERDICT_EXPIRED; }
+    if (!(entry->zones & (1UL << zone))) { return VERDICT_WRONG_ZONE; }
+    return VERDICT_ACCEPTED;
+}
+
+/*
+ * This function reads an unsigned decimal number and the spaces after it.
+ *
+ * Return: (int): Number of digits read (0 if there is no number).
+ */
+static int parseNumber(const char **cursor, const char *end, uint32_t *value)
+{
+    const char *next = *cursor;
+    uint64_t number = 0;
+    int digits = 0;
+    while ((next < end) && (*next >= '0') && (*next <= '9') && (digits < 10))
+    {
+        number = (number * 10) + (*next++ - '0');
+        digits++;
+    }
+    if ((digits == 0) || (number > UINT32_MAX)) { return 0; }
+
+    while ((next < end) && ((*next == ' ') || (*next == '\t') || (*next == '\r')))
+    {
+        next++;
+    }
+    *cursor = next;
+    *value = (uint32_t)number;
+    return digits;
+}
+
+/*
+ * This function parses one log line.
+ *
+ * Return: (bool): Line is a valid access attempt?
+ */
+static bool parseRecord(const char *line, const char *end, uint32_t *seconds,
+                        uint8_t *zone, uint16_t *passcode)
+{
+    uint32_t zoneNumber;
+    uint32_t passcodeNumber;
+    if ((parseNumber(&line, end, seconds) == 0) ||
+        (parseNumber(&line, end, &zoneNumber) == 0) ||
+        (zoneNumber >= NUM_ZONES) ||
+        (parseNumber(&line, end, &passcodeNumber) != PASSCODE_LENGTH) ||
+        (line != end))
+    {
+        return false;
+    }
+
+    *zone = (uint8_t)zoneNumber;
+    *passcode = (uint16_t)passcodeNumber;
+    return true;
+}
+
+/*
+ * This function parses and decides every line of a shard against each code
+ * set, adding the verdicts to a worker's totals.
+ *
+ * Return: None (void)
+ */
+static void replayShard(const CodeSet codeSets[], int numCodeSets,
+                        Shard *shard, WorkerTotals *totals)
+{
+    uint64_t records = 0;
+    const char *next = shard->start;
+    while (next < shard->end)
+    {
+        const char *line = next;
+        const char *end = memchr(line, '\n', shard->end - line);
+        if (end == NULL) { end = shard->end; }
+        next = end + 1;
+
+        if ((line == end) || (*line == '#') || (*line == '\r')) { continue; }
+
+        uint32_t seconds;
+        uint8_t zone;
+        uint16_t passcode;
+        if (!parseRecord(line, end, &seconds, &zone, &passcode))
+        {
+            totals->malformed++;
+            continue;
+        }
+
+        bool firstAccepted = false;
+        for (int set = 0; set < numCodeSets; set++)
+        {
+            Verdict verdict = checkAccess(&codeSets[set], seconds, zone, passcode);
+            bool accepted = (verdict <= VERDICT_MASTER);
+            totals->verdicts[set][verdict]++;
+            if (set == 0) { firstAccepted = accepted; }
+            else if (accepted != firstAccepted) { totals->changed[set]++; }
+        }
+        records++;
+    }
+
+    shard->records = records;
+    totals->records += records;
+}
+
+/*
+ * This function takes the first shard left in a worker's own deque.
+ *
+ * Return: (bool): A shard was taken?
+ */
+static bool takeOwnShard(ShardDeque *deque, uint32_t *shard)
+{
+    uint64_t range = __atomic_load_n(&deque->range, __ATOMIC_ACQUIRE);
+    while (true)
+    {
+        uint32_t first = (uint32_t)range;
+        uint32_t last = (uint32_t)(range >> 32);
+        if (first == last) { return false; }
+
+        uint64_t taken = ((uint64_t)last << 32) | (first + 1);
+        if (__atomic_compare_exchange_n(&deque->range, &range, taken, false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        {
+            *shard = first;
+            return true;
+        }
+    }
+}
+
+/*
+ * This function steals the last shard left in another worker's deque.
+ *
+ * Return: (bool): A shard was stolen?
+ */
+static bool stealShard(ShardDeque *deque, uint32_t *shard)
+{
+    uint64_t range = __atomic_load_n(&deque->range, __ATOMIC_ACQUIRE);
+    while (true)
+    {
+        uint32_t first = (uint32_t)range;
+        uint32_t last = (uint32_t)(range >> 32);
+        if (first == last) { return false; }
+
+        uint64_t stolen = ((uint64_t)(last - 1) << 32) | first;
+        if (__atomic_compare_exchange_n(&deque->range, &range, stolen, false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        {
+            *shard = last - 1;
+            return true;
+        }
+    }
+}
+
+/*
+ * This function replays shards, its own first and then stolen ones, until
+ * every deque is empty. No shards are added once the replay starts, so an
+ * empty sweep over all deques means the work is done.
+ *
+ * Return: (void *): NULL
+ */
+static void *runWorker(void *argument)
+{
+    Replay *replay = ((WorkerArgument *)argument)->replay;
+    int worker = ((WorkerArgument *)argument)->worker;
+    WorkerTotals *totals = &replay->totals[worker];
+    uint32_t random = (uint32_t)(worker * 2654435761u) | 1;
+
+    // Own copy of the code sets, so no cache line is shared with other workers
+    size_t codeSetBytes = replay->numCodeSets * sizeof(CodeSet);
+    CodeSet *codeSets = malloc(codeSetBytes);
+    if (codeSets == NULL) { return NULL; }
+    memcpy(codeSets, replay->codeSets, codeSetBytes);
+
+    while (true)
+    {
+        uint32_t index;
+        bool stolen = false;
+        if (!takeOwnShard(&replay->deques[worker], &index))
+        {
+            // Sweep the other deques from a random one
+            int start = (int)(nextRandom(&random) % replay->numWorkers);
+            for (int i = 0; (i < replay->numWorkers) && !stolen; i++)
+            {
+                int victim = (start + i) % replay->numWorkers;
+                stolen = ((victim != worker) &&
+                          stealShard(&replay->deques[victim], &index));
+            }
+            if (!stolen) { break; }
+        }
+
+        Shard *shard = &replay->shards[index];
+        uint64_t start = getTimeNS();
+        replayShard(codeSets, replay->numCodeSets, shard, totals);
+        shard->elapsedNS = getTimeNS() - start;
+        shard->worker = worker;
+        shard->stolen = stolen;
+
+        totals->busyNS += shard->elapsedNS;
+        totals->shards++;
+        totals->stolen += stolen;
+    }
+
+    free(codeSets);
+    return NULL;
+}
+
+/*
+ * This function splits a log into shards of about shardBytes, each ending at
+ * the end of a line.
+ *
+ * Return: (Shard *): The shards (NULL if out of memory).
+ */
+static Shard *splitLog(const char *log, size_t logBytes, size_t shardBytes,
+                       uint32_t *numShards)
+{
+    uint32_t maxShards = (uint32_t)((logBytes / shardBytes) + 1);
+    Shard *shards = aligned_alloc(CACHE_LINE_BYTES, maxShards * sizeof(Shard));
+    if (shards == NULL) { return NULL; }
+
+    uint32_t count = 0;
+    const char *start = log;
+    const char *logEnd = log + logBytes;
+    while (start < logEnd)
+    {
+        const char *end = logEnd;
+        if ((size_t)(logEnd - start) > shardBytes)
+        {
+            const char *newline = memchr(start + shardBytes, '\n',
+                                         logEnd - (start + shardBytes));
+            if (newline != NULL) { end = newline + 1; }
+        }
+
+        memset(&shards[count], 0, sizeof(Shard));
+        shards[count].start = start;
+        shards[count].end = end;
+        count++;
+        start = end;
+    }
+
+    *numShards = count;
+    return shards;
+}
+
+/*
+ * This function replays every shard on numWorkers threads. Worker w starts
+ * with the w-th contiguous run of shards, so each one reads the log in order
+ * until it has to steal.
+ *
+ * Return: (uint64_t): Wall time in nanoseconds.
+ */
+static uint64_t runReplay(Replay *replay, int numWorkers)
+{
+    pthread_t threads[MAX_WORKERS];
+    WorkerArgument arguments[MAX_WORKERS];
+
+    replay->numWorkers = numWorkers;
+    memset(replay->totals, 0, sizeof(replay->totals));
+    for (int worker = 0; worker < numWorkers; worker++)
+    {
+        uint64_t first = ((uint64_t)replay->numShards * worker) / numWorkers;
+        uint64_t last = ((uint64_t)replay->numShards * (worker + 1)) / numWorkers;
+        replay->deques[worker].range = (last << 32) | first;
+    }
+
+    uint64_t start = getTimeNS();
+    for (int worker = 0; worker < numWorkers; worker++)
+    {
+        arguments[worker].replay = replay;
+        arguments[worker].worker = worker;
+        pthread_create(&threads[worker], NULL, runWorker, &arguments[worker]);
+    }
+    for (int worker = 0; worker < numWorkers; worker++)
+    {
+        pthread_join(threads[worker], NULL);
+    }
+    return getTimeNS() - start;
+}
+
+/*
+ * This function adds up the totals of every worker.
+ *
+ * Return: None (void)
+ */
+static void sumTotals(const Replay *replay, WorkerTotals *sum)
+{
+    memset(sum, 0, sizeof(*sum));
+    for (int worker = 0; worker < replay->numWorkers; worker++)
+    {
+        const WorkerTotals *totals = &replay->totals[worker];
+        for (int set = 0; set < replay->numCodeSets; set++)
+        {
+            for (int verdict = 0; verdict < NUM_VERDICTS; verdict++)
+            {
+                sum->verdicts[set][verdict] += totals->verdicts[set][verdict];
+            }
+            sum->changed[set] += totals->changed[set];
+        }
+        sum->records += totals->records;
+        sum->malformed += totals->malformed;
+        sum->busyNS += totals->busyNS;
+        sum->shards += totals->shards;
+        sum->stolen += totals->stolen;
+    }
+}
+
+/*
+ * This function prints the verdicts per code set, the time of each worker
+ * and, with verbose, of each shard.
+ *
+ * Return: None (void)
+ */
+static void printReplay(const Replay *replay, char *codeSetNames[],
+                        uint64_t wallNS, bool verbose)
+{
+    WorkerTotals sum;
+    sumTotals(replay, &sum);
+
+    printf("%llu records (%llu malformed lines), %u shards, %d workers\n\n",
+           (unsigned long long)sum.records, (unsigned long long)sum.malformed,
+           replay->numShards, replay->numWorkers);
+
+    printf("%-24s", "code set");
+    for (int verdict = 0; verdict < NUM_VERDICTS; verdict++)
+    {
+        printf(" %11s", VERDICT_NAMES[verdict]);
+    }
+    printf(" %11s\n", "changed");
+    for (int set = 0; set < replay->numCodeSets; set++)
+    {
+        printf("%-24s", codeSetNames[set]);
+        for (int verdict = 0; verdict < NUM_VERDICTS; verdict++)
+        {
+            printf(" %11llu", (unsigned long long)sum.verdicts[set][verdict]);
+        }
+        if (set == 0) { printf(" %11s\n", "-"); }
+        else { printf(" %11llu\n", (unsigned long long)sum.changed[set]); }
+    }
+
+    printf("\n%6s %7s %7s %10s %9s %9s\n", "worker", "shards", "stolen",
+           "records", "busy ms", "Mrec/s");
+    for (int worker = 0; worker < replay->numWorkers; worker++)
+    {
+        const WorkerTotals *totals = &replay->totals[worker];
+        printf("%6d %7u %7u %10llu %9.1f %9.2f\n", worker, totals->shards,
+               totals->stolen, (unsigned long long)totals->records,
+               totals->busyNS / 1e6,
+               totals->busyNS ? (totals->records * 1e3) / totals->busyNS : 0.0);
+    }
+
+    if (verbose)
+    {
+        printf("\n%6s %6s %7s %10s %9s %9s\n", "shard", "worker", "stolen",
+               "records", "ms", "Mrec/s");
+        for (uint32_t i = 0; i < replay->numShards; i++)
+        {
+            const Shard *shard = &replay->shards[i];
+            printf("%6u %6d %7s %10llu %9.2f %9.2f\n", i, shard->worker,
+                   shard->stolen ? "yes" : "no",
+                   (unsigned long long)shard->records, shard->elapsedNS / 1e6,
+                   shard->elapsedNS ? (shard->records * 1e3) / shard->elapsedNS
+                                    : 0.0);
+        }
+    }
+
+    printf("\n%.1f ms wall, %.2f Mrecords/s\n", wallNS / 1e6,
+           (sum.records * 1e3) / wallNS);
+}
+
+/*
+ * This function replays the log with 1, 2, 4... up to maxWorkers threads and
+ * prints the throughput and its scaling against one thread.
+ *
+ * Return: (bool): Every run gave the same verdicts?
+ */
+static bool benchmarkReplay(Replay *replay, int maxWorkers)
+{
+    WorkerTotals first;
+    double singleRate = 0;
+    bool consistent = true;
+
+    printf("%7s %9s %9s %8s %11s %7s\n", "workers", "wall ms", "Mrec/s",
+           "speedup", "efficiency", "stolen");
+    for (int numWorkers = 1; true; numWorkers *= 2)
+    {
+        if (numWorkers > maxWorkers) { numWorkers = maxWorkers; }
+
+        uint64_t wallNS = runReplay(replay, numWorkers);
+        WorkerTotals sum;
+        sumTotals(replay, &sum);
+
+        double rate = (sum.records * 1e3) / wallNS;
+        if (numWorkers == 1)
+        {
+            first = sum;
+            singleRate = rate;
+        }
+        else
+        {
+            consistent &= (memcmp(first.verdicts, sum.verdicts,
+                                  sizeof(sum.verdicts)) == 0);
+        }
+        printf("%7d %9.1f %9.2f %7.2fx %10.0f%% %7u\n", numWorkers, wallNS / 1e6,
+               rate, rate / singleRate, (100.0 * rate) / (singleRate * numWorkers),
+               sum.stolen);
+
+        if (numWorkers == maxWorkers) { break; }
+    }
+    return consistent;
+}
+
+/*
+ * This function reads a code set file.
+ *
+ * Return: (bool): Code set read (false after printing an error)?
+ */
+static bool readCodeSet(const char *path, CodeSet *codeSet)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+    {
+        perror(path);
+        return false;
+    }
+
+    memset(codeSet, 0, sizeof(*codeSet));
+    char line[256];
+    for (unsigned lineNumber = 1; fgets(line, sizeof(line), file) != NULL;
+         lineNumber++)
+    {
+        char passcodeText[16];
+        unsigned long zones = ALL_ZONES_MASK;
+        unsigned long expiresS = NEVER_EXPIRES;
+        char extra;
+        int fields = sscanf(line, "%15s %li %lu %c", passcodeText, &zones,
+                            &expiresS, &extra);
+        if ((fields <= 0) || (passcodeText[0] == '#')) { continue; }
+
+        char *end;
+        unsigned long passcode = strtoul(passcodeText, &end, 10);
+        if ((fields > 3) || (strlen(passcodeText) != PASSCODE_LENGTH) ||
+            (*end != '\0') || (zones > ALL_ZONES_MASK) || (expiresS == 0) ||
+            (expiresS > NEVER_EXPIRES) || (passcode == MASTER_PASSCODE))
+        {
+            fprintf(stderr, "%s:%u: bad code line\n", path, lineNumber);
+            fclose(file);
+            return false;
+        }
+
+        codeSet->entries[passcode].zones = (uint32_t)zones;
+        codeSet->entries[passcode].expiresS = (uint32_t)expiresS;
+    }
+
+    fclose(file);
+    return true;
+}
+
+/*
+ * This function writes a random code set of GENERATED_CODES passcodes and a
+ * log of records attempts over GENERATED_LOG_SECONDS, three quarters of them
+ * with a stored passcode.
+ *
+ * Return: (bool): Files written?
+ */
+static bool generateLog(uint64_t records, const char *logPath,
+                        const char *codesPath)
+{
+    FILE *log = fopen(logPath, "w");
+    FILE *codes = fopen(codesPath, "w");
+    if ((log == NULL) || (codes == NULL))
+    {
+        perror((log == NULL) ? logPath : codesPath);
+        if (log != NULL) { fclose(log); }
+        if (codes != NULL) { fclose(codes); }
+        return false;
+    }
+
+    uint32_t random = 0x2545F491;
+    uint16_t stored[GENERATED_CODES];
+    fprintf(codes, "# passcode zones expires_s\n");
+    for (int i = 0; i < GENERATED_CODES; i++)
+    {
+        // Distinct, never the master passcode
+        bool duplicate;
+        do
+        {
+            stored[i] = (uint16_t)(1 + (nextRandom(&random) % (CODE_SPACE - 1)));
+            duplicate = false;
+            for (int j = 0; j < i; j++) { duplicate |= (stored[j] == stored[i]); }
+        } while (duplicate);
+
+        uint32_t zones = 1 + (nextRandom(&random) % ((1 << GENERATED_ZONES) - 1));
+        if ((nextRandom(&random) % 10) == 0)
+        {
+            fprintf(codes, "%04u 0x%x %u\n", stored[i], zones,
+                    nextRandom(&random) % GENERATED_LOG_SECONDS);
+        }
+        else
+        {
+            fprintf(codes, "%04u 0x%x\n", stored[i], zones);
+        }
+    }
+
+    for (uint64_t i = 0; i < records; i++)
+    {
+        uint32_t seconds = (uint32_t)((i * GENERATED_LOG_SECONDS) / records);
+        uint32_t zone = nextRandom(&random) % GENERATED_ZONES;
+        uint32_t passcode = ((nextRandom(&random) % 4) != 0)
+                            ? stored[nextRandom(&random) % GENERATED_CODES]
+                            : (nextRandom(&random) % CODE_SPACE);
+        fprintf(log, "%u %u %04u\n", seconds, zone, passcode);
+    }
+
+    bool written = !ferror(log) && !ferror(codes);
+    written &= (fclose(log) == 0);
+    written &= (fclose(codes) == 0);
+    return written;
+}
+
+int main(int argc, char *argv[])
+{
+    static Replay replay;
+    char *codeSetNames[MAX_CODE_SETS];
+    int numCodeSets = 0;
+    long numWorkers = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t shardKB = DEFAULT_SHARD_KB;
+    uint64_t generateRecords = 0;
+    bool benchmark = false;
+    bool verbose = false;
+
+    int option;
+    while ((option = getopt(argc, argv, "bc:g:s:t:v")) != -1)
+    {
+        switch (option)
+        {
+            case 'b': benchmark = true; break;
+            case 'c':
+                if (numCodeSets == MAX_CODE_SETS)
+                {
+                    fprintf(stderr, "%s: at most %d code sets\n", argv[0],
+                            MAX_CODE_SETS);
+                    return 1;
+                }
+                codeSetNames[numCodeSets++] = optarg;
+                break;
+            case 'g': generateRecords = strtoull(optarg, NULL, 10); break;
+            case 's': shardKB = (size_t)atol(optarg); break;
+            case 't': numWorkers = atol(optarg); break;
+            case 'v': verbose = true; break;
+            default:
+                fprintf(stderr, "usage: %s [-t threads] [-s shard KB] [-b] [-v] "
+                        "-c CODES [-c CODES]... LOG\n"
+                        "       %s -g records LOG CODES\n", argv[0], argv[0]);
+                return 1;
+        }
+    }
+
+    if (generateRecords > 0)
+    {
+        if ((argc - optind) != 2)
+        {
+            fprintf(stderr, "%s: -g needs LOG and CODES\n", argv[0]);
+            return 1;
+        }
+        return generateLog(generateRecords, argv[optind], argv[optind + 1]) ? 0 : 1;
+    }
+    if (((argc - optind) != 1) || (numCodeSets == 0) || (shardKB == 0) ||
+        (numWorkers < 1) || (numWorkers > MAX_WORKERS))
+    {
+        fprintf(stderr, "%s: need one LOG, at least one -c CODES and 1-%d "
+                "threads\n", argv[0], MAX_WORKERS);
+        return 1;
+    }
+
+    CodeSet *codeSets = malloc(numCodeSets * sizeof(CodeSet));
+    if (codeSets == NULL) { return 1; }
+    for (int set = 0; set < numCodeSets; set++)
+    {
+        if (!readCodeSet(codeSetNames[set], &codeSets[set])) { return 1; }
+    }
+
+    // Map the whole log, the workers read their shards straight from it
+    const char *logPath = argv[optind];
+    int fd = open(logPath, O_RDONLY);
+    struct stat logStatus;
+    if ((fd < 0) || (fstat(fd, &logStatus) != 0))
+    {
+        perror(logPath);
+        return 1;
+    }
+    size_t logBytes = (size_t)logStatus.st_size;
+    const char *log = "";
+    if (logBytes > 0)
+    {
+        log = mmap(NULL, logBytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (log == MAP_FAILED)
+        {
+            perror(logPath);
+            return 1;
+        }
+        madvise((void *)log, logBytes, MADV_SEQUENTIAL);
+    }
+    close(fd);
+
+    replay.codeSets = codeSets;
+    replay.numCodeSets = numCodeSets;
+    replay.shards = splitLog(log, logBytes, shardKB * 1024, &replay.numShards);
+    if (replay.shards == NULL) { return 1; }
+
+    int status = 0;
+    if (benchmark)
+    {
+        printf("%ld cpus, %.1f MB log, %u shards of %zu KB, %d code sets\n",
+               sysconf(_SC_NPROCESSORS_ONLN), logBytes / 1e6, replay.numShards,
+               shardKB, numCodeSets);
+        if (!benchmarkReplay(&replay, (int)numWorkers))
+        {
+            fprintf(stderr, "%s: verdicts differ between runs\n", argv[0]);
+            status = 1;
+        }
+    }
+    else
+    {
+        uint64_t wallNS = runReplay(&replay, (int)numWorkers);
+        printReplay(&replay, codeSetNames, wallNS, verbose);
+    }
+
+    if (logBytes > 0) { munmap((void *)log, logBytes); }
+    free(replay.shards);
+    free(codeSets);
+    return status;
+}
@@ -0,0 +1,448 @@
+/* -----------------------------------------------------------------------------
+ * Filename     : cosim.c
+ * Author(s)    : Kyle Bielby, Chris Lloyd (Team 1)
+ * Class        : EE365 (Final Project)
+ * Target Board : Cora Z7-10 (GHDL co-simulation)
+ * Description  : Host side of the GHDL co-simulation (see cosim_tb.vhd).
+ *
+ *                Security_System.c runs unmodified in its own thread. Every
+ *                Xil_In32/Xil_Out32 and delayMS it makes is handed to the
+ *                simulation through the VHPIDIRECT functions below and the
+ *                firmware thread blocks until the simulated AXI transaction
+ *                completes, so firmware and RTL advance in lockstep.
+ *                (Firmware computation between accesses takes zero
+ *                simulated time.) When the firmware goes idle it blocks until
+ *                the keypad or button interrupt line rises or its timeout
+ *                passes, like WFI on the target.
+ *
+ *                The selected scenario (COSIM_SCENARIO environment variable)
+ *                presses keys on the keypad matrix model and buttons. For
+ *                every key press the key-to-segment latency is reported in
+ *                clock ticks, split into:
+ *                <> scan     : press until the firmware reads the key
+ *                <> firmware : read until the display register write
+ *                <> display  : write until SEG_SELECT shows the digit
+ *                along with the AXI transaction counts per peripheral and
+ *                the fraction of time the firmware spent idle.
+ *
+ * -------------------------------------------------------------------------- */
+
+// Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+#include "xil_io.h"
+#include "xtime_l.h"
+#include "host_platform.h"
+
+// Simulated clock ticks per firmware millisecond (must match G_CYCLES_PER_MS)
+#ifndef COSIM_CYCLES_PER_MS
+#define COSIM_CYCLES_PER_MS 1000
+#endif
+
+// Peripheral address decoding (0x43c00000 + slave * 0x10000)
+#define PERIPHERAL_BASE_ADDR 0x43c00000
+#define SLAVE_ADDR_SHIFT     16
+#define NUM_SLAVES           4
+#define KEYPAD_SLAVE         0
+#define BUTTON_SLAVE         1
+#define SEVEN_SEGMENT_SLAVE  2
+#define LED_SLAVE            3
+
+// Request kinds (must match cosim_pkg.vhd)
+#define COSIM_REQ_NONE  0
+#define COSIM_REQ_READ  1
+#define COSIM_REQ_WRITE 2
+#define COSIM_REQ_DELAY 3
+#define COSIM_REQ_IDLE  4
+
+// Button masks (same as Security_System.c)
+#define MODE_BUTTON  1
+#define RESET_BUTTON 2
+
+#define NO_KEY      -1
+#define MAX_PRESSES 64
+
+// Firmware entry point (Security_System.c main, renamed by the Makefile)
+int securitySystemMain(void);
+
+/*******************************************************************************
+ * Scenarios
+ ******************************************************************************/
+
+// A change to the keys and buttons held, at a time in firmware milliseconds
+typedef struct
+{
+    int atMS;
+    int key;      // Keypad matrix position ((row - 1) * 4 + (col - 1))
+    int buttons;
+} ScenarioEvent;
+
+typedef struct
+{
+    const char *name;
+    const ScenarioEvent *events;
+    int numEvents;
+} Scenario;
+
+// Keypad matrix position of digits 0-9 (see keypad_driver.vhd)
+static const int DIGIT_KEYS[10] = {16, 4, 5, 6, 8, 9, 10, 12, 13, 14};
+
+#define KEY(ms, digit)  {(ms), DIGIT_KEYS[(digit)], 0}, {(ms) + 50, NO_KEY, 0}
+#define BUTTON(ms, btn) {(ms), NO_KEY, (btn)}, {(ms) + 50, NO_KEY, 0}
+
+// Enter an unknown code in MODE_1_CHECK_CODE
+static const ScenarioEvent CHECK_CODE_EVENTS[] = {
+    KEY(100, 1), KEY(1100, 2), KEY(2100, 3), KEY(3100, 4)
+};
+
+// Store a code in MODE_2_SET_CODE, then check it in MODE_1_CHECK_CODE
+static const ScenarioEvent SET_AND_CHECK_EVENTS[] = {
+    BUTTON(100, MODE_BUTTON),
+    KEY(1000, 5), KEY(2000, 6), KEY(3000, 7), KEY(4000, 8),
+    BUTTON(5500, MODE_BUTTON), BUTTON(6500, MODE_BUTTON),
+    KEY(7500, 5), KEY(8500, 6), KEY(9500, 7), KEY(10500, 8)
+};
+
+// Reset button press and release
+static const ScenarioEvent RESET_EVENTS[] = {
+    KEY(100, 9), BUTTON(1100, RESET_BUTTON), KEY(2500, 3)
+};
+
+#define SCENARIO(name, events) {(name), (events), sizeof(events) / sizeof((events)[0])}
+static const Scenario SCENARIOS[] = {
+    SCENARIO("check_code", CHECK_CODE_EVENTS),
+    SCENARIO("set_and_check", SET_AND_CHECK_EVENTS),
+    SCENARIO("reset", RESET_EVENTS)
+};
+#define NUM_SCENARIOS (sizeof(SCENARIOS) / sizeof(SCENARIOS[0]))
+
+/*******************************************************************************
+ * Co-simulation state
+ ******************************************************************************/
+
+// Firmware <-> simulation handoff
+static pthread_mutex_t requestLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t requestCond = PTHREAD_COND_INITIALIZER;
+static int requestKind = COSIM_REQ_NONE;
+static int requestSlave;
+static int requestOffset;
+static u32 requestData;
+static bool requestDone;
+
+// Scenario progress
+static const Scenario *scenario;
+static int nextEvent;
+
+// Latency of one key press (all in clock ticks, -1 until reached)
+typedef struct
+{
+    int key;
+    int pressCycle;
+    int readCycle;
+    int writeCycle;
+    int segmentCycle;
+    int digitSelect;
+    int segments;
+} KeyPress;
+
+static KeyPress presses[MAX_PRESSES];
+static int numPresses;
+static u32 displayData = 0xFFFF;
+static int lastCycle;
+
+// AXI transaction counts
+static unsigned long readCounts[NUM_SLAVES + 1];
+static unsigned long writeCounts[NUM_SLAVES + 1];
+static unsigned long delayCount;
+
+// Clock ticks spent in delayMS and waiting for input
+static long delayCycles;
+static long idleCycles;
+
+// Segment patterns of digits 0-9 (see seven_seg_driver.vhd)
+static const int DIGIT_SEGMENTS[10] = {
+    0x00, 0x06, 0x5B, 0x4F, 0x66, 0x6D, 0x7D, 0x07, 0x7F, 0x67
+};
+
+static const char *SLAVE_NAMES[NUM_SLAVES + 1] = {
+    "keypad", "button", "seven_segment", "led", "unmapped"
+};
+
+/*******************************************************************************
+ * Firmware side
+ ******************************************************************************/
+
+/*
+ * This function hands a request to the simulation and waits for it to
+ * complete.
+ *
+ * Return: (u32): Read data (0 for writes and delays).
+ */
+static u32 cosimRequest(int kind, UINTPTR addr, u32 data)
+{
+    int slave = (int)((addr - PERIPHERAL_BASE_ADDR) >> SLAVE_ADDR_SHIFT);
+    if ((addr < PERIPHERAL_BASE_ADDR) || (slave >= NUM_SLAVES))
+    {
+        slave = NUM_SLAVES;
+    }
+
+    pthread_mutex_lock(&requestLock);
+    requestSlave = slave;
+    requestOffset = (int)(addr & 0xF);
+    requestData = data;
+    requestDone = false;
+    requestKind = kind;
+    pthread_cond_broadcast(&requestCond);
+    while (!requestDone)
+    {
+        pthread_cond_wait(&requestCond, &requestLock);
+    }
+    data = requestData;
+    pthread_mutex_unlock(&requestLock);
+
+    return data;
+}
+
+u32 Xil_In32(UINTPTR Addr)
+{
+    return cosimRequest(COSIM_REQ_READ, Addr, 0);
+}
+
+void Xil_Out32(UINTPTR Addr, u32 Value)
+{
+    cosimRequest(COSIM_REQ_WRITE, Addr, Value);
+}
+
+void hostDelayMS(uint16_t ms)
+{
+    cosimRequest(COSIM_REQ_DELAY, 0, ms);
+}
+
+bool hostWaitForInput(uint32_t timeoutMS)
+{
+    return (cosimRequest(COSIM_REQ_IDLE, 0, timeoutMS) != 0);
+}
+
+void XTime_GetTime(XTime *Xtime_Global)
+{
+    // Time of the last completed request (the firmware itself takes no time)
+    *Xtime_Global = ((XTime)lastCycle * COUNTS_PER_SECOND) /
+                    (COSIM_CYCLES_PER_MS * 1000);
+}
+
+static void *firmwareThread(void *arg)
+{
+    (void)arg;
+    securitySystemMain();
+    return NULL;
+}
+
+/*******************************************************************************
+ * Simulation side (VHPIDIRECT, see cosim_pkg.vhd)
+ ******************************************************************************/
+
+void cosim_start(void)
+{
+    const char *name = getenv("COSIM_SCENARIO");
+    if (name == NULL) { name = SCENARIOS[0].name; }
+
+    for (unsigned i = 0; i < NUM_SCENARIOS; i++)
+    {
+        if (strcmp(name, SCENARIOS[i].name) == 0) { scenario = &SCENARIOS[i]; }
+    }
+    if (scenario == NULL)
+    {
+        fprintf(stderr, "cosim: unknown scenario '%s', available:", name);
+        for (unsigned i = 0; i < NUM_SCENARIOS; i++)
+        {
+            fprintf(stderr, " %s", SCENARIOS[i].name);
+        }
+        fprintf(stderr, "\n");
+        exit(1);
+    }
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, firmwareThread, NULL);
+    pthread_detach(thread);
+}
+
+int cosim_next_request(void)
+{
+    pthread_mutex_lock(&requestLock);
+    while (requestKind == COSIM_REQ_NONE)
+    {
+        pthread_cond_wait(&requestCond, &requestLock);
+    }
+    int kind = requestKind;
+    pthread_mutex_unlock(&requestLock);
+
+    return kind;
+}
+
+int cosim_request_slave(void)  { return requestSlave; }
+int cosim_request_offset(void) { return requestOffset; }
+int cosim_request_data(void)   { return (int)requestData; }
+
+/*
+ * This function tracks the latest key press through the firmware: the first
+ * keypad read returning its digit, then the display write showing it.
+ */
+static void trackKeyPress(int kind, int slave, int offset, u32 data, int cycle)
+{
+    if (numPresses == 0) { return; }
+    KeyPress *press = &presses[numPresses - 1];
+
+    if ((kind == COSIM_REQ_READ) && (slave == KEYPAD_SLAVE) && (offset == 0) &&
+        (press->readCycle < 0) && ((data & 0xF) != 0xF))
+    {
+        press->readCycle = cycle;
+    }
+    else if ((kind == COSIM_REQ_WRITE) && (slave == SEVEN_SEGMENT_SLAVE) &&
+             (press->readCycle >= 0) && (press->writeCycle < 0))
+    {
+        // Find the digit position that changed to the key's digit
+        for (int position = 0; position < 4; position++)
+        {
+            int digit = (data >> (position * 4)) & 0xF;
+            int previous = (displayData >> (position * 4)) & 0xF;
+            if ((digit != previous) && (digit < 10) &&
+                (DIGIT_KEYS[digit] == press->key))
+            {
+                press->writeCycle = cycle;
+                press->digitSelect = 1 << position;
+                press->segments = DIGIT_SEGMENTS[digit];
+            }
+        }
+    }
+}
+
+void cosim_complete(int data, int cycle)
+{
+    pthread_mutex_lock(&requestLock);
+    switch (requestKind)
+    {
+        case COSIM_REQ_READ:
+            readCounts[requestSlave]++;
+            requestData = (u32)data;
+            trackKeyPress(requestKind, requestSlave, requestOffset,
+                          requestData, cycle);
+            break;
+        case COSIM_REQ_WRITE:
+            writeCounts[requestSlave]++;
+            trackKeyPress(requestKind, requestSlave, requestOffset,
+                          requestData, cycle);
+            if (requestSlave == SEVEN_SEGMENT_SLAVE)
+            {
+                displayData = requestData & 0xFFFF;
+            }
+            requestData = 0;
+            break;
+        case COSIM_REQ_DELAY:
+            delayCount++;
+            delayCycles += cycle - lastCycle;
+            requestData = 0;
+            break;
+        default:
+            idleCycles += cycle - lastCycle;
+            requestData = (u32)data;
+            break;
+    }
+    lastCycle = cycle;
+    requestKind = COSIM_REQ_NONE;
+    requestDone = true;
+    pthread_cond_broadcast(&requestCond);
+    pthread_mutex_unlock(&requestLock);
+}
+
+int cosim_next_event(void)
+{
+    if (nextEvent >= scenario->numEvents) { return -1; }
+    return scenario->events[nextEvent].atMS * COSIM_CYCLES_PER_MS;
+}
+
+int cosim_event_key(void)     { return scenario->events[nextEvent].key; }
+int cosim_event_buttons(void) { return scenario->events[nextEvent].buttons; }
+
+void cosim_event_applied(int cycle)
+{
+    const ScenarioEvent *event = &scenario->events[nextEvent++];
+
+    if ((event->key != NO_KEY) && (numPresses < MAX_PRESSES))
+    {
+        KeyPress *press = &presses[numPresses++];
+        press->key = event->key;
+        press->pressCycle = cycle;
+        press->readCycle = -1;
+        press->writeCycle = -1;
+        press->segmentCycle = -1;
+    }
+}
+
+void cosim_display_sample(int cycle, int digit, int segments)
+{
+    for (int i = 0; i < numPresses; i++)
+    {
+        KeyPress *press = &presses[i];
+        if ((press->writeCycle >= 0) && (press->segmentCycle < 0) &&
+            (digit == press->digitSelect) && (segments == press->segments))
+        {
+            press->segmentCycle = cycle;
+        }
+    }
+}
+
+void cosim_report(int cycle)
+{
+    printf("\nscenario: %s (%d clock ticks, %d ticks per firmware ms)\n",
+           scenario->name, cycle, COSIM_CYCLES_PER_MS);
+
+    printf("\n%-4s %10s %10s %10s %10s\n",
+           "key", "scan", "firmware", "display", "total");
+    long totalLatency = 0;
+    int complete = 0;
+    for (int i = 0; i < numPresses; i++)
+    {
+        KeyPress *press = &presses[i];
+        printf("%-4d", press->key);
+        if (press->segmentCycle < 0)
+        {
+            printf(" %10s\n", "(not displayed)");
+            continue;
+        }
+        printf(" %10d %10d %10d %10d\n",
+               press->readCycle - press->pressCycle,
+               press->writeCycle - press->readCycle,
+               press->segmentCycle - press->writeCycle,
+               press->segmentCycle - press->pressCycle);
+        totalLatency += press->segmentCycle - press->pressCycle;
+        complete++;
+    }
+    if (complete > 0)
+    {
+        printf("mean key-to-segment latency: %ld clock ticks\n",
+               totalLatency / complete);
+    }
+
+    printf("\n%-14s %10s %10s\n", "peripheral", "reads", "writes");
+    unsigned long totalReads = 0, totalWrites = 0;
+    for (int i = 0; i <= NUM_SLAVES; i++)
+    {
+        printf("%-14s %10lu %10lu\n", SLAVE_NAMES[i], readCounts[i],
+               writeCounts[i]);
+        totalReads += readCounts[i];
+        totalWrites += writeCounts[i];
+    }
+    printf("%-14s %10lu %10lu\n", "total", totalReads, totalWrites);
+    printf("delayMS calls: %lu\n", delayCount);
+
+    if (cycle > 0)
+    {
+        printf("\nidle: %.1f%% (delayMS %.1f%%, waiting for input %.1f%%)\n",
+               100.0 * (delayCycles + idleCycles) / cycle,
+               100.0 * delayCycles / cycle, 100.0 * idleCycles / cycle);
+    }
+    fflush(stdout);
+}
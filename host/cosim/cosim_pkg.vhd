@@ -0,0 +1,145 @@
+--------------------------------------------------------------------------------
+-- Filename     : cosim_pkg.vhd
+-- Author(s)    : Kyle Bielby, Chris Lloyd (Team 1)
+-- Class        : EE365 (Final Project)
+-- Target Board : Cora Z7-10 (GHDL co-simulation)
+-- Entity       : cosim_pkg
+-- Description  : VHPIDIRECT bindings to cosim.c. The firmware runs in its own
+--                thread on the C side and hands each register access to the
+--                simulation, which performs it on the AXI slaves in lockstep.
+--------------------------------------------------------------------------------
+
+-----------------
+--  Libraries  --
+-----------------
+library ieee;
+  use ieee.std_logic_1164.all;
+
+---------------
+--  Package  --
+---------------
+package cosim_pkg is
+
+  -- Request kinds returned by cosim_next_request
+  constant COSIM_REQ_READ  : integer := 1;
+  constant COSIM_REQ_WRITE : integer := 2;
+  constant COSIM_REQ_DELAY : integer := 3;
+  constant COSIM_REQ_IDLE  : integer := 4;
+
+  -- Starts the firmware thread
+  procedure cosim_start;
+  attribute foreign of cosim_start : procedure is "VHPIDIRECT cosim_start";
+
+  -- Blocks until the firmware issues its next request and returns its kind.
+  -- The slave index, register offset and write data (or delay / idle timeout
+  -- in ms) of the request are then available from the functions below.
+  impure function cosim_next_request return integer;
+  attribute foreign of cosim_next_request : function is "VHPIDIRECT cosim_next_request";
+
+  impure function cosim_request_slave return integer;
+  attribute foreign of cosim_request_slave : function is "VHPIDIRECT cosim_request_slave";
+
+  impure function cosim_request_offset return integer;
+  attribute foreign of cosim_request_offset : function is "VHPIDIRECT cosim_request_offset";
+
+  impure function cosim_request_data return integer;
+  attribute foreign of cosim_request_data : function is "VHPIDIRECT cosim_request_data";
+
+  -- Completes the current request (read data is ignored for writes/delays)
+  procedure cosim_complete(data : integer; cycle : integer);
+  attribute foreign of cosim_complete : procedure is "VHPIDIRECT cosim_complete";
+
+  -- Scenario stimulus: cycle of the next event (-1 when the scenario is
+  -- finished), then the key (-1 for none) and buttons held from that event
+  impure function cosim_next_event return integer;
+  attribute foreign of cosim_next_event : function is "VHPIDIRECT cosim_next_event";
+
+  impure function cosim_event_key return integer;
+  attribute foreign of cosim_event_key : function is "VHPIDIRECT cosim_event_key";
+
+  impure function cosim_event_buttons return integer;
+  attribute foreign of cosim_event_buttons : function is "VHPIDIRECT cosim_event_buttons";
+
+  procedure cosim_event_applied(cycle : integer);
+  attribute foreign of cosim_event_applied : procedure is "VHPIDIRECT cosim_event_applied";
+
+  -- Display monitor (called whenever the digit select or segments change)
+  procedure cosim_display_sample(cycle : integer; digit : integer; segments : integer);
+  attribute foreign of cosim_display_sample : procedure is "VHPIDIRECT cosim_display_sample";
+
+  -- Prints the latency and AXI transaction report
+  procedure cosim_report(cycle : integer);
+  attribute foreign of cosim_report : procedure is "VHPIDIRECT cosim_report";
+
+end package cosim_pkg;
+
+package body cosim_pkg is
+
+  procedure cosim_start is
+  begin
+    assert false report "VHPIDIRECT cosim_start" severity failure;
+  end procedure;
+
+  impure function cosim_next_request return integer is
+  begin
+    assert false report "VHPIDIRECT cosim_next_request" severity failure;
+    return 0;
+  end function;
+
+  impure function cosim_request_slave return integer is
+  begin
+    assert false report "VHPIDIRECT cosim_request_slave" severity failure;
+    return 0;
+  end function;
+
+  impure function cosim_request_offset return integer is
+  begin
+    assert false report "VHPIDIRECT cosim_request_offset" severity failure;
+    return 0;
+  end function;
+
+  impure function cosim_request_data return integer is
+  begin
+    assert false report "VHPIDIRECT cosim_request_data" severity failure;
+    return 0;
+  end function;
+
+  procedure cosim_complete(data : integer; cycle : integer) is
+  begin
+    assert false report "VHPIDIRECT cosim_complete" severity failure;
+  end procedure;
+
+  impure function cosim_next_event return integer is
+  begin
+    assert false report "VHPIDIRECT cosim_next_event" severity failure;
+    return 0;
+  end function;
+
+  impure function cosim_event_key return integer is
+  begin
+    assert false report "VHPIDIRECT cosim_event_key" severity failure;
+    return 0;
+  end function;
+
+  impure function cosim_event_buttons return integer is
+  begin
+    assert false report "VHPIDIRECT cosim_event_buttons" severity failure;
+    return 0;
+  end function;
+
+  procedure cosim_event_applied(cycle : integer) is
+  begin
+    assert false report "VHPIDIRECT cosim_event_applied" severity failure;
+  end procedure;
+
+  procedure cosim_display_sample(cycle : integer; digit : integer; segments : integer) is
+  begin
+    assert false report "VHPIDIRECT cosim_display_sample" severity failure;
+  end procedure;
+
+  procedure cosim_report(cycle : integer) is
+  begin
+    assert false report "VHPIDIRECT cosim_report" severity failure;
+  end procedure;
+
+end package body cosim_pkg;
@@ -0,0 +1,384 @@
+--------------------------------------------------------------------------------
+-- Filename     : cosim_tb.vhd
+-- Author(s)    : Kyle Bielby, Chris Lloyd (Team 1)
+-- Class        : EE365 (Final Project)
+-- Target Board : Cora Z7-10 (GHDL co-simulation)
+-- Entity       : cosim_tb
+-- Description  : Co-simulation top level. Connects the keypad and seven
+--                segment drivers to their AXI slaves (plus the button and LED
+--                slaves) and performs the register accesses requested by
+--                Security_System.c running in cosim.c. A keypad matrix model
+--                applies the key presses of the selected scenario.
+--------------------------------------------------------------------------------
+
+-----------------
+--  Libraries  --
+-----------------
+library ieee;
+  use ieee.std_logic_1164.all;
+  use ieee.numeric_std.all;
+
+library work;
+  use work.cosim_pkg.all;
+
+--------------
+--  Entity  --
+--------------
+entity cosim_tb is
+generic
+(
+  -- Simulated clock ticks per firmware millisecond (delayMS). The real value
+  -- is 100000; the default compresses delays so scenarios finish quickly.
+  G_CYCLES_PER_MS  : integer := 1000;
+
+  -- Clock ticks to run after the last scenario event before reporting
+  G_DRAIN_CYCLES   : integer := 500000
+);
+end entity cosim_tb;
+
+--------------------------------
+--  Architecture Declaration  --
+--------------------------------
+architecture behavioral of cosim_tb is
+
+  -------------
+  -- CONSTANTS --
+  -------------
+  constant CLK_PERIOD   : time    := 10 ns;  -- 100 MHz
+  constant NUM_SLAVES   : integer := 4;
+
+  -- Slave indices (address bits 19:16 above 0x43c00000)
+  constant KEYPAD_SLAVE        : integer := 0;
+  constant BUTTON_SLAVE        : integer := 1;
+  constant SEVEN_SEGMENT_SLAVE : integer := 2;
+  constant LED_SLAVE           : integer := 3;
+
+  -------------
+  -- SIGNALS --
+  -------------
+  type t_DATA_ARRAY is array (0 to NUM_SLAVES-1) of std_logic_vector(31 downto 0);
+  type t_RESP_ARRAY is array (0 to NUM_SLAVES-1) of std_logic_vector(1 downto 0);
+
+  signal s_clk          : std_logic := '0';
+  signal s_rst          : std_logic := '1';
+  signal s_aresetn      : std_logic := '0';
+  signal s_cycles       : integer   := 0;
+  signal s_done         : boolean   := false;
+
+  -- Shared AXI4 Lite master signals
+  signal s_awaddr       : std_logic_vector(3 downto 0)  := (others => '0');
+  signal s_wdata        : std_logic_vector(31 downto 0) := (others => '0');
+  signal s_araddr       : std_logic_vector(3 downto 0)  := (others => '0');
+  signal s_bready       : std_logic := '0';
+  signal s_rready       : std_logic := '0';
+
+  -- Per slave AXI4 Lite signals
+  signal s_awvalid      : std_logic_vector(NUM_SLAVES-1 downto 0) := (others => '0');
+  signal s_wvalid       : std_logic_vector(NUM_SLAVES-1 downto 0) := (others => '0');
+  signal s_arvalid      : std_logic_vector(NUM_SLAVES-1 downto 0) := (others => '0');
+  signal s_awready      : std_logic_vector(NUM_SLAVES-1 downto 0);
+  signal s_wready       : std_logic_vector(NUM_SLAVES-1 downto 0);
+  signal s_bvalid       : std_logic_vector(NUM_SLAVES-1 downto 0);
+  signal s_arready      : std_logic_vector(NUM_SLAVES-1 downto 0);
+  signal s_rvalid       : std_logic_vector(NUM_SLAVES-1 downto 0);
+  signal s_rdata        : t_DATA_ARRAY;
+  signal s_bresp        : t_RESP_ARRAY;
+  signal s_rresp        : t_RESP_ARRAY;
+
+  -- Keypad matrix
+  signal s_pressed_key  : integer range -1 to 19 := -1;
+  signal s_keypad_rows  : std_logic_vector(4 downto 0);
+  signal s_keypad_cols  : std_logic_vector(3 downto 0);
+  signal s_keypad_binary    : std_logic_vector(3 downto 0);
+  signal s_keypad_key_state : std_logic_vector(19 downto 0);
+  signal s_keypad_h_key     : std_logic;
+  signal s_keypad_l_key     : std_logic;
+  signal s_keypad_scan_div  : std_logic_vector(6 downto 0);
+  signal s_keypad_irq       : std_logic;
+
+  -- Buttons, LEDs and display
+  signal s_buttons      : std_logic_vector(1 downto 0) := (others => '0');
+  signal s_button_irq   : std_logic;
+  signal s_leds         : std_logic_vector(5 downto 0);
+  signal s_display_data : std_logic_vector(15 downto 0);
+  signal s_gnd_ctrl     : std_logic_vector(3 downto 0);
+  signal s_seg_select   : std_logic_vector(6 downto 0);
+
+begin
+
+  s_clk     <= not s_clk after CLK_PERIOD / 2 when not s_done else '0';
+  s_cycles  <= s_cycles + 1 when rising_edge(s_clk);
+  s_rst     <= '0' after 16 * CLK_PERIOD;
+  s_aresetn <= not s_rst;
+
+  ------------------------------------------------------------------------------
+  -- Keypad matrix model: the pressed key connects its column to its row
+  ------------------------------------------------------------------------------
+  KEYPAD_MATRIX: for row in 0 to 4 generate
+    s_keypad_rows(row) <= s_keypad_cols(s_pressed_key mod 4)
+                          when (s_pressed_key >= 0 and s_pressed_key / 4 = row)
+                          else '0';
+  end generate KEYPAD_MATRIX;
+
+  KEYPAD_DRIVER: entity work.hex_keypad_driver
+  port map (
+    I_CLK_50MHZ         => s_clk,
+    I_SYSTEM_RST        => s_rst,
+    I_SCAN_DIVIDER      => s_keypad_scan_div,
+    I_KEYPAD_ROW_1      => s_keypad_rows(0),
+    I_KEYPAD_ROW_2      => s_keypad_rows(1),
+    I_KEYPAD_ROW_3      => s_keypad_rows(2),
+    I_KEYPAD_ROW_4      => s_keypad_rows(3),
+    I_KEYPAD_ROW_5      => s_keypad_rows(4),
+    O_KEYPAD_COL_1      => s_keypad_cols(0),
+    O_KEYPAD_COL_2      => s_keypad_cols(1),
+    O_KEYPAD_COL_3      => s_keypad_cols(2),
+    O_KEYPAD_COL_4      => s_keypad_cols(3),
+    H_KEY_OUT           => s_keypad_h_key,
+    L_KEY_OUT           => s_keypad_l_key,
+    O_KEYPAD_BINARY     => s_keypad_binary,
+    O_KEYPAD_RGB_BINARY => open,
+    O_KEYPAD_KEY_STATE  => s_keypad_key_state
+  );
+
+  SEVEN_SEGMENT_DRIVER: entity work.seven_seg_driver
+  port map (
+    I_CLK_100MHZ    => s_clk,
+    DIGIT_VALUES_IN => s_display_data,
+    GND_CTRL_VEC    => s_gnd_ctrl,
+    SEG_SELECT      => s_seg_select
+  );
+
+  ------------------------------------------------------------------------------
+  -- AXI slaves
+  ------------------------------------------------------------------------------
+  KEYPAD_SLAVE_INST: entity work.keypad_binary_slave_v1_0
+  port map (
+    s_keypad_binary       => s_keypad_binary,
+    s_keypad_key_state    => s_keypad_key_state,
+    s_keypad_h_key        => s_keypad_h_key,
+    s_keypad_l_key        => s_keypad_l_key,
+    s_keypad_scan_divider => s_keypad_scan_div,
+    keypad_irq            => s_keypad_irq,
+    s00_axi_aclk    => s_clk,
+    s00_axi_aresetn => s_aresetn,
+    s00_axi_awaddr  => s_awaddr,
+    s00_axi_awprot  => "000",
+    s00_axi_awvalid => s_awvalid(KEYPAD_SLAVE),
+    s00_axi_awready => s_awready(KEYPAD_SLAVE),
+    s00_axi_wdata   => s_wdata,
+    s00_axi_wstrb   => "1111",
+    s00_axi_wvalid  => s_wvalid(KEYPAD_SLAVE),
+    s00_axi_wready  => s_wready(KEYPAD_SLAVE),
+    s00_axi_bresp   => s_bresp(KEYPAD_SLAVE),
+    s00_axi_bvalid  => s_bvalid(KEYPAD_SLAVE),
+    s00_axi_bready  => s_bready,
+    s00_axi_araddr  => s_araddr,
+    s00_axi_arprot  => "000",
+    s00_axi_arvalid => s_arvalid(KEYPAD_SLAVE),
+    s00_axi_arready => s_arready(KEYPAD_SLAVE),
+    s00_axi_rdata   => s_rdata(KEYPAD_SLAVE),
+    s00_axi_rresp   => s_rresp(KEYPAD_SLAVE),
+    s00_axi_rvalid  => s_rvalid(KEYPAD_SLAVE),
+    s00_axi_rready  => s_rready
+  );
+
+  BUTTON_SLAVE_INST: entity work.axilab_slave_button_v1_0
+  port map (
+    button          => s_buttons,
+    button_irq      => s_button_irq,
+    s00_axi_aclk    => s_clk,
+    s00_axi_aresetn => s_aresetn,
+    s00_axi_awaddr  => s_awaddr,
+    s00_axi_awprot  => "000",
+    s00_axi_awvalid => s_awvalid(BUTTON_SLAVE),
+    s00_axi_awready => s_awready(BUTTON_SLAVE),
+    s00_axi_wdata   => s_wdata,
+    s00_axi_wstrb   => "1111",
+    s00_axi_wvalid  => s_wvalid(BUTTON_SLAVE),
+    s00_axi_wready  => s_wready(BUTTON_SLAVE),
+    s00_axi_bresp   => s_bresp(BUTTON_SLAVE),
+    s00_axi_bvalid  => s_bvalid(BUTTON_SLAVE),
+    s00_axi_bready  => s_bready,
+    s00_axi_araddr  => s_araddr,
+    s00_axi_arprot  => "000",
+    s00_axi_arvalid => s_arvalid(BUTTON_SLAVE),
+    s00_axi_arready => s_arready(BUTTON_SLAVE),
+    s00_axi_rdata   => s_rdata(BUTTON_SLAVE),
+    s00_axi_rresp   => s_rresp(BUTTON_SLAVE),
+    s00_axi_rvalid  => s_rvalid(BUTTON_SLAVE),
+    s00_axi_rready  => s_rready
+  );
+
+  SEVEN_SEGMENT_SLAVE_INST: entity work.seven_segment_display_slave_v1_0
+  port map (
+    display_data    => s_display_data,
+    s00_axi_aclk    => s_clk,
+    s00_axi_aresetn => s_aresetn,
+    s00_axi_awaddr  => s_awaddr,
+    s00_axi_awprot  => "000",
+    s00_axi_awvalid => s_awvalid(SEVEN_SEGMENT_SLAVE),
+    s00_axi_awready => s_awready(SEVEN_SEGMENT_SLAVE),
+    s00_axi_wdata   => s_wdata,
+    s00_axi_wstrb   => "1111",
+    s00_axi_wvalid  => s_wvalid(SEVEN_SEGMENT_SLAVE),
+    s00_axi_wready  => s_wready(SEVEN_SEGMENT_SLAVE),
+    s00_axi_bresp   => s_bresp(SEVEN_SEGMENT_SLAVE),
+    s00_axi_bvalid  => s_bvalid(SEVEN_SEGMENT_SLAVE),
+    s00_axi_bready  => s_bready,
+    s00_axi_araddr  => s_araddr,
+    s00_axi_arprot  => "000",
+    s00_axi_arvalid => s_arvalid(SEVEN_SEGMENT_SLAVE),
+    s00_axi_arready => s_arready(SEVEN_SEGMENT_SLAVE),
+    s00_axi_rdata   => s_rdata(SEVEN_SEGMENT_SLAVE),
+    s00_axi_rresp   => s_rresp(SEVEN_SEGMENT_SLAVE),
+    s00_axi_rvalid  => s_rvalid(SEVEN_SEGMENT_SLAVE),
+    s00_axi_rready  => s_rready
+  );
+
+  LED_SLAVE_INST: entity work.axilab_slave_led_v1_0
+  port map (
+    led             => s_leds,
+    s00_axi_aclk    => s_clk,
+    s00_axi_aresetn => s_aresetn,
+    s00_axi_awaddr  => s_awaddr,
+    s00_axi_awprot  => "000",
+    s00_axi_awvalid => s_awvalid(LED_SLAVE),
+    s00_axi_awready => s_awready(LED_SLAVE),
+    s00_axi_wdata   => s_wdata,
+    s00_axi_wstrb   => "1111",
+    s00_axi_wvalid  => s_wvalid(LED_SLAVE),
+    s00_axi_wready  => s_wready(LED_SLAVE),
+    s00_axi_bresp   => s_bresp(LED_SLAVE),
+    s00_axi_bvalid  => s_bvalid(LED_SLAVE),
+    s00_axi_bready  => s_bready,
+    s00_axi_araddr  => s_araddr,
+    s00_axi_arprot  => "000",
+    s00_axi_arvalid => s_arvalid(LED_SLAVE),
+    s00_axi_arready => s_arready(LED_SLAVE),
+    s00_axi_rdata   => s_rdata(LED_SLAVE),
+    s00_axi_rresp   => s_rresp(LED_SLAVE),
+    s00_axi_rvalid  => s_rvalid(LED_SLAVE),
+    s00_axi_rready  => s_rready
+  );
+
+  ------------------------------------------------------------------------------
+  -- Process Name     : AXI_MASTER
+  -- Description      : Performs each register access requested by the
+  --                    firmware thread and hands the result back to it.
+  --                    Delay requests wait G_CYCLES_PER_MS ticks per ms.
+  --                    Idle requests wait for a keypad or button interrupt
+  --                    or the timeout (ms, 0 for none) and return 1 if an
+  --                    interrupt woke the firmware.
+  ------------------------------------------------------------------------------
+  AXI_MASTER: process
+    variable v_kind   : integer;
+    variable v_slave  : integer;
+    variable v_offset : integer;
+    variable v_data   : integer;
+    variable v_wake   : integer;
+  begin
+    wait until rising_edge(s_clk) and s_aresetn = '1';
+    cosim_start;
+
+    while not s_done loop
+      v_kind   := cosim_next_request;
+      v_slave  := cosim_request_slave;
+      v_offset := cosim_request_offset;
+      v_data   := cosim_request_data;
+
+      if (v_kind = COSIM_REQ_WRITE and v_slave < NUM_SLAVES) then
+        s_awaddr           <= std_logic_vector(to_unsigned(v_offset, 4));
+        s_wdata            <= std_logic_vector(to_signed(v_data, 32));
+        s_awvalid(v_slave) <= '1';
+        s_wvalid(v_slave)  <= '1';
+        s_bready           <= '1';
+        wait until rising_edge(s_clk) and s_awready(v_slave) = '1' and
+                   s_wready(v_slave) = '1';
+        s_awvalid(v_slave) <= '0';
+        s_wvalid(v_slave)  <= '0';
+        wait until rising_edge(s_clk) and s_bvalid(v_slave) = '1';
+        s_bready           <= '0';
+        cosim_complete(0, s_cycles);
+
+      elsif (v_kind = COSIM_REQ_READ and v_slave < NUM_SLAVES) then
+        s_araddr           <= std_logic_vector(to_unsigned(v_offset, 4));
+        s_arvalid(v_slave) <= '1';
+        s_rready           <= '1';
+        wait until rising_edge(s_clk) and s_arready(v_slave) = '1';
+        s_arvalid(v_slave) <= '0';
+        wait until rising_edge(s_clk) and s_rvalid(v_slave) = '1';
+        s_rready           <= '0';
+        cosim_complete(to_integer(signed(s_rdata(v_slave))), s_cycles);
+
+      elsif (v_kind = COSIM_REQ_DELAY) then
+        for i in 1 to v_data * G_CYCLES_PER_MS loop
+          wait until rising_edge(s_clk);
+        end loop;
+        cosim_complete(0, s_cycles);
+
+      elsif (v_kind = COSIM_REQ_IDLE) then
+        v_wake := s_cycles + v_data * G_CYCLES_PER_MS;
+        while (s_keypad_irq /= '1' and s_button_irq /= '1' and not s_done and
+               (v_data = 0 or s_cycles < v_wake)) loop
+          wait until rising_edge(s_clk) or s_done;
+        end loop;
+        if (s_keypad_irq = '1' or s_button_irq = '1') then
+          cosim_complete(1, s_cycles);
+        else
+          cosim_complete(0, s_cycles);
+        end if;
+
+      else
+        -- Unmapped peripheral, reads return 0
+        wait until rising_edge(s_clk);
+        cosim_complete(0, s_cycles);
+      end if;
+    end loop;
+    wait;
+  end process AXI_MASTER;
+
+  ------------------------------------------------------------------------------
+  -- Process Name     : STIMULUS
+  -- Description      : Applies the key presses and button presses of the
+  --                    scenario at their scheduled clock ticks, then lets the
+  --                    design drain before reporting.
+  ------------------------------------------------------------------------------
+  STIMULUS: process
+    variable v_event_cycle : integer;
+  begin
+    wait until s_aresetn = '1';
+    loop
+      v_event_cycle := cosim_next_event;
+      exit when v_event_cycle < 0;
+      while s_cycles < v_event_cycle loop
+        wait until rising_edge(s_clk);
+      end loop;
+      s_pressed_key <= cosim_event_key;
+      s_buttons     <= std_logic_vector(to_unsigned(cosim_event_buttons, 2));
+      cosim_event_applied(s_cycles);
+    end loop;
+
+    for i in 1 to G_DRAIN_CYCLES loop
+      wait until rising_edge(s_clk);
+    end loop;
+    cosim_report(s_cycles);
+    s_done <= true;
+    wait;
+  end process STIMULUS;
+
+  ------------------------------------------------------------------------------
+  -- Process Name     : DISPLAY_MONITOR
+  -- Description      : Reports every change on the display pins so cosim.c
+  --                    can time when an entered digit lights up.
+  ------------------------------------------------------------------------------
+  DISPLAY_MONITOR: process (s_gnd_ctrl, s_seg_select)
+  begin
+    if (s_aresetn = '1' and not is_x(s_gnd_ctrl) and not is_x(s_seg_select)) then
+      cosim_display_sample(s_cycles,
+                           to_integer(unsigned(s_gnd_ctrl)),
+                           to_integer(unsigned(s_seg_select)));
+    end if;
+  end process DISPLAY_MONITOR;
+
+end architecture behavioral;
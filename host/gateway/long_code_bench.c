@@ -0,0 +1,244 @@
+/* -----------------------------------------------------------------------------
+ * Filename     : long_code_bench.c
+ * Author(s)    : Kyle Bielby, Chris Lloyd (Team 1)
+ * Class        : EE365 (Final Project)
+ * Target Board : Cora Z7-10 (host tools)
+ * Description  : Measures the memory and lookup times of the long code store
+ *                (long_code_store.h) holding 10k, 100k and 1M random 8 digit
+ *                codes, against a bitset of every 8 digit code and a linear
+ *                scan like isExistingPasscode() in Security_System.c.
+ *
+ *                  long_code_bench [-l lookups] [-n codes]...
+ * -------------------------------------------------------------------------- */
+
+// Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include <unistd.h>
+#include "long_code_store.h"
+
+#define CODE_DIGITS      8
+#define CODE_SPACE       100000000UL  // 10^CODE_DIGITS
+#define DEFAULT_LOOKUPS  1000000
+#define SCAN_LOOKUPS     1000
+#define MAX_STORE_SIZES  8
+
+static const uint32_t DEFAULT_STORE_SIZES[] = {10000, 100000, 1000000};
+
+static uint64_t randomState = 0x9E3779B97F4A7C15ULL;
+
+/*
+ * This function gets a monotonic time in nanoseconds.
+ *
+ * Return: (uint64_t): Nanoseconds.
+ */
+static uint64_t getTimeNS()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000000ULL) + now.tv_nsec;
+}
+
+/*
+ * This function steps a xorshift64 generator.
+ *
+ * Return: (uint64_t): Next pseudo random number.
+ */
+static uint64_t nextRandom()
+{
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 7;
+    randomState ^= randomState << 17;
+    return randomState;
+}
+
+/*
+ * This function makes a random 8 digit code.
+ *
+ * Return: (LongCode): Packed code.
+ */
+static LongCode randomCode()
+{
+    uint64_t number = nextRandom() % CODE_SPACE;
+    uint8_t digits[CODE_DIGITS];
+    for (int digit = CODE_DIGITS - 1; digit >= 0; digit--)
+    {
+        digits[digit] = number % 10;
+        number /= 10;
+    }
+
+    LongCode code;
+    packLongCode(digits, CODE_DIGITS, &code);
+    return code;
+}
+
+/*
+ * This function times lookups of every code with one of the lookup functions.
+ *
+ * Return: (double): Nanoseconds per lookup.
+ */
+static double timeLookups(const LongCodeStore *store, const LongCode codes[],
+                          uint32_t numCodes,
+                          bool (*lookup)(const LongCodeStore *, LongCode),
+                          uint32_t *found)
+{
+    uint32_t matches = 0;
+    uint64_t start = getTimeNS();
+    for (uint32_t i = 0; i < numCodes; i++)
+    {
+        matches += lookup(store, codes[i]);
+    }
+    uint64_t end = getTimeNS();
+
+    if (found != NULL) { *found = matches; }
+    return (double)(end - start) / numCodes;
+}
+
+/*
+ * This function times linear scans for absent codes.
+ *
+ * Return: (double): Nanoseconds per lookup.
+ */
+static double timeLinearScans(const LongCode stored[], uint32_t numStored,
+                              const LongCode codes[], uint32_t numCodes)
+{
+    volatile uint32_t matches = 0;
+    uint64_t start = getTimeNS();
+    for (uint32_t i = 0; i < numCodes; i++)
+    {
+        for (uint32_t j = 0; j < numStored; j++)
+        {
+            if (stored[j] == codes[i])
+            {
+                matches++;
+                break;
+            }
+        }
+    }
+    uint64_t end = getTimeNS();
+    return (double)(end - start) / numCodes;
+}
+
+/*
+ * This function fills a store with numCodes random codes and prints its
+ * memory use and lookup times.
+ *
+ * Return: (bool): Benchmark run (false if out of memory)?
+ */
+static bool runBenchmark(uint32_t numCodes, uint32_t numLookups)
+{
+    LongCodeStore store;
+    LongCode *stored = malloc(numCodes * sizeof(LongCode));
+    LongCode *hits = malloc(numLookups * sizeof(LongCode));
+    LongCode *misses = malloc(numLookups * sizeof(LongCode));
+    if ((stored == NULL) || (hits == NULL) || (misses == NULL) ||
+        !initLongCodeStore(&store, numCodes))
+    {
+        free(stored);
+        free(hits);
+        free(misses);
+        return false;
+    }
+
+    uint64_t start = getTimeNS();
+    for (uint32_t added = 0; added < numCodes;)
+    {
+        LongCode code = randomCode();
+        if (addLongCode(&store, code)) { stored[added++] = code; }
+    }
+    double addNS = (double)(getTimeNS() - start) / numCodes;
+
+    // Stored codes in random order, and codes that are not stored
+    for (uint32_t i = 0; i < numLookups; i++)
+    {
+        hits[i] = stored[nextRandom() % numCodes];
+        do { misses[i] = randomCode(); } while (isTableLongCode(&store, misses[i]));
+    }
+
+    uint32_t found;
+    uint32_t passed;
+    double hitNS = timeLookups(&store, hits, numLookups, isStoredLongCode, &found);
+    double missNS = timeLookups(&store, misses, numLookups, isStoredLongCode, NULL);
+    double tableMissNS = timeLookups(&store, misses, numLookups, isTableLongCode,
+                                     NULL);
+    timeLookups(&store, misses, numLookups, mayBeStoredLongCode, &passed);
+    uint32_t numScans = (numLookups < SCAN_LOOKUPS) ? numLookups : SCAN_LOOKUPS;
+    double scanNS = timeLinearScans(stored, numCodes, misses, numScans);
+
+    size_t bytes = getLongCodeStoreBytes(&store);
+    printf("%8u %9.2f %7.1f %6.1f %6.1f %9.1f %10.1f %8.2f%% %11.0f\n",
+           numCodes, bytes / 1e6, (double)bytes / numCodes, addNS, hitNS,
+           missNS, tableMissNS, (100.0 * (numLookups - passed)) / numLookups,
+           scanNS);
+    if (found != numLookups)
+    {
+        printf("error: %u of %u stored codes not found\n",
+               numLookups - found, numLookups);
+    }
+
+    freeLongCodeStore(&store);
+    free(stored);
+    free(hits);
+    free(misses);
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t numLookups = DEFAULT_LOOKUPS;
+    uint32_t storeSizes[MAX_STORE_SIZES];
+    int numStoreSizes = 0;
+
+    int option;
+    while ((option = getopt(argc, argv, "l:n:")) != -1)
+    {
+        switch (option)
+        {
+            case 'l':
+                numLookups = (uint32_t)atol(optarg);
+                break;
+            case 'n':
+                if (numStoreSizes < MAX_STORE_SIZES)
+                {
+                    storeSizes[numStoreSizes++] = (uint32_t)atol(optarg);
+                }
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-l lookups] [-n codes]...\n", argv[0]);
+                return 1;
+        }
+    }
+    if (numStoreSizes == 0)
+    {
+        for (size_t i = 0; i < (sizeof(DEFAULT_STORE_SIZES) /
+                                sizeof(DEFAULT_STORE_SIZES[0])); i++)
+        {
+            storeSizes[numStoreSizes++] = DEFAULT_STORE_SIZES[i];
+        }
+    }
+    if (numLookups == 0)
+    {
+        fprintf(stderr, "%s: need at least one lookup\n", argv[0]);
+        return 1;
+    }
+
+    printf("%d digit codes, %u lookups per column (bitset of all codes: "
+           "%.1f MB)\n", CODE_DIGITS, numLookups, (CODE_SPACE / 8) / 1e6);
+    printf("%8s %9s %7s %6s %6s %9s %10s %9s %11s\n", "codes", "MB",
+           "B/code", "add", "hit", "miss", "miss (no", "filter", "scan miss");
+    printf("%8s %9s %7s %6s %6s %9s %10s %9s %11s\n", "", "", "", "ns", "ns",
+           "ns", "filter) ns", "rejects", "ns");
+    for (int i = 0; i < numStoreSizes; i++)
+    {
+        if ((storeSizes[i] == 0) || !runBenchmark(storeSizes[i], numLookups))
+        {
+            fprintf(stderr, "%s: cannot store %u codes\n", argv[0], storeSizes[i]);
+            return 1;
+        }
+    }
+
+    return 0;
+}
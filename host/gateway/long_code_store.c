@@ -0,0 +1,282 @@
+/* -----------------------------------------------------------------------------
+ * Filename     : long_code_store.c
+ * Author(s)    : Kyle Bielby, Chris Lloyd (Team 1)
+ * Class        : EE365 (Final Project)
+ * Target Board : Cora Z7-10 (host tools)
+ * Description  : Open addressing hash table of long codes with a blocked
+ *                Bloom filter prefilter (see long_code_store.h).
+ * -------------------------------------------------------------------------- */
+
+// Includes
+#include <stdlib.h>
+#include <string.h>
+#include "long_code_store.h"
+
+#define BLOOM_BLOCK_BITS (LONG_CODE_CACHE_LINE_BYTES * 8)
+#define BLOOM_BIT_MASK   (BLOOM_BLOCK_BITS - 1)
+#define BLOOM_BIT_SHIFT  9  // log2(BLOOM_BLOCK_BITS)
+#define BLOOM_BLOCK_SHIFT 40 // Hash bits above the probes pick the block
+
+/*
+ * This function mixes a code into a well spread 64-bit hash (the MurmurHash3
+ * finalizer). Packed codes differ only in their digit nibbles, so they need
+ * mixing before the low bits can pick a bucket.
+ *
+ * Return: (uint64_t): Hash of code.
+ */
+static uint64_t hashLongCode(LongCode code)
+{
+    code ^= code >> 33;
+    code *= 0xFF51AFD7ED558CCDULL;
+    code ^= code >> 33;
+    code *= 0xC4CEB9FE1A85EC53ULL;
+    code ^= code >> 33;
+    return code;
+}
+
+/*
+ * This function rounds up to a power of two.
+ *
+ * Return: (uint32_t): Smallest power of two not below value.
+ */
+static uint32_t roundUpPowerOfTwo(uint32_t value)
+{
+    uint32_t power = 1;
+    while (power < value) { power <<= 1; }
+    return power;
+}
+
+/*
+ * This function gets the Bloom filter block of a hash, picked by the hash
+ * bits above the ones the probes use.
+ *
+ * Return: (LongCodeBloomBlock *): The block.
+ */
+static LongCodeBloomBlock *getBloomBlock(const LongCodeStore *store,
+                                         uint64_t hash)
+{
+    return &store->bloom[(hash >> BLOOM_BLOCK_SHIFT) & store->bloomBlockMask];
+}
+
+/*
+ * This function tests the Bloom filter bits of a hash. They all lie in one
+ * block, so a test reads a single cache line.
+ *
+ * Return: (bool): All bits set (the code may be stored)?
+ */
+static bool testBloomBits(const LongCodeStore *store, uint64_t hash)
+{
+    const LongCodeBloomBlock *block = getBloomBlock(store, hash);
+
+    // Each probe takes the next 9 bits of the hash, from bit 0 up
+    for (int probe = 0; probe < LONG_CODE_BLOOM_PROBES; probe++)
+    {
+        uint32_t bit = (hash >> (probe * BLOOM_BIT_SHIFT)) & BLOOM_BIT_MASK;
+        if (!(block->words[bit / 64] & (1ULL << (bit % 64)))) { return false; }
+    }
+    return true;
+}
+
+/*
+ * This function sets the Bloom filter bits of a hash.
+ *
+ * Return: None (void)
+ */
+static void setBloomBits(LongCodeStore *store, uint64_t hash)
+{
+    LongCodeBloomBlock *block = getBloomBlock(store, hash);
+
+    // Same bits as testBloomBits
+    for (int probe = 0; probe < LONG_CODE_BLOOM_PROBES; probe++)
+    {
+        uint32_t bit = (hash >> (probe * BLOOM_BIT_SHIFT)) & BLOOM_BIT_MASK;
+        block->words[bit / 64] |= (1ULL << (bit % 64));
+    }
+}
+
+/*
+ * This function finds the slot holding code.
+ *
+ * Return: (LongCode *): The slot (NULL if code is not stored).
+ */
+static LongCode *findSlot(const LongCodeStore *store, LongCode code,
+                          uint64_t hash)
+{
+    uint32_t bucket = (uint32_t)hash & store->bucketMask;
+    while (true)
+    {
+        LongCodeBucket *slots = &store->buckets[bucket];
+        for (unsigned slot = 0; slot < LONG_CODE_BUCKET_SLOTS; slot++)
+        {
+            if (slots->slots[slot] == code) { return &slots->slots[slot]; }
+            if (slots->slots[slot] == LONG_CODE_EMPTY) { return NULL; }
+        }
+        bucket = (bucket + 1) & store->bucketMask;
+    }
+}
+
+/*
+ * This function puts a code that is not stored into the first free slot of
+ * its probe sequence.
+ *
+ * Return: None (void)
+ */
+static void insertSlot(LongCodeStore *store, LongCode code, uint64_t hash)
+{
+    uint32_t bucket = (uint32_t)hash & store->bucketMask;
+    while (true)
+    {
+        LongCodeBucket *slots = &store->buckets[bucket];
+        for (unsigned slot = 0; slot < LONG_CODE_BUCKET_SLOTS; slot++)
+        {
+            if (slots->slots[slot] == LONG_CODE_EMPTY)
+            {
+                slots->slots[slot] = code;
+                return;
+            }
+            if (slots->slots[slot] == LONG_CODE_DELETED)
+            {
+                slots->slots[slot] = code;
+                store->deleted--;
+                return;
+            }
+        }
+        bucket = (bucket + 1) & store->bucketMask;
+    }
+}
+
+/*
+ * This function rebuilds the table and the filter from the stored codes,
+ * dropping deleted slots and their filter bits.
+ *
+ * Return: (bool): Rebuilt (false if out of memory, the store is unchanged)?
+ */
+static bool rebuildLongCodeStore(LongCodeStore *store)
+{
+    LongCodeStore rebuilt;
+    if (!initLongCodeStore(&rebuilt, store->capacity)) { return false; }
+
+    for (uint32_t bucket = 0; bucket <= store->bucketMask; bucket++)
+    {
+        for (unsigned slot = 0; slot < LONG_CODE_BUCKET_SLOTS; slot++)
+        {
+            LongCode code = store->buckets[bucket].slots[slot];
+            if ((code != LONG_CODE_EMPTY) && (code != LONG_CODE_DELETED))
+            {
+                addLongCode(&rebuilt, code);
+            }
+        }
+    }
+
+    freeLongCodeStore(store);
+    *store = rebuilt;
+    return true;
+}
+
+bool initLongCodeStore(LongCodeStore *store, uint32_t capacity)
+{
+    memset(store, 0, sizeof(*store));
+    if (capacity == 0) { capacity = 1; }
+
+    uint64_t slots = ((uint64_t)capacity * LONG_CODE_LOAD_DENOMINATOR) /
+                     LONG_CODE_LOAD_NUMERATOR;
+    uint32_t numBuckets = roundUpPowerOfTwo(
+        (uint32_t)((slots + LONG_CODE_BUCKET_SLOTS - 1) / LONG_CODE_BUCKET_SLOTS));
+    uint32_t numBloomBlocks = roundUpPowerOfTwo(
+        (uint32_t)((((uint64_t)capacity * LONG_CODE_BLOOM_BITS_PER_CODE) +
+                    BLOOM_BLOCK_BITS - 1) / BLOOM_BLOCK_BITS));
+
+    store->buckets = aligned_alloc(LONG_CODE_CACHE_LINE_BYTES,
+                                   numBuckets * sizeof(LongCodeBucket));
+    store->bloom = aligned_alloc(LONG_CODE_CACHE_LINE_BYTES,
+                                 numBloomBlocks * sizeof(LongCodeBloomBlock));
+    if ((store->buckets == NULL) || (store->bloom == NULL))
+    {
+        freeLongCodeStore(store);
+        return false;
+    }
+
+    memset(store->buckets, 0xFF, numBuckets * sizeof(LongCodeBucket));
+    memset(store->bloom, 0, numBloomBlocks * sizeof(LongCodeBloomBlock));
+    store->bucketMask = numBuckets - 1;
+    store->bloomBlockMask = numBloomBlocks - 1;
+    store->capacity = capacity;
+    return true;
+}
+
+void freeLongCodeStore(LongCodeStore *store)
+{
+    free(store->buckets);
+    free(store->bloom);
+    store->buckets = NULL;
+    store->bloom = NULL;
+}
+
+bool packLongCode(const uint8_t digits[], uint8_t length, LongCode *code)
+{
+    if ((length == 0) || (length > LONG_CODE_MAX_DIGITS)) { return false; }
+
+    LongCode packed = LONG_CODE_EMPTY;
+    for (uint8_t i = 0; i < length; i++)
+    {
+        if (digits[i] > 9) { return false; }
+        unsigned shift = (LONG_CODE_MAX_DIGITS - 1 - i) * 4;
+        packed = (packed & ~(0xFULL << shift)) | ((LongCode)digits[i] << shift);
+    }
+
+    *code = packed;
+    return true;
+}
+
+bool isStoredLongCode(const LongCodeStore *store, LongCode code)
+{
+    uint64_t hash = hashLongCode(code);
+    return (testBloomBits(store, hash) && (findSlot(store, code, hash) != NULL));
+}
+
+bool mayBeStoredLongCode(const LongCodeStore *store, LongCode code)
+{
+    return testBloomBits(store, hashLongCode(code));
+}
+
+bool isTableLongCode(const LongCodeStore *store, LongCode code)
+{
+    return (findSlot(store, code, hashLongCode(code)) != NULL);
+}
+
+bool addLongCode(LongCodeStore *store, LongCode code)
+{
+    if ((code == LONG_CODE_EMPTY) || (code == LONG_CODE_DELETED) ||
+        (store->count == store->capacity))
+    {
+        return false;
+    }
+
+    uint64_t hash = hashLongCode(code);
+    if (findSlot(store, code, hash) != NULL) { return false; }
+
+    insertSlot(store, code, hash);
+    setBloomBits(store, hash);
+    store->count++;
+    return true;
+}
+
+bool removeLongCode(LongCodeStore *store, LongCode code)
+{
+    LongCode *slot = findSlot(store, code, hashLongCode(code));
+    if (slot == NULL) { return false; }
+
+    *slot = LONG_CODE_DELETED;
+    store->count--;
+    store->deleted++;
+
+    // Deleted slots lengthen probes and leave their filter bits set
+    if (store->deleted > (store->capacity / 4)) { rebuildLongCodeStore(store); }
+    return true;
+}
+
+size_t getLongCodeStoreBytes(const LongCodeStore *store)
+{
+    return (((size_t)store->bucketMask + 1) * sizeof(LongCodeBucket)) +
+           (((size_t)store->bloomBlockMask + 1) * sizeof(LongCodeBloomBlock));
+}
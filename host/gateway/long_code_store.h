@@ -0,0 +1,129 @@
+/*  long_code_store.h
+ *  Authors: Kyle Bielby, Christopher Lloyd
+ *  Description: Store for codes longer than the firmware's 4 digit passcodes
+ *  (up to LONG_CODE_MAX_DIGITS digits), sized for hundreds of thousands of
+ *  codes. A bitset over 10^8 or more codes is too big and a linear scan too
+ *  slow, so codes live in an open addressing hash table of cache line sized
+ *  buckets. A blocked Bloom filter in front rejects most absent codes
+ *  without touching the table.
+ *
+ *  Codes are packed like packPasscode in Security_System.c, one digit per
+ *  nibble with the first digit in the most significant nibble. Unused low
+ *  nibbles hold 0xF (a blank digit), so codes of different lengths differ.
+ */
+
+#ifndef LONG_CODE_STORE_H
+#define LONG_CODE_STORE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define LONG_CODE_MAX_DIGITS 16
+
+// Slot markers (no packed code has only 0xF or 0xE in its last nibbles)
+#define LONG_CODE_EMPTY   UINT64_MAX
+#define LONG_CODE_DELETED (UINT64_MAX - 1)
+
+#define LONG_CODE_CACHE_LINE_BYTES 64
+#define LONG_CODE_BUCKET_SLOTS     (LONG_CODE_CACHE_LINE_BYTES / sizeof(uint64_t))
+
+// Table slots per code at full capacity (load factor 3/4)
+#define LONG_CODE_LOAD_NUMERATOR   3
+#define LONG_CODE_LOAD_DENOMINATOR 4
+
+// Bloom filter bits per code and bits set per code (all in one cache line)
+#define LONG_CODE_BLOOM_BITS_PER_CODE 10
+#define LONG_CODE_BLOOM_PROBES        4
+
+typedef uint64_t LongCode;
+
+// Codes whose hash selects this bucket, or an earlier full one
+typedef struct
+{
+    _Alignas(LONG_CODE_CACHE_LINE_BYTES) LongCode slots[LONG_CODE_BUCKET_SLOTS];
+} LongCodeBucket;
+
+// One cache line of Bloom filter bits
+typedef struct
+{
+    _Alignas(LONG_CODE_CACHE_LINE_BYTES)
+    uint64_t words[LONG_CODE_CACHE_LINE_BYTES / sizeof(uint64_t)];
+} LongCodeBloomBlock;
+
+typedef struct
+{
+    LongCodeBucket *buckets;
+    uint32_t bucketMask;          // Number of buckets - 1 (a power of two)
+    LongCodeBloomBlock *bloom;
+    uint32_t bloomBlockMask;      // Number of Bloom blocks - 1
+    uint32_t capacity;
+    uint32_t count;
+    uint32_t deleted;             // Deleted slots (still set in the filter)
+} LongCodeStore;
+
+/*
+ *  Allocates an empty store for up to capacity codes.
+ *
+ *  Returns: bool: Store allocated?
+ */
+bool initLongCodeStore(LongCodeStore *store, uint32_t capacity);
+
+/*
+ *  Frees a store.
+ *
+ *  Returns: void
+ */
+void freeLongCodeStore(LongCodeStore *store);
+
+/*
+ *  Packs length digits (0-9) into a long code.
+ *
+ *  Returns: bool: Digits valid (1 to LONG_CODE_MAX_DIGITS digits, 0-9 each)?
+ */
+bool packLongCode(const uint8_t digits[], uint8_t length, LongCode *code);
+
+/*
+ *  Checks if a code is stored, asking the Bloom filter first.
+ *
+ *  Returns: bool: Code is stored?
+ */
+bool isStoredLongCode(const LongCodeStore *store, LongCode code);
+
+/*
+ *  Checks the Bloom filter only (false positives, no false negatives).
+ *
+ *  Returns: bool: Code may be stored?
+ */
+bool mayBeStoredLongCode(const LongCodeStore *store, LongCode code);
+
+/*
+ *  Checks the hash table only, without the Bloom filter.
+ *
+ *  Returns: bool: Code is stored?
+ */
+bool isTableLongCode(const LongCodeStore *store, LongCode code);
+
+/*
+ *  Adds a code.
+ *
+ *  Returns: bool: Code added (false if already stored or the store is full)?
+ */
+bool addLongCode(LongCodeStore *store, LongCode code);
+
+/*
+ *  Removes a code. Once enough slots are deleted the table and filter are
+ *  rebuilt, which takes time proportional to the capacity.
+ *
+ *  Returns: bool: Code removed (false if not stored)?
+ */
+bool removeLongCode(LongCodeStore *store, LongCode code);
+
+/*
+ *  Gets the memory used by the table and the filter.
+ *
+ *  Returns: size_t: Bytes.
+ */
+size_t getLongCodeStoreBytes(const LongCodeStore *store);
+
+#endif // LONG_CODE_STORE_H
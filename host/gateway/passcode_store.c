@@ -0,0 +1,190 @@
+/* -----------------------------------------------------------------------------
+ * Filename     : passcode_store.c
+ * Author(s)    : Kyle Bielby, Chris Lloyd (Team 1)
+ * Class        : EE365 (Final Project)
+ * Target Board : Cora Z7-10 (host tools)
+ * Description  : Single writer, wait-free reader passcode store for the
+ *                multithreaded host gateway (see passcode_store.h).
+ * -------------------------------------------------------------------------- */
+
+// Includes
+#include <string.h>
+#include <sched.h>
+#include "passcode_store.h"
+
+// Reader epoch while the reader is not checking
+#define NOT_CHECKING 0
+
+/*
+ * This function finds where a packed passcode is, or would be inserted, in a
+ * snapshot.
+ *
+ * Return: (uint16_t): Index of the first passcode not below packedPasscode.
+ */
+static uint16_t findSnapshotIndex(const PasscodeSnapshot *snapshot,
+                                  uint16_t packedPasscode)
+{
+    uint16_t low = 0;
+    uint16_t high = snapshot->count;
+    while (low < high)
+    {
+        uint16_t middle = (low + high) / 2;
+        if (snapshot->passcodes[middle] < packedPasscode) { low = middle + 1; }
+        else { high = middle; }
+    }
+    return low;
+}
+
+/*
+ * This function waits until no reader can still hold the spare snapshot, so
+ * the writer can change it. The spare was published before spareEpoch began.
+ * A reader announces its epoch (seq_cst store) before loading the published
+ * pointer (seq_cst load), so a reader that loaded the spare announced an epoch
+ * older than spareEpoch and is waited for.
+ *
+ * Return: None (void)
+ */
+static void waitForSpareSnapshot(PasscodeStore *store)
+{
+    uint32_t numReaders = __atomic_load_n(&store->numReaders, __ATOMIC_ACQUIRE);
+    if (numReaders > PASSCODE_STORE_MAX_READERS)
+    {
+        numReaders = PASSCODE_STORE_MAX_READERS;
+    }
+
+    for (uint32_t reader = 0; reader < numReaders; reader++)
+    {
+        while (true)
+        {
+            uint64_t readerEpoch = __atomic_load_n(&store->readers[reader].epoch,
+                                                   __ATOMIC_SEQ_CST);
+            if ((readerEpoch == NOT_CHECKING) ||
+                (readerEpoch >= store->spareEpoch))
+            {
+                break;
+            }
+            sched_yield();
+        }
+    }
+}
+
+/*
+ * This function publishes the writer's changed copy and starts a new epoch.
+ * The old snapshot becomes the spare; the wait for its last readers is left
+ * to the next change, so a write does not stall behind a preempted reader.
+ *
+ * Return: None (void)
+ */
+static void publishSpareSnapshot(PasscodeStore *store)
+{
+    PasscodeSnapshot *old = store->published;
+    __atomic_store_n(&store->published, store->spare, __ATOMIC_SEQ_CST);
+    store->spareEpoch = __atomic_add_fetch(&store->epoch, 1, __ATOMIC_SEQ_CST);
+    store->spare = old;
+}
+
+void initPasscodeStore(PasscodeStore *store)
+{
+    memset(store, 0, sizeof(*store));
+    store->published = &store->snapshots[0];
+    store->spare = &store->snapshots[1];
+    store->epoch = 1;
+    store->spareEpoch = 1;
+}
+
+int registerPasscodeReader(PasscodeStore *store)
+{
+    uint32_t reader = __atomic_fetch_add(&store->numReaders, 1, __ATOMIC_ACQ_REL);
+    if (reader >= PASSCODE_STORE_MAX_READERS)
+    {
+        __atomic_fetch_sub(&store->numReaders, 1, __ATOMIC_ACQ_REL);
+        return PASSCODE_STORE_NO_READER;
+    }
+    return (int)reader;
+}
+
+bool checkStoredPasscode(PasscodeStore *store, int reader,
+                         uint16_t packedPasscode)
+{
+    PasscodeReader *self = &store->readers[reader];
+
+    // Announce the epoch, then take the snapshot published in it
+    __atomic_store_n(&self->epoch,
+                     __atomic_load_n(&store->epoch, __ATOMIC_ACQUIRE),
+                     __ATOMIC_SEQ_CST);
+    const PasscodeSnapshot *snapshot =
+        __atomic_load_n(&store->published, __ATOMIC_SEQ_CST);
+
+    bool stored = isSnapshotPasscode(snapshot, packedPasscode);
+
+    __atomic_store_n(&self->epoch, NOT_CHECKING, __ATOMIC_RELEASE);
+    return stored;
+}
+
+bool addStoredPasscode(PasscodeStore *store, uint16_t packedPasscode)
+{
+    if (isSnapshotPasscode(store->published, packedPasscode) ||
+        (store->published->count == PASSCODE_STORE_CAPACITY))
+    {
+        return false;
+    }
+
+    waitForSpareSnapshot(store);
+    *store->spare = *store->published;
+    insertSnapshotPasscode(store->spare, packedPasscode);
+    publishSpareSnapshot(store);
+    return true;
+}
+
+bool removeStoredPasscode(PasscodeStore *store, uint16_t packedPasscode)
+{
+    if (!isSnapshotPasscode(store->published, packedPasscode)) { return false; }
+
+    waitForSpareSnapshot(store);
+    *store->spare = *store->published;
+    deleteSnapshotPasscode(store->spare, packedPasscode);
+    publishSpareSnapshot(store);
+    return true;
+}
+
+bool isSnapshotPasscode(const PasscodeSnapshot *snapshot,
+                        uint16_t packedPasscode)
+{
+    uint16_t index = findSnapshotIndex(snapshot, packedPasscode);
+    return ((index < snapshot->count) &&
+            (snapshot->passcodes[index] == packedPasscode));
+}
+
+bool insertSnapshotPasscode(PasscodeSnapshot *snapshot,
+                            uint16_t packedPasscode)
+{
+    uint16_t index = findSnapshotIndex(snapshot, packedPasscode);
+    if (((index < snapshot->count) &&
+         (snapshot->passcodes[index] == packedPasscode)) ||
+        (snapshot->count == PASSCODE_STORE_CAPACITY))
+    {
+        return false;
+    }
+
+    memmove(&snapshot->passcodes[index + 1], &snapshot->passcodes[index],
+            (snapshot->count - index) * sizeof(snapshot->passcodes[0]));
+    snapshot->passcodes[index] = packedPasscode;
+    snapshot->count++;
+    return true;
+}
+
+bool deleteSnapshotPasscode(PasscodeSnapshot *snapshot,
+                            uint16_t packedPasscode)
+{
+    uint16_t index = findSnapshotIndex(snapshot, packedPasscode);
+    if ((index == snapshot->count) ||
+        (snapshot->passcodes[index] != packedPasscode))
+    {
+        return false;
+    }
+
+    snapshot->count--;
+    memmove(&snapshot->passcodes[index], &snapshot->passcodes[index + 1],
+            (snapshot->count - index) * sizeof(snapshot->passcodes[0]));
+    return true;
+}
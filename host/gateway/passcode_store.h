@@ -0,0 +1,118 @@
+/*  passcode_store.h
+ *  Authors: Kyle Bielby, Christopher Lloyd
+ *  Description: Passcode store for the multithreaded host gateway. Any number
+ *  of registered reader threads check passcodes while a single writer thread
+ *  adds and removes them.
+ *
+ *  Readers are wait-free: a check announces the epoch it reads in, loads the
+ *  published snapshot and searches it, a fixed number of steps whatever the
+ *  writer is doing. The writer copies the published snapshot, changes the
+ *  copy and swaps the pointer (RCU style), starting a new epoch. The old
+ *  snapshot is only reused by the next change, once every reader has left
+ *  the epoch it was published in, so only two snapshots ever exist and
+ *  nothing is allocated.
+ */
+
+#ifndef PASSCODE_STORE_H
+#define PASSCODE_STORE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Same limit as MAX_NUM_STORED_PASSCODES in Security_System.c
+#define PASSCODE_STORE_CAPACITY 100
+
+#define PASSCODE_STORE_MAX_READERS 64
+#define PASSCODE_STORE_NO_READER   -1
+
+#define CACHE_LINE_BYTES 64
+
+// An immutable view of the store: packed passcodes (one digit per nibble,
+// see packPasscode in Security_System.c) in ascending order
+typedef struct
+{
+    uint16_t count;
+    uint16_t passcodes[PASSCODE_STORE_CAPACITY];
+} PasscodeSnapshot;
+
+// Epoch a reader is checking in (0 when it is not checking). One cache line
+// each, so readers never share a line with one another.
+typedef struct
+{
+    _Alignas(CACHE_LINE_BYTES) uint64_t epoch;
+} PasscodeReader;
+
+typedef struct
+{
+    PasscodeSnapshot *published;     // Snapshot readers check against
+    PasscodeSnapshot *spare;         // Writer's copy (see spareEpoch)
+    uint64_t spareEpoch;             // Readers of spare announced older epochs
+    _Alignas(CACHE_LINE_BYTES) uint64_t epoch;
+    uint32_t numReaders;
+    PasscodeReader readers[PASSCODE_STORE_MAX_READERS];
+    PasscodeSnapshot snapshots[2];
+} PasscodeStore;
+
+/*
+ *  Empties a store.
+ *
+ *  Returns: void
+ */
+void initPasscodeStore(PasscodeStore *store);
+
+/*
+ *  Registers the calling thread as a reader.
+ *
+ *  Returns: int: Reader number (PASSCODE_STORE_NO_READER if all are taken).
+ */
+int registerPasscodeReader(PasscodeStore *store);
+
+/*
+ *  Checks if a packed passcode is stored (readers only, wait-free).
+ *
+ *  Returns: bool: Passcode is stored?
+ */
+bool checkStoredPasscode(PasscodeStore *store, int reader,
+                         uint16_t packedPasscode);
+
+/*
+ *  Adds a packed passcode (writer only). Every check that starts after this
+ *  returns sees it.
+ *
+ *  Returns: bool: Passcode added (false if already stored or full)?
+ */
+bool addStoredPasscode(PasscodeStore *store, uint16_t packedPasscode);
+
+/*
+ *  Removes a packed passcode (writer only). No check that starts after this
+ *  returns accepts it.
+ *
+ *  Returns: bool: Passcode removed (false if not stored)?
+ */
+bool removeStoredPasscode(PasscodeStore *store, uint16_t packedPasscode);
+
+/*
+ *  Searches a snapshot for a packed passcode (binary search).
+ *
+ *  Returns: bool: Passcode is in the snapshot?
+ */
+bool isSnapshotPasscode(const PasscodeSnapshot *snapshot,
+                        uint16_t packedPasscode);
+
+/*
+ *  Inserts a packed passcode into a snapshot, keeping it in order.
+ *
+ *  Returns: bool: Passcode inserted (false if already there or full)?
+ */
+bool insertSnapshotPasscode(PasscodeSnapshot *snapshot,
+                            uint16_t packedPasscode);
+
+/*
+ *  Deletes a packed passcode from a snapshot.
+ *
+ *  Returns: bool: Passcode deleted (false if not there)?
+ */
+bool deleteSnapshotPasscode(PasscodeSnapshot *snapshot,
+                            uint16_t packedPasscode);
+
+#endif // PASSCODE_STORE_H
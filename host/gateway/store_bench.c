@@ -0,0 +1,298 @@
+/* -----------------------------------------------------------------------------
+ * Filename     : store_bench.c
+ * Author(s)    : Kyle Bielby, Chris Lloyd (Team 1)
+ * Class        : EE365 (Final Project)
+ * Target Board : Cora Z7-10 (host tools)
+ * Description  : Measures passcode check throughput of the gateway store
+ *                (passcode_store.h) with 1 to 32 reader threads while a writer
+ *                thread adds and removes passcodes at a steady rate. The same
+ *                run against one snapshot behind a pthread rwlock is the
+ *                baseline.
+ *
+ *                  store_bench [-d ms] [-w writes/s] [-r max readers]
+ * -------------------------------------------------------------------------- */
+
+// Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "passcode_store.h"
+
+#define DEFAULT_DURATION_MS   500
+#define DEFAULT_WRITES_PER_S  1000
+#define DEFAULT_MAX_READERS   32
+
+// Passcodes stored before a run, and how many the writer toggles on top
+#define NUM_BASE_PASSCODES    50
+#define NUM_WRITER_PASSCODES  40
+
+// Checks between looks at the stop flag
+#define CHECKS_PER_BATCH 1024
+
+typedef enum
+{
+    STORE_WAIT_FREE,
+    STORE_RWLOCK
+} StoreKind;
+
+// The rwlock baseline: one snapshot, readers share the lock
+typedef struct
+{
+    pthread_rwlock_t lock;
+    PasscodeSnapshot snapshot;
+} LockedStore;
+
+// Counters of one reader thread (one cache line each)
+typedef struct
+{
+    _Alignas(CACHE_LINE_BYTES) uint64_t checks;
+    uint64_t matches;
+} ReaderCounters;
+
+static PasscodeStore waitFreeStore;
+static LockedStore lockedStore;
+static StoreKind storeKind;
+static bool stopRun;
+static uint32_t writesPerSecond = DEFAULT_WRITES_PER_S;
+static uint64_t writesDone;
+static ReaderCounters readerCounters[PASSCODE_STORE_MAX_READERS];
+
+/*
+ * This function gets a monotonic time in nanoseconds.
+ *
+ * Return: (uint64_t): Nanoseconds.
+ */
+static uint64_t getTimeNS()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000000ULL) + now.tv_nsec;
+}
+
+/*
+ * This function packs a number 0-9999 like packPasscode in Security_System.c
+ * (one decimal digit per nibble).
+ *
+ * Return: (uint16_t): Packed passcode.
+ */
+static uint16_t packNumber(uint32_t number)
+{
+    return (uint16_t)((((number / 1000) % 10) << 12) |
+                      (((number / 100) % 10) << 8) |
+                      (((number / 10) % 10) << 4) |
+                      (number % 10));
+}
+
+/*
+ * This function steps a xorshift generator.
+ *
+ * Return: (uint32_t): Next pseudo random number.
+ */
+static uint32_t nextRandom(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return (*state = x);
+}
+
+/*
+ * This function empties both stores and fills them with the base passcodes
+ * (every 100th number from 100).
+ *
+ * Return: None (void)
+ */
+static void fillStores()
+{
+    initPasscodeStore(&waitFreeStore);
+    memset(&lockedStore.snapshot, 0, sizeof(lockedStore.snapshot));
+    for (uint32_t i = 1; i <= NUM_BASE_PASSCODES; i++)
+    {
+        addStoredPasscode(&waitFreeStore, packNumber(i * 100));
+        insertSnapshotPasscode(&lockedStore.snapshot, packNumber(i * 100));
+    }
+}
+
+/*
+ * This function checks random passcodes until the run stops.
+ *
+ * Return: (void *): NULL
+ */
+static void *runReader(void *argument)
+{
+    ReaderCounters *counters = argument;
+    uint32_t random = (uint32_t)(uintptr_t)argument | 1;
+    int reader = PASSCODE_STORE_NO_READER;
+    if (storeKind == STORE_WAIT_FREE)
+    {
+        reader = registerPasscodeReader(&waitFreeStore);
+    }
+
+    uint64_t checks = 0;
+    uint64_t matches = 0;
+    while (!__atomic_load_n(&stopRun, __ATOMIC_RELAXED))
+    {
+        for (int i = 0; i < CHECKS_PER_BATCH; i++)
+        {
+            uint16_t packedPasscode = packNumber(nextRandom(&random) % 10000);
+            bool stored;
+            if (storeKind == STORE_WAIT_FREE)
+            {
+                stored = checkStoredPasscode(&waitFreeStore, reader,
+                                             packedPasscode);
+            }
+            else
+            {
+                pthread_rwlock_rdlock(&lockedStore.lock);
+                stored = isSnapshotPasscode(&lockedStore.snapshot,
+                                            packedPasscode);
+                pthread_rwlock_unlock(&lockedStore.lock);
+            }
+            matches += stored;
+        }
+        checks += CHECKS_PER_BATCH;
+    }
+
+    counters->checks = checks;
+    counters->matches = matches;
+    return NULL;
+}
+
+/*
+ * This function adds and then removes NUM_WRITER_PASSCODES passcodes over and
+ * over, paced to writesPerSecond, until the run stops.
+ *
+ * Return: (void *): NULL
+ */
+static void *runWriter(void *argument)
+{
+    (void)argument;
+    uint64_t writes = 0;
+    uint64_t start = getTimeNS();
+    uint64_t interval = 1000000000ULL / writesPerSecond;
+
+    while (!__atomic_load_n(&stopRun, __ATOMIC_RELAXED))
+    {
+        // Wait for the next write slot
+        uint64_t due = start + (writes * interval);
+        uint64_t now = getTimeNS();
+        if (now < due)
+        {
+            struct timespec wait = {0, (long)(due - now)};
+            nanosleep(&wait, NULL);
+            continue;
+        }
+
+        // Numbers ending in 50 are never base passcodes
+        uint32_t step = (uint32_t)(writes % (2 * NUM_WRITER_PASSCODES));
+        uint16_t packedPasscode =
+            packNumber(((step % NUM_WRITER_PASSCODES) * 100) + 50);
+        bool add = (step < NUM_WRITER_PASSCODES);
+
+        if (storeKind == STORE_WAIT_FREE)
+        {
+            if (add) { addStoredPasscode(&waitFreeStore, packedPasscode); }
+            else { removeStoredPasscode(&waitFreeStore, packedPasscode); }
+        }
+        else
+        {
+            pthread_rwlock_wrlock(&lockedStore.lock);
+            if (add) { insertSnapshotPasscode(&lockedStore.snapshot, packedPasscode); }
+            else { deleteSnapshotPasscode(&lockedStore.snapshot, packedPasscode); }
+            pthread_rwlock_unlock(&lockedStore.lock);
+        }
+        writes++;
+    }
+
+    writesDone = writes;
+    return NULL;
+}
+
+/*
+ * This function runs numReaders readers and the writer on one store for
+ * durationMS.
+ *
+ * Return: (double): Checks per second over all readers.
+ */
+static double runBenchmark(StoreKind kind, int numReaders, uint32_t durationMS)
+{
+    pthread_t readers[PASSCODE_STORE_MAX_READERS];
+    pthread_t writer;
+
+    storeKind = kind;
+    stopRun = false;
+    fillStores();
+
+    uint64_t start = getTimeNS();
+    for (int i = 0; i < numReaders; i++)
+    {
+        pthread_create(&readers[i], NULL, runReader, &readerCounters[i]);
+    }
+    pthread_create(&writer, NULL, runWriter, NULL);
+
+    usleep(durationMS * 1000);
+    __atomic_store_n(&stopRun, true, __ATOMIC_RELAXED);
+
+    uint64_t checks = 0;
+    for (int i = 0; i < numReaders; i++)
+    {
+        pthread_join(readers[i], NULL);
+        checks += readerCounters[i].checks;
+    }
+    pthread_join(writer, NULL);
+    double seconds = (getTimeNS() - start) / 1e9;
+
+    return (checks / seconds);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t durationMS = DEFAULT_DURATION_MS;
+    int maxReaders = DEFAULT_MAX_READERS;
+
+    int option;
+    while ((option = getopt(argc, argv, "d:w:r:")) != -1)
+    {
+        switch (option)
+        {
+            case 'd': durationMS = (uint32_t)atoi(optarg); break;
+            case 'w': writesPerSecond = (uint32_t)atoi(optarg); break;
+            case 'r': maxReaders = atoi(optarg); break;
+            default:
+                fprintf(stderr, "usage: %s [-d ms] [-w writes/s] [-r max readers]\n",
+                        argv[0]);
+                return 1;
+        }
+    }
+    if ((maxReaders < 1) || (maxReaders > PASSCODE_STORE_MAX_READERS) ||
+        (writesPerSecond == 0) || (durationMS == 0))
+    {
+        fprintf(stderr, "%s: bad option value\n", argv[0]);
+        return 1;
+    }
+    pthread_rwlock_init(&lockedStore.lock, NULL);
+
+    printf("%ld cpus, %u writes/s, %u ms per run\n",
+           sysconf(_SC_NPROCESSORS_ONLN), writesPerSecond, durationMS);
+    printf("%7s %17s %14s %8s %17s %8s\n", "readers", "wait-free Mchk/s",
+           "per reader", "writes", "rwlock Mchk/s", "writes");
+    for (int numReaders = 1; numReaders <= maxReaders; numReaders *= 2)
+    {
+        double waitFree = runBenchmark(STORE_WAIT_FREE, numReaders, durationMS);
+        uint64_t waitFreeWrites = writesDone;
+        double locked = runBenchmark(STORE_RWLOCK, numReaders, durationMS);
+
+        printf("%7d %17.2f %14.2f %8llu %17.2f %8llu\n", numReaders,
+               waitFree / 1e6, (waitFree / numReaders) / 1e6,
+               (unsigned long long)waitFreeWrites, locked / 1e6,
+               (unsigned long long)writesDone);
+    }
+
+    return 0;
+}
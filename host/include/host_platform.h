@@ -0,0 +1,48 @@
+/*  host_platform.h
+ *  Authors: Kyle Bielby, Christopher Lloyd
+ *  Description: Functions Security_System.c needs from a host backend when it
+ *  is built for Linux with HOST_BUILD defined.
+ */
+
+#ifndef HOST_PLATFORM_H
+#define HOST_PLATFORM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ *  Delays the firmware by ms milliseconds of target time. The backend decides
+ *  how target time maps onto host time (e.g. simulated clock ticks).
+ *
+ *  Returns: void
+ */
+void hostDelayMS(uint16_t ms);
+
+/*
+ *  Blocks until a keypad key or button is held (the target's input interrupts)
+ *  or timeoutMS milliseconds of target time pass (0 waits for input only).
+ *  This is the host equivalent of the firmware idling in WFI.
+ *
+ *  Returns: bool: Woken by input (false when the timeout passed)?
+ */
+bool hostWaitForInput(uint32_t timeoutMS);
+
+/*
+ *  Reads the next console command character without blocking (the target
+ *  reads commands from UART). Only needed with USE_REGISTER_TRACE or
+ *  USE_PROFILER.
+ *
+ *  Returns: int: The command, or -1 if none is waiting.
+ */
+int hostReadConsoleCommand(void);
+
+/*
+ *  Writes up to size bytes to the UART without blocking. Only needed with
+ *  USE_TELEMETRY.
+ *
+ *  Returns: size_t: Number of bytes written (0 when the UART is full).
+ */
+size_t hostWriteUART(const uint8_t data[], size_t size);
+
+#endif // HOST_PLATFORM_H
@@ -0,0 +1,16 @@
+/*  xil_cache.h
+ *  Authors: Kyle Bielby, Christopher Lloyd
+ *  Description: Host build stand-in for the Xilinx standalone BSP header of
+ *  the same name. The host has no caches to manage.
+ */
+
+#ifndef XIL_CACHE_H
+#define XIL_CACHE_H
+
+#define Xil_DCacheEnable()
+#define Xil_DCacheDisable()
+#define Xil_ICacheEnable()
+#define Xil_ICacheDisable()
+#define Xil_DCacheFlushRange(adr, len)
+
+#endif // XIL_CACHE_H
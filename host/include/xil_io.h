@@ -0,0 +1,28 @@
+/*  xil_io.h
+ *  Authors: Kyle Bielby, Christopher Lloyd
+ *  Description: Host build stand-in for the Xilinx standalone BSP header of
+ *  the same name. Register accesses are routed to whichever host backend is
+ *  linked in (e.g. the GHDL co-simulation in host/cosim).
+ */
+
+#ifndef XIL_IO_H
+#define XIL_IO_H
+
+#include "xil_types.h"
+
+/*
+ *  Reads a 32-bit peripheral register
+ *
+ *  Returns:
+ *  - u32: value of the register at Addr
+ */
+u32 Xil_In32(UINTPTR Addr);
+
+/*
+ *  Writes a 32-bit peripheral register
+ *
+ *  Returns: void
+ */
+void Xil_Out32(UINTPTR Addr, u32 Value);
+
+#endif // XIL_IO_H
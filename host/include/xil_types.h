@@ -0,0 +1,32 @@
+/*  xil_types.h
+ *  Authors: Kyle Bielby, Christopher Lloyd
+ *  Description: Host build stand-in for the Xilinx standalone BSP header of
+ *  the same name. Only the types used by Security_System.c and the IP drivers
+ *  are provided.
+ */
+
+#ifndef XIL_TYPES_H
+#define XIL_TYPES_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef uint8_t  u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+typedef int8_t   s8;
+typedef int16_t  s16;
+typedef int32_t  s32;
+typedef int64_t  s64;
+typedef uintptr_t UINTPTR;
+typedef intptr_t INTPTR;
+
+#ifndef TRUE
+#define TRUE  1U
+#endif
+#ifndef FALSE
+#define FALSE 0U
+#endif
+
+#endif // XIL_TYPES_H
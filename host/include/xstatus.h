@@ -0,0 +1,17 @@
+/*  xstatus.h
+ *  Authors: Kyle Bielby, Christopher Lloyd
+ *  Description: Host build stand-in for the Xilinx standalone BSP header of
+ *  the same name.
+ */
+
+#ifndef XSTATUS_H
+#define XSTATUS_H
+
+#include "xil_types.h"
+
+typedef int XStatus;
+
+#define XST_SUCCESS 0L
+#define XST_FAILURE 1L
+
+#endif // XSTATUS_H
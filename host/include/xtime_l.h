@@ -0,0 +1,19 @@
+/*  xtime_l.h
+ *  Authors: Kyle Bielby, Christopher Lloyd
+ *  Description: Host build stand-in for the Xilinx standalone BSP header of
+ *  the same name. The global timer counts microseconds of target time and is
+ *  read from the host backend.
+ */
+
+#ifndef XTIME_L_H
+#define XTIME_L_H
+
+#include "xil_types.h"
+
+typedef u64 XTime;
+
+#define COUNTS_PER_SECOND 1000000
+
+void XTime_GetTime(XTime *Xtime_Global);
+
+#endif // XTIME_L_H
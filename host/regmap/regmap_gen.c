@@ -0,0 +1,698 @@
+/* -----------------------------------------------------------------------------
+ * Filename     : regmap_gen.c
+ * Author(s)    : Kyle Bielby, Chris Lloyd (Team 1)
+ * Class        : EE365 (Final Project)
+ * Target Board : Cora Z7-10 (host tools)
+ * Description  : Generates peripheral_regs.h from the IP-XACT component.xml
+ *                files of the AXI slaves in ip_repo. For every peripheral it
+ *                writes the base address, register addresses, field masks,
+ *                shifts and named values as constants, and a static inline
+ *                read and/or write function per register (following its
+ *                access), so the compiler can inline every peripheral access.
+ *
+ *                Base addresses are assigned in the block design, not the
+ *                IP, so they are given on the command line with the block
+ *                design instance name. The header checks them against the
+ *                BSP's xparameters.h at compile time.
+ *
+ *                  regmap_gen [-o header] component.xml instance base...
+ * -------------------------------------------------------------------------- */
+
+// Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+
+#define MAX_PERIPHERALS 16
+#define MAX_REGISTERS   64
+#define MAX_FIELDS      32
+#define MAX_VALUES      16
+#define MAX_NAME        64
+#define MAX_DESCRIPTION 128
+
+typedef enum
+{
+    ACCESS_READ_WRITE,
+    ACCESS_READ_ONLY,
+    ACCESS_WRITE_ONLY
+} Access;
+
+// A named value of a field (IP-XACT enumerated value)
+typedef struct
+{
+    char name[MAX_NAME];
+    uint32_t value;
+} FieldValue;
+
+typedef struct
+{
+    char name[MAX_NAME];
+    uint32_t bitOffset;
+    uint32_t bitWidth;
+    int numValues;
+    FieldValue values[MAX_VALUES];
+} Field;
+
+typedef struct
+{
+    char name[MAX_NAME];
+    char description[MAX_DESCRIPTION];
+    uint32_t offset;
+    uint32_t size;               // Bits
+    Access access;
+    bool hasReset;
+    uint32_t reset;
+    int numFields;
+    Field fields[MAX_FIELDS];
+} Register;
+
+typedef struct
+{
+    const char *path;
+    char name[MAX_NAME];         // Component name (lower case)
+    char prefix[MAX_NAME];       // Component name (upper case)
+    const char *instance;        // Block design instance name
+    uint32_t baseAddr;
+    uint32_t range;              // Bytes
+    int numRegisters;
+    Register registers[MAX_REGISTERS];
+} Peripheral;
+
+static Peripheral peripherals[MAX_PERIPHERALS];
+static int numPeripherals;
+
+/*
+ * This function prints an error about a peripheral and exits.
+ *
+ * Param: peripheral: The peripheral.
+ * Param: message: What is wrong.
+ * Return: None (void)
+ */
+static void fail(const Peripheral *peripheral, const char *message)
+{
+    fprintf(stderr, "regmap_gen: %s: %s\n", peripheral->path, message);
+    exit(1);
+}
+
+/*
+ * This function reads a whole file into a NUL terminated buffer.
+ *
+ * Return: (char *): File contents (NULL if it cannot be read).
+ */
+static char *readFile(const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) { return NULL; }
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    char *text = malloc(size + 1);
+    if ((text != NULL) && (fread(text, 1, size, file) == (size_t)size))
+    {
+        text[size] = '\0';
+    }
+    else
+    {
+        free(text);
+        text = NULL;
+    }
+    fclose(file);
+    return text;
+}
+
+/*
+ * This function finds the first element tag (e.g. "spirit:register") in
+ * [start, end) and the extent of its contents. Elements of the same tag are
+ * not nested in IP-XACT, so the first closing tag ends it.
+ *
+ * Param: contentStart: Set to the first character after the opening tag.
+ * Param: contentEnd: Set to the closing tag.
+ * Return: (bool): Element found?
+ */
+static bool findElement(const char *start, const char *end, const char *tag,
+                        const char **contentStart, const char **contentEnd)
+{
+    size_t length = strlen(tag);
+    for (const char *open = start; (open = strchr(open, '<')) != NULL &&
+                                   (open < end); open++)
+    {
+        // Match "<tag>" or "<tag attribute...>", not "<tagSuffix>"
+        if ((strncmp(open + 1, tag, length) != 0) ||
+            ((open[length + 1] != '>') && !isspace((unsigned char)open[length + 1])))
+        {
+            continue;
+        }
+
+        const char *content = strchr(open, '>');
+        if ((content == NULL) || (content >= end)) { return false; }
+        content++;
+
+        for (const char *close = content; (close = strstr(close, "</")) != NULL &&
+                                          (close < end); close++)
+        {
+            if ((strncmp(close + 2, tag, length) == 0) && (close[length + 2] == '>'))
+            {
+                *contentStart = content;
+                *contentEnd = close;
+                return true;
+            }
+        }
+        return false;
+    }
+    return false;
+}
+
+/*
+ * This function copies the text of the first element tag in [start, end),
+ * trimmed of surrounding white space.
+ *
+ * Return: (bool): Element found (and its text fits in size)?
+ */
+static bool getElementText(const char *start, const char *end, const char *tag,
+                           char *text, size_t size)
+{
+    const char *contentStart;
+    const char *contentEnd;
+    if (!findElement(start, end, tag, &contentStart, &contentEnd)) { return false; }
+
+    while ((contentStart < contentEnd) && isspace((unsigned char)*contentStart))
+    {
+        contentStart++;
+    }
+    while ((contentEnd > contentStart) && isspace((unsigned char)contentEnd[-1]))
+    {
+        contentEnd--;
+    }
+    if ((size_t)(contentEnd - contentStart) >= size) { return false; }
+
+    memcpy(text, contentStart, contentEnd - contentStart);
+    text[contentEnd - contentStart] = '\0';
+    return true;
+}
+
+/*
+ * This function reads the number in the first element tag in [start, end).
+ * Numbers are decimal or C style hex (0x...).
+ *
+ * Return: (bool): Element found and holds a number?
+ */
+static bool getElementNumber(const char *start, const char *end, const char *tag,
+                             uint32_t *number)
+{
+    char text[MAX_NAME];
+    if (!getElementText(start, end, tag, text, sizeof(text))) { return false; }
+
+    char *last;
+    unsigned long long value = strtoull(text, &last, 0);
+    if ((*last != '\0') || (last == text) || (value > UINT32_MAX)) { return false; }
+
+    *number = (uint32_t)value;
+    return true;
+}
+
+/*
+ * This function checks that a name can be used in C identifiers (upper case
+ * letters, digits and underscores).
+ *
+ * Return: (bool): Name is valid?
+ */
+static bool isValidName(const char *name)
+{
+    if (!isupper((unsigned char)name[0])) { return false; }
+    for (const char *c = name; *c != '\0'; c++)
+    {
+        if (!isupper((unsigned char)*c) && !isdigit((unsigned char)*c) && (*c != '_'))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * This function parses the fields of a register from its element contents.
+ *
+ * Return: None (void)
+ */
+static void parseFields(Peripheral *peripheral, Register *reg,
+                        const char *start, const char *end)
+{
+    const char *fieldStart;
+    const char *fieldEnd;
+    while (findElement(start, end, "spirit:field", &fieldStart, &fieldEnd))
+    {
+        if (reg->numFields == MAX_FIELDS) { fail(peripheral, "too many fields"); }
+        Field *field = &reg->fields[reg->numFields++];
+
+        if (!getElementText(fieldStart, fieldEnd, "spirit:name", field->name,
+                            sizeof(field->name)) || !isValidName(field->name) ||
+            !getElementNumber(fieldStart, fieldEnd, "spirit:bitOffset",
+                              &field->bitOffset) ||
+            !getElementNumber(fieldStart, fieldEnd, "spirit:bitWidth",
+                              &field->bitWidth))
+        {
+            fail(peripheral, "field needs a name, bitOffset and bitWidth");
+        }
+
+        const char *valueStart;
+        const char *valueEnd;
+        field->numValues = 0;
+        for (const char *next = fieldStart;
+             findElement(next, fieldEnd, "spirit:values", &valueStart, &valueEnd);
+             next = valueEnd)
+        {
+            if (field->numValues == MAX_VALUES) { fail(peripheral, "too many values"); }
+            FieldValue *value = &field->values[field->numValues++];
+            if (!getElementText(valueStart, valueEnd, "spirit:name", value->name,
+                                sizeof(value->name)) || !isValidName(value->name) ||
+                !getElementNumber(valueStart, valueEnd, "spirit:value",
+                                  &value->value))
+            {
+                fail(peripheral, "field value needs a name and a value");
+            }
+        }
+        start = fieldEnd;
+    }
+}
+
+/*
+ * This function parses one register from its element contents.
+ *
+ * Return: None (void)
+ */
+static void parseRegister(Peripheral *peripheral, Register *reg,
+                          const char *start, const char *end)
+{
+    // Register level elements all come before the first field
+    const char *ownEnd = strstr(start, "<spirit:field");
+    if ((ownEnd == NULL) || (ownEnd > end)) { ownEnd = end; }
+
+    if (!getElementText(start, ownEnd, "spirit:name", reg->name,
+                        sizeof(reg->name)) || !isValidName(reg->name) ||
+        !getElementNumber(start, ownEnd, "spirit:addressOffset", &reg->offset) ||
+        !getElementNumber(start, ownEnd, "spirit:size", &reg->size))
+    {
+        fail(peripheral, "register needs a name, addressOffset and size");
+    }
+    if (!getElementText(start, ownEnd, "spirit:description", reg->description,
+                        sizeof(reg->description)))
+    {
+        reg->description[0] = '\0';
+    }
+
+    char access[MAX_NAME];
+    reg->access = ACCESS_READ_WRITE;
+    if (getElementText(start, ownEnd, "spirit:access", access, sizeof(access)))
+    {
+        if (strcmp(access, "read-only") == 0) { reg->access = ACCESS_READ_ONLY; }
+        else if (strcmp(access, "write-only") == 0) { reg->access = ACCESS_WRITE_ONLY; }
+        else if (strcmp(access, "read-write") != 0)
+        {
+            fail(peripheral, "unsupported register access");
+        }
+    }
+
+    const char *resetStart;
+    const char *resetEnd;
+    reg->hasReset = findElement(start, ownEnd, "spirit:reset", &resetStart,
+                                &resetEnd);
+    if (reg->hasReset &&
+        !getElementNumber(resetStart, resetEnd, "spirit:value", &reg->reset))
+    {
+        fail(peripheral, "register reset needs a value");
+    }
+
+    reg->numFields = 0;
+    parseFields(peripheral, reg, ownEnd, end);
+}
+
+/*
+ * This function parses the address block of a component. Components packaged
+ * without register descriptions get the AXI wizard's registers (SLV_REG0 to
+ * SLV_REG<WIZ_NUM_REG - 1>, read-write, no fields).
+ *
+ * Return: None (void)
+ */
+static void parseComponent(Peripheral *peripheral, const char *text)
+{
+    const char *end = text + strlen(text);
+
+    if (!getElementText(text, end, "spirit:name", peripheral->name,
+                        sizeof(peripheral->name)))
+    {
+        fail(peripheral, "no component name");
+    }
+    for (size_t i = 0; i <= strlen(peripheral->name); i++)
+    {
+        peripheral->prefix[i] = toupper((unsigned char)peripheral->name[i]);
+    }
+    if (!isValidName(peripheral->prefix)) { fail(peripheral, "bad component name"); }
+
+    const char *blockStart;
+    const char *blockEnd;
+    uint32_t width;
+    if (!findElement(text, end, "spirit:addressBlock", &blockStart, &blockEnd) ||
+        !getElementNumber(blockStart, blockEnd, "spirit:range", &peripheral->range) ||
+        !getElementNumber(blockStart, blockEnd, "spirit:width", &width))
+    {
+        fail(peripheral, "no address block with a range and width");
+    }
+
+    const char *regStart;
+    const char *regEnd;
+    peripheral->numRegisters = 0;
+    for (const char *next = blockStart;
+         findElement(next, blockEnd, "spirit:register", &regStart, &regEnd);
+         next = regEnd)
+    {
+        if (peripheral->numRegisters == MAX_REGISTERS)
+        {
+            fail(peripheral, "too many registers");
+        }
+        parseRegister(peripheral, &peripheral->registers[peripheral->numRegisters++],
+                      regStart, regEnd);
+    }
+    if (peripheral->numRegisters > 0) { return; }
+
+    // Fall back to the registers the AXI peripheral wizard made
+    char count[MAX_NAME];
+    const char *wizard = strstr(text, "WIZ_NUM_REG\"");
+    if ((wizard == NULL) ||
+        !getElementText(wizard, end, "spirit:value", count, sizeof(count)))
+    {
+        fail(peripheral, "no registers and no WIZ_NUM_REG");
+    }
+    int numRegisters = atoi(count);
+    if ((numRegisters <= 0) || (numRegisters > MAX_REGISTERS))
+    {
+        fail(peripheral, "bad WIZ_NUM_REG");
+    }
+    for (int i = 0; i < numRegisters; i++)
+    {
+        Register *reg = &peripheral->registers[peripheral->numRegisters++];
+        memset(reg, 0, sizeof(*reg));
+        snprintf(reg->name, sizeof(reg->name), "SLV_REG%d", i);
+        reg->offset = i * (width / 8);
+        reg->size = width;
+        reg->access = ACCESS_READ_WRITE;
+    }
+}
+
+/*
+ * This function checks that the registers of a peripheral fit its address
+ * block without overlapping, and that their fields fit them without
+ * overlapping.
+ *
+ * Return: None (void)
+ */
+static void checkPeripheral(const Peripheral *peripheral)
+{
+    if ((peripheral->range == 0) || ((peripheral->baseAddr % peripheral->range) != 0))
+    {
+        fail(peripheral, "base address is not aligned to the address block range");
+    }
+
+    for (int i = 0; i < peripheral->numRegisters; i++)
+    {
+        const Register *reg = &peripheral->registers[i];
+        if (reg->size != 32) { fail(peripheral, "only 32-bit registers are supported"); }
+        if (((reg->offset % 4) != 0) || ((reg->offset + 4) > peripheral->range))
+        {
+            fail(peripheral, "register offset is unaligned or outside the range");
+        }
+        for (int j = 0; j < i; j++)
+        {
+            if (peripheral->registers[j].offset == reg->offset)
+            {
+                fail(peripheral, "registers overlap");
+            }
+            if (strcmp(peripheral->registers[j].name, reg->name) == 0)
+            {
+                fail(peripheral, "register names repeat");
+            }
+        }
+
+        uint64_t used = 0;
+        for (int j = 0; j < reg->numFields; j++)
+        {
+            const Field *field = &reg->fields[j];
+            if ((field->bitWidth == 0) ||
+                ((field->bitOffset + field->bitWidth) > reg->size))
+            {
+                fail(peripheral, "field is outside its register");
+            }
+            uint64_t mask = ((1ULL << field->bitWidth) - 1) << field->bitOffset;
+            if (used & mask) { fail(peripheral, "fields overlap"); }
+            used |= mask;
+
+            for (int k = 0; k < field->numValues; k++)
+            {
+                if ((field->bitWidth < 32) && (field->values[k].value >> field->bitWidth))
+                {
+                    fail(peripheral, "field value does not fit its field");
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < numPeripherals; i++)
+    {
+        const Peripheral *other = &peripherals[i];
+        if ((other != peripheral) &&
+            (peripheral->baseAddr < (other->baseAddr + other->range)) &&
+            (other->baseAddr < (peripheral->baseAddr + peripheral->range)))
+        {
+            fail(peripheral, "address block overlaps another peripheral");
+        }
+    }
+}
+
+/*
+ * This function converts an upper case name to Pascal case (KEY_STATE to
+ * KeyState) for function names.
+ *
+ * Return: None (void)
+ */
+static void toPascalCase(const char *name, char *pascal)
+{
+    bool upper = true;
+    for (; *name != '\0'; name++)
+    {
+        if (*name == '_')
+        {
+            upper = true;
+            continue;
+        }
+        *pascal++ = upper ? *name : tolower((unsigned char)*name);
+        upper = false;
+    }
+    *pascal = '\0';
+}
+
+/*
+ * This function writes the constants and accessors of one peripheral.
+ *
+ * Return: None (void)
+ */
+static void writePeripheral(FILE *out, const Peripheral *peripheral)
+{
+    const char *prefix = peripheral->prefix;
+    char instance[MAX_NAME];
+    for (size_t i = 0; i <= strlen(peripheral->instance); i++)
+    {
+        instance[i] = toupper((unsigned char)peripheral->instance[i]);
+    }
+
+    // Paths relative to the repository root
+    const char *path = peripheral->path;
+    while (strncmp(path, "../", 3) == 0) { path += 3; }
+
+    fprintf(out, "// %s (%s)\n", peripheral->instance, path);
+    fprintf(out, "#define %s_BASE_ADDR 0x%08XU\n", prefix, peripheral->baseAddr);
+    fprintf(out, "#define %s_RANGE     0x%XU\n", prefix, peripheral->range);
+    fprintf(out, "#ifdef XPAR_%s_S00_AXI_BASEADDR\n", instance);
+    fprintf(out, "_Static_assert(XPAR_%s_S00_AXI_BASEADDR == %s_BASE_ADDR,\n",
+            instance, prefix);
+    fprintf(out, "               \"%s moved in the address map, regenerate "
+            "peripheral_regs.h\");\n", peripheral->instance);
+    fprintf(out, "#endif\n");
+
+    for (int i = 0; i < peripheral->numRegisters; i++)
+    {
+        const Register *reg = &peripheral->registers[i];
+        char function[MAX_NAME];
+        toPascalCase(reg->name, function);
+
+        fprintf(out, "\n");
+        if (reg->description[0] != '\0') { fprintf(out, "// %s\n", reg->description); }
+        fprintf(out, "#define %s_%s_OFFSET 0x%XU\n", prefix, reg->name, reg->offset);
+        fprintf(out, "#define %s_%s_ADDR   (%s_BASE_ADDR + %s_%s_OFFSET)\n",
+                prefix, reg->name, prefix, prefix, reg->name);
+        if (reg->hasReset)
+        {
+            fprintf(out, "#define %s_%s_RESET  0x%XU\n", prefix, reg->name, reg->reset);
+        }
+        for (int j = 0; j < reg->numFields; j++)
+        {
+            const Field *field = &reg->fields[j];
+            uint32_t mask = (uint32_t)(((1ULL << field->bitWidth) - 1) << field->bitOffset);
+            fprintf(out, "#define %s_%s_%s_SHIFT %u\n", prefix, reg->name,
+                    field->name, field->bitOffset);
+            fprintf(out, "#define %s_%s_%s_MASK  0x%08XU\n", prefix, reg->name,
+                    field->name, mask);
+            for (int k = 0; k < field->numValues; k++)
+            {
+                fprintf(out, "#define %s_%s_%s_%s 0x%XU\n", prefix, reg->name,
+                        field->name, field->values[k].name, field->values[k].value);
+            }
+        }
+
+        if (reg->access != ACCESS_WRITE_ONLY)
+        {
+            fprintf(out, "static inline u32 %s_Read%s(void)\n{\n", prefix, function);
+            fprintf(out, "    return PERIPHERAL_REG_READ(%s_%s_ADDR);\n}\n",
+                    prefix, reg->name);
+        }
+        if (reg->access != ACCESS_READ_ONLY)
+        {
+            fprintf(out, "static inline void %s_Write%s(u32 value)\n{\n", prefix,
+                    function);
+            fprintf(out, "    PERIPHERAL_REG_WRITE(%s_%s_ADDR, value);\n}\n",
+                    prefix, reg->name);
+        }
+    }
+    fprintf(out, "\n");
+}
+
+/*
+ * This function writes the whole header.
+ *
+ * Return: None (void)
+ */
+static void writeHeader(FILE *out)
+{
+    fprintf(out,
+        "/*  peripheral_regs.h\n"
+        " *  Authors: Kyle Bielby, Christopher Lloyd\n"
+        " *  Description: Register map of the AXI slaves, generated by\n"
+        " *  host/regmap/regmap_gen from their IP-XACT component.xml files. Do not\n"
+        " *  edit; change the component.xml (or the address map in\n"
+        " *  host/regmap/Makefile) and run make -C host/regmap regs instead.\n"
+        " *\n"
+        " *  Addresses and field masks are compile-time constants and accessors are\n"
+        " *  static inline, so each access compiles to a single load or store.\n"
+        " *  Define PERIPHERAL_REG_READ and PERIPHERAL_REG_WRITE before including\n"
+        " *  this header to route the accesses elsewhere (e.g. a recorder).\n"
+        " */\n"
+        "\n"
+        "#ifndef PERIPHERAL_REGS_H\n"
+        "#define PERIPHERAL_REGS_H\n"
+        "\n"
+        "#include \"xil_types.h\"\n"
+        "#include \"xil_io.h\"\n"
+        "#ifndef HOST_BUILD\n"
+        "#include \"xparameters.h\"\n"
+        "#endif\n"
+        "\n"
+        "// Host builds go through the host backend's Xil_In32/Xil_Out32\n"
+        "#ifndef PERIPHERAL_REG_READ\n"
+        "#ifdef HOST_BUILD\n"
+        "#define PERIPHERAL_REG_READ(address)         Xil_In32(address)\n"
+        "#define PERIPHERAL_REG_WRITE(address, value) Xil_Out32((address), (value))\n"
+        "#else\n"
+        "#define PERIPHERAL_REG_READ(address)         (*(volatile u32 *)(address))\n"
+        "#define PERIPHERAL_REG_WRITE(address, value) \\\n"
+        "    (*(volatile u32 *)(address) = (value))\n"
+        "#endif\n"
+        "#endif\n"
+        "\n");
+
+    for (int i = 0; i < numPeripherals; i++)
+    {
+        writePeripheral(out, &peripherals[i]);
+    }
+
+    fprintf(out, "#endif // PERIPHERAL_REGS_H\n");
+}
+
+int main(int argc, char *argv[])
+{
+    const char *outputPath = NULL;
+
+    int option;
+    while ((option = getopt(argc, argv, "o:")) != -1)
+    {
+        switch (option)
+        {
+            case 'o':
+                outputPath = optarg;
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-o header] component.xml instance "
+                        "base...\n", argv[0]);
+                return 1;
+        }
+    }
+    if ((optind == argc) || (((argc - optind) % 3) != 0) ||
+        (((argc - optind) / 3) > MAX_PERIPHERALS))
+    {
+        fprintf(stderr, "usage: %s [-o header] component.xml instance base...\n",
+                argv[0]);
+        return 1;
+    }
+
+    for (int arg = optind; arg < argc; arg += 3)
+    {
+        Peripheral *peripheral = &peripherals[numPeripherals++];
+        peripheral->path = argv[arg];
+        peripheral->instance = argv[arg + 1];
+
+        char *last;
+        unsigned long long baseAddr = strtoull(argv[arg + 2], &last, 0);
+        if ((*last != '\0') || (baseAddr > UINT32_MAX))
+        {
+            fail(peripheral, "bad base address");
+        }
+        peripheral->baseAddr = (uint32_t)baseAddr;
+
+        char *text = readFile(peripheral->path);
+        if (text == NULL) { fail(peripheral, "cannot read"); }
+        parseComponent(peripheral, text);
+        free(text);
+    }
+    for (int i = 0; i < numPeripherals; i++)
+    {
+        checkPeripheral(&peripherals[i]);
+    }
+
+    // Write to a temporary file so a failed run leaves the old header
+    FILE *out = stdout;
+    char temporaryPath[4096];
+    if (outputPath != NULL)
+    {
+        snprintf(temporaryPath, sizeof(temporaryPath), "%s.tmp", outputPath);
+        out = fopen(temporaryPath, "w");
+        if (out == NULL)
+        {
+            perror(temporaryPath);
+            return 1;
+        }
+    }
+    writeHeader(out);
+    if (outputPath != NULL)
+    {
+        if ((fclose(out) != 0) || (rename(temporaryPath, outputPath) != 0))
+        {
+            perror(outputPath);
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,517 @@
+/* -----------------------------------------------------------------------------
+ * Filename     : rolling_codes.c
+ * Author(s)    : Kyle Bielby, Chris Lloyd (Team 1)
+ * Class        : EE365 (Final Project)
+ * Target Board : Cora Z7-10 (host tools)
+ * Description  : Checks the rolling codes of Security_System.c (built with
+ *                USE_ROLLING_CODES) against the RFC 4226 HOTP and RFC 6238
+ *                TOTP (SHA-1) test vectors, and checks that the precomputed
+ *                window accepts no code before the time is set, then exactly
+ *                the codes of the steps around now as the clock moves on,
+ *                jumps and is set back. The secrets and the first time are
+ *                set with the UART commands. Exits with status 1 on the
+ *                first failed check.
+ *
+ *                With -b it instead times a MODE_1_CHECK_CODE check against
+ *                computing every code in the window on each attempt, and the
+ *                per step update of the window.
+ *
+ *                  rolling_codes [-b checks]
+ * -------------------------------------------------------------------------- */
+
+// Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "xil_io.h"
+#include "xtime_l.h"
+#include "host_platform.h"
+
+// Rolling code parameters (same as Security_System.c)
+#define NUM_ROLLING_CODE_ACCOUNTS  2
+#define ROLLING_CODE_STEP_S        30
+#define ROLLING_CODE_WINDOW        1
+#define ROLLING_CODE_MODULUS       10000
+#define PASSCODE_LENGTH            4
+#define MODE_1_CHECK_CODE          0x1
+
+#define NUM_CODES        10000   // Every 4 digit code
+#define CLOCK_MOVES      500
+#define DEFAULT_CHECKS   1000000
+#define STEP_UPDATES     10000
+
+// Rolling code functions and state of Security_System.c
+typedef struct
+{
+    uint32_t inner[5];
+    uint32_t outer[5];
+} HMACKey;
+void prepareHMACKey(const uint8_t key[], uint8_t keyLength, HMACKey *hmacKey);
+uint32_t computeHOTP(const HMACKey *hmacKey, uint64_t counter);
+void setRollingCodeTime(uint64_t unixTime);
+uint64_t getRollingCodeStep();
+void serviceRollingCodes();
+bool isRollingCode(uint8_t passcode[]);
+bool handlePasscode(uint8_t mode, uint8_t passcode[]);
+void handleConsoleLine(uint8_t command, const char line[]);
+
+// Secrets of the accounts, as they would be provisioned over UART
+static const char *ACCOUNT_SECRETS[NUM_ROLLING_CODE_ACCOUNTS] = {
+    "maintenance-secret-1",
+    "cleaning-crew-secret"
+};
+
+// Secret of the RFC 4226 and RFC 6238 (SHA-1) test vectors
+static const char RFC_SECRET[] = "12345678901234567890";
+
+// RFC 4226 Appendix D: 6 digit HOTP values of counters 0-9
+static const uint32_t HOTP_VECTORS[10] = {
+    755224, 287082, 359152, 969429, 338314,
+    254676, 287922, 162583, 399871, 520489
+};
+
+// RFC 6238 Appendix B: 8 digit TOTP (SHA-1) values at Unix times
+static const struct
+{
+    uint64_t unixTime;
+    uint32_t code;
+} TOTP_VECTORS[] = {
+    {59, 94287082},
+    {1111111109, 7081804},
+    {1111111111, 14050471},
+    {1234567890, 89005924},
+    {2000000000, 69279037},
+    {20000000000ULL, 65353130}
+};
+#define NUM_TOTP_VECTORS (sizeof(TOTP_VECTORS) / sizeof(TOTP_VECTORS[0]))
+
+static HMACKey accountKeys[NUM_ROLLING_CODE_ACCOUNTS];
+static XTime hostTime;   // Target time (microseconds since boot)
+static uint64_t randomState = 0x9E3779B97F4A7C15ULL;
+
+// No peripherals are used: the checks call the firmware functions directly
+u32 Xil_In32(UINTPTR Addr)
+{
+    (void)Addr;
+    return 0;
+}
+
+void Xil_Out32(UINTPTR Addr, u32 Value)
+{
+    (void)Addr;
+    (void)Value;
+}
+
+void hostDelayMS(uint16_t ms)
+{
+    hostTime += (XTime)ms * 1000;
+}
+
+bool hostWaitForInput(uint32_t timeoutMS)
+{
+    (void)timeoutMS;
+    return true;
+}
+
+int hostReadConsoleCommand(void)
+{
+    return -1;
+}
+
+void XTime_GetTime(XTime *Xtime_Global)
+{
+    *Xtime_Global = hostTime;
+}
+
+/*
+ * This function gets a monotonic time in nanoseconds.
+ *
+ * Return: (uint64_t): Nanoseconds.
+ */
+static uint64_t getTimeNS()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000000ULL) + now.tv_nsec;
+}
+
+/*
+ * This function steps a xorshift64 generator.
+ *
+ * Return: (uint64_t): Next pseudo random number.
+ */
+static uint64_t nextRandom()
+{
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 7;
+    randomState ^= randomState << 17;
+    return randomState;
+}
+
+/*
+ * This function splits a 4 digit code into the digits of a passcode.
+ *
+ * Return: None (void)
+ */
+static void toPasscode(uint32_t code, uint8_t passcode[])
+{
+    for (int digit = PASSCODE_LENGTH - 1; digit >= 0; digit--)
+    {
+        passcode[digit] = code % 10;
+        code /= 10;
+    }
+}
+
+/*
+ * This function checks a code the slow way: it computes the code of every
+ * account for every step in the window around now, as a check without the
+ * precomputed table would.
+ *
+ * Return: (bool): code is valid now?
+ */
+static bool isWindowCode(uint32_t code)
+{
+    uint64_t step = getRollingCodeStep();
+    for (int offset = -ROLLING_CODE_WINDOW; offset <= ROLLING_CODE_WINDOW; offset++)
+    {
+        for (int account = 0; account < NUM_ROLLING_CODE_ACCOUNTS; account++)
+        {
+            if ((computeHOTP(&accountKeys[account], step + offset) %
+                 ROLLING_CODE_MODULUS) == code)
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/*
+ * This function checks the HOTP and TOTP values against the RFC vectors.
+ *
+ * Return: (bool): Every vector matched?
+ */
+static bool checkVectors()
+{
+    HMACKey key;
+    prepareHMACKey((const uint8_t *)RFC_SECRET, strlen(RFC_SECRET), &key);
+
+    for (uint64_t counter = 0; counter < 10; counter++)
+    {
+        uint32_t value = computeHOTP(&key, counter) % 1000000;
+        if (value != HOTP_VECTORS[counter])
+        {
+            printf("FAIL: HOTP counter %lu: %06u, expected %06u\n",
+                   (unsigned long)counter, value, HOTP_VECTORS[counter]);
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < NUM_TOTP_VECTORS; i++)
+    {
+        uint64_t step = TOTP_VECTORS[i].unixTime / ROLLING_CODE_STEP_S;
+        uint32_t value = computeHOTP(&key, step) % 100000000;
+        if (value != TOTP_VECTORS[i].code)
+        {
+            printf("FAIL: TOTP at %llu: %08u, expected %08u\n",
+                   (unsigned long long)TOTP_VECTORS[i].unixTime, value,
+                   TOTP_VECTORS[i].code);
+            return false;
+        }
+    }
+
+    printf("ok: %d HOTP and %zu TOTP vectors\n", 10, NUM_TOTP_VECTORS);
+    return true;
+}
+
+/*
+ * This function sets the secret of each account with the 'S' command, and
+ * prepares the same keys for the slow checks.
+ *
+ * Return: None (void)
+ */
+static void provisionAccounts()
+{
+    for (int account = 0; account < NUM_ROLLING_CODE_ACCOUNTS; account++)
+    {
+        const char *secret = ACCOUNT_SECRETS[account];
+        char line[64];
+        int length = snprintf(line, sizeof(line), "%d ", account);
+        for (size_t i = 0; secret[i] != '\0'; i++)
+        {
+            length += snprintf(&line[length], sizeof(line) - length, "%02x",
+                               (uint8_t)secret[i]);
+        }
+        handleConsoleLine('S', line);
+
+        prepareHMACKey((const uint8_t *)secret, strlen(secret),
+                       &accountKeys[account]);
+    }
+}
+
+/*
+ * This function checks that no code is accepted before the time is set, and
+ * that the window is filled once the 'T' command sets it.
+ *
+ * Return: (bool): No code accepted before, the window accepted after?
+ */
+static bool checkUnsetTime()
+{
+    serviceRollingCodes();
+    for (uint32_t code = 0; code < NUM_CODES; code++)
+    {
+        uint8_t passcode[PASSCODE_LENGTH];
+        toPasscode(code, passcode);
+        // (0000 is the master passcode, which MODE_1_CHECK_CODE accepts)
+        if (isRollingCode(passcode) ||
+            ((code != 0) && handlePasscode(MODE_1_CHECK_CODE, passcode)))
+        {
+            printf("FAIL: code %04u accepted before the time was set\n", code);
+            return false;
+        }
+    }
+
+    char line[32];
+    snprintf(line, sizeof(line), "%llu",
+             (unsigned long long)TOTP_VECTORS[3].unixTime);
+    handleConsoleLine('T', line);
+    serviceRollingCodes();
+    for (uint32_t code = 0; code < NUM_CODES; code++)
+    {
+        uint8_t passcode[PASSCODE_LENGTH];
+        toPasscode(code, passcode);
+        if (isRollingCode(passcode) != isWindowCode(code))
+        {
+            printf("FAIL: code %04u %s after the time was set\n", code,
+                   isWindowCode(code) ? "rejected" : "accepted");
+            return false;
+        }
+    }
+
+    printf("ok: no code accepted until the time is set\n");
+    return true;
+}
+
+/*
+ * This function checks MODE_1_CHECK_CODE verdicts for the codes of each
+ * account from two steps before the window to two steps after it, at each
+ * RFC 6238 test time.
+ *
+ * Return: (bool): Every verdict matched?
+ */
+static bool checkWindowEdges()
+{
+    int numChecks = 0;
+    for (size_t i = 0; i < NUM_TOTP_VECTORS; i++)
+    {
+        setRollingCodeTime(TOTP_VECTORS[i].unixTime);
+        uint64_t step = getRollingCodeStep();
+
+        for (int offset = -(ROLLING_CODE_WINDOW + 2);
+             offset <= (ROLLING_CODE_WINDOW + 2); offset++)
+        {
+            for (int account = 0; account < NUM_ROLLING_CODE_ACCOUNTS; account++)
+            {
+                uint32_t code = computeHOTP(&accountKeys[account], step + offset) %
+                                ROLLING_CODE_MODULUS;
+                uint8_t passcode[PASSCODE_LENGTH];
+                toPasscode(code, passcode);
+
+                // (A code outside the window can equal one inside it)
+                bool expected = isWindowCode(code);
+                if ((abs(offset) <= ROLLING_CODE_WINDOW) && !expected)
+                {
+                    printf("FAIL: reference rejects its own window\n");
+                    return false;
+                }
+                if (handlePasscode(MODE_1_CHECK_CODE, passcode) != expected)
+                {
+                    printf("FAIL: at %llu account %d step %+d code %04u %s\n",
+                           (unsigned long long)TOTP_VECTORS[i].unixTime,
+                           account, offset, code,
+                           expected ? "rejected" : "accepted");
+                    return false;
+                }
+                numChecks++;
+            }
+        }
+    }
+
+    printf("ok: %d checks at the window edges\n", numChecks);
+    return true;
+}
+
+/*
+ * This function moves the clock on by random amounts (within a step, one
+ * step, several steps, and back) and compares the precomputed window with
+ * the slow check for every 4 digit code after each move.
+ *
+ * Return: (bool): The window matched after every move?
+ */
+static bool checkClockMoves()
+{
+    setRollingCodeTime(TOTP_VECTORS[1].unixTime);
+
+    for (int move = 0; move < CLOCK_MOVES; move++)
+    {
+        uint64_t kind = nextRandom() % 8;
+        if (kind < 4)
+        {
+            hostTime += (nextRandom() % (ROLLING_CODE_STEP_S * 1000000ULL));
+        }
+        else if (kind < 6)
+        {
+            hostTime += ROLLING_CODE_STEP_S * 1000000ULL;
+        }
+        else if (kind == 6)
+        {
+            hostTime += (nextRandom() % 10) * ROLLING_CODE_STEP_S * 1000000ULL;
+        }
+        else
+        {
+            // Set the clock back (by up to an hour)
+            uint64_t unixTime = TOTP_VECTORS[1].unixTime +
+                                (hostTime / 1000000) - (nextRandom() % 3600);
+            setRollingCodeTime(unixTime);
+        }
+        serviceRollingCodes();
+
+        // Codes valid now, the slow way
+        bool valid[NUM_CODES] = {false};
+        uint64_t step = getRollingCodeStep();
+        for (int offset = -ROLLING_CODE_WINDOW; offset <= ROLLING_CODE_WINDOW; offset++)
+        {
+            for (int account = 0; account < NUM_ROLLING_CODE_ACCOUNTS; account++)
+            {
+                valid[computeHOTP(&accountKeys[account], step + offset) %
+                      ROLLING_CODE_MODULUS] = true;
+            }
+        }
+
+        for (uint32_t code = 0; code < NUM_CODES; code++)
+        {
+            uint8_t passcode[PASSCODE_LENGTH];
+            toPasscode(code, passcode);
+            if (isRollingCode(passcode) != valid[code])
+            {
+                printf("FAIL: move %d (step %llu) code %04u %s\n", move,
+                       (unsigned long long)step, code,
+                       valid[code] ? "rejected" : "accepted");
+                return false;
+            }
+        }
+    }
+
+    printf("ok: window matches after %d clock moves\n", CLOCK_MOVES);
+    return true;
+}
+
+/*
+ * This function times checks of random codes with the precomputed window
+ * and with every code in the window computed per check, and the window
+ * updates.
+ *
+ * Return: None (void)
+ */
+static void runBenchmark(uint32_t numChecks)
+{
+    setRollingCodeTime(TOTP_VECTORS[3].unixTime);
+    serviceRollingCodes();
+
+    uint8_t (*passcodes)[PASSCODE_LENGTH] = malloc(numChecks * PASSCODE_LENGTH);
+    if (passcodes == NULL) { return; }
+    for (uint32_t i = 0; i < numChecks; i++)
+    {
+        toPasscode(nextRandom() % NUM_CODES, passcodes[i]);
+    }
+
+    volatile uint32_t accepted = 0;
+    uint64_t start = getTimeNS();
+    for (uint32_t i = 0; i < numChecks; i++)
+    {
+        accepted += isRollingCode(passcodes[i]);
+    }
+    double tableNS = (double)(getTimeNS() - start) / numChecks;
+
+    start = getTimeNS();
+    for (uint32_t i = 0; i < numChecks; i++)
+    {
+        accepted += handlePasscode(MODE_1_CHECK_CODE, passcodes[i]);
+    }
+    double checkNS = (double)(getTimeNS() - start) / numChecks;
+
+    uint32_t numSlowChecks = (numChecks < (DEFAULT_CHECKS / 10)) ?
+                             numChecks : (DEFAULT_CHECKS / 10);
+    start = getTimeNS();
+    for (uint32_t i = 0; i < numSlowChecks; i++)
+    {
+        uint32_t code = (passcodes[i][0] * 1000) + (passcodes[i][1] * 100) +
+                        (passcodes[i][2] * 10) + passcodes[i][3];
+        accepted += isWindowCode(code);
+    }
+    double hmacNS = (double)(getTimeNS() - start) / numSlowChecks;
+
+    start = getTimeNS();
+    for (int i = 0; i < STEP_UPDATES; i++)
+    {
+        hostTime += ROLLING_CODE_STEP_S * 1000000ULL;
+        serviceRollingCodes();
+    }
+    double stepNS = (double)(getTimeNS() - start) / STEP_UPDATES;
+
+    start = getTimeNS();
+    for (int i = 0; i < STEP_UPDATES; i++)
+    {
+        setRollingCodeTime(TOTP_VECTORS[3].unixTime);
+        serviceRollingCodes();
+    }
+    double rebuildNS = (double)(getTimeNS() - start) / STEP_UPDATES;
+
+    printf("%d accounts, window of %d steps\n", NUM_ROLLING_CODE_ACCOUNTS,
+           (2 * ROLLING_CODE_WINDOW) + 1);
+    printf("%-34s %10.1f ns\n", "table lookup (isRollingCode)", tableNS);
+    printf("%-34s %10.1f ns\n", "MODE_1_CHECK_CODE (handlePasscode)", checkNS);
+    printf("%-34s %10.1f ns\n", "HMAC of the window per check", hmacNS);
+    printf("%-34s %10.1f ns\n", "window update per step", stepNS);
+    printf("%-34s %10.1f ns\n", "window rebuild (time set)", rebuildNS);
+
+    free(passcodes);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t numChecks = 0;
+
+    int option;
+    while ((option = getopt(argc, argv, "b:")) != -1)
+    {
+        switch (option)
+        {
+            case 'b':
+                numChecks = (uint32_t)atol(optarg);
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-b checks]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    provisionAccounts();
+
+    if (numChecks > 0)
+    {
+        runBenchmark(numChecks);
+        return 0;
+    }
+
+    if (!checkVectors() || !checkUnsetTime() || !checkWindowEdges() ||
+        !checkClockMoves())
+    {
+        return 1;
+    }
+    return 0;
+}
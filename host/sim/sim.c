@@ -0,0 +1,379 @@
+/* -----------------------------------------------------------------------------
+ * Filename     : sim.c
+ * Author(s)    : Kyle Bielby, Chris Lloyd (Team 1)
+ * Class        : EE365 (Final Project)
+ * Target Board : Cora Z7-10 (host simulation)
+ * Description  : Runs Security_System.c on Linux against a software model of
+ *                the keypad, button, seven segment and LED peripherals.
+ *
+ *                Input is read from stdin one character at a time:
+ *                <> 0-9 : Press (and release) that keypad key
+ *                <> a-f : Press that keypad function key (A-F)
+ *                <> h, l: Press the H or L function key
+ *                <> m   : Press the mode button
+ *                <> r   : Press the reset button
+ *                <> t   : Dump the register trace (USE_REGISTER_TRACE)
+ *                <> p   : Print the profile (USE_PROFILER)
+ *                <> L   : Open a code set (USE_CODE_SET_LOAD). Everything up
+ *                         to and including the next C or X is sent to the
+ *                         firmware as UART input, not pressed.
+ *                Each press is held for INPUT_HOLD_MS, then released for at
+ *                least INPUT_GAP_MS before the next input. Display and LED
+ *                changes are printed to stdout. The program exits at the end
+ *                of input.
+ *
+ *                Binary UART output (USE_TELEMETRY) goes to a pseudo
+ *                terminal, opened on the first write. Its name is printed to
+ *                stderr and, if SIM_UART_LINK is set, symlinked there for
+ *                host/telemetry/telemetry_decode to open.
+ *
+ *                Target time is host time. When the firmware goes idle it
+ *                blocks in poll() on stdin (the host equivalent of WFI) until
+ *                input arrives or its timeout passes.
+ *
+ * -------------------------------------------------------------------------- */
+
+// Includes
+#define _GNU_SOURCE  // posix_openpt, cfmakeraw
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <poll.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <termios.h>
+#include "xil_io.h"
+#include "xtime_l.h"
+#include "host_platform.h"
+#include "peripheral_regs.h"
+
+// Peripheral addresses and register offsets (same map as Security_System.c)
+#define KEYPAD_BASE_ADDR        KEYPAD_BINARY_SLAVE_BASE_ADDR
+#define ONBOARD_PUSH_BASE_ADDR  AXILAB_SLAVE_BUTTON_BASE_ADDR
+#define SEVEN_SEGMENT_BASE_ADDR SEVEN_SEGMENT_DISPLAY_SLAVE_BASE_ADDR
+#define RGB_LEDS_BASE_ADDR      AXILAB_SLAVE_LED_BASE_ADDR
+#define REGISTER_OFFSET_MASK    0xF
+
+// Keypad slave clock the key age is counted in (FCLK_CLK0)
+#define KEYPAD_CLOCK_MHZ 100
+
+// Button masks
+#define MODE_BUTTON_MASK  AXILAB_SLAVE_BUTTON_BUTTONS_BUTTON_0_MASK
+#define RESET_BUTTON_MASK AXILAB_SLAVE_BUTTON_BUTTONS_BUTTON_1_MASK
+
+#define INPUT_HOLD_MS 100
+#define INPUT_GAP_MS  50   // Released time between one input and the next
+#define NO_KEY        -1
+#define NO_COMMAND    -1
+
+// Firmware entry point (Security_System.c main, renamed by the Makefile)
+int securitySystemMain(void);
+
+// Keypad matrix position of hex keys 0-F and the H and L keys (see
+// keypad_driver.vhd)
+static const int HEX_KEYS[16] = {16, 4, 5, 6, 8, 9, 10, 12, 13, 14,
+                                 0, 1, 2, 3, 7, 11};
+#define H_KEY 18
+#define L_KEY 19
+
+// Peripheral model state
+static int heldKey = NO_KEY;
+static u32 keyValue = 0xF;   // Last hex key pressed (kept through H and L)
+static u32 heldButtons;
+static XTime releaseTime;
+static XTime keyChangeTime;
+static u32 keypadScanDivider = 127;
+static u32 displayData = 0xFFFFFFFF;
+static u32 ledData = 0xFFFFFFFF;
+static int consoleCommand = NO_COMMAND;
+// Characters ending the UART input of the open command, NULL when none is
+// open (a code set ends with 'C' or 'X', a line of arguments with '\n')
+static const char *consoleInputEnd;
+
+// UART pseudo terminal (both ends, see openUART())
+static int uartMaster = -1;
+static int uartSlave = -1;
+static const char *uartLink;
+
+/*
+ * This function gets the host time in microseconds.
+ *
+ * Return: (XTime): Monotonic time in microseconds.
+ */
+static XTime getTimeUS()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((XTime)now.tv_sec * 1000000) + (now.tv_nsec / 1000);
+}
+
+/*
+ * This function releases a held input once INPUT_HOLD_MS has passed and, when
+ * nothing is held, presses the next input from stdin if one is waiting.
+ *
+ * Return: (bool): A key or button is being held?
+ */
+static bool updateInputs()
+{
+    if (((heldKey != NO_KEY) || heldButtons) && (getTimeUS() >= releaseTime))
+    {
+        if (heldKey != NO_KEY) { keyChangeTime = releaseTime; }
+        heldKey = NO_KEY;
+        heldButtons = 0;
+    }
+
+    struct pollfd input = {STDIN_FILENO, POLLIN, 0};
+    while ((heldKey == NO_KEY) && !heldButtons &&
+           (consoleCommand == NO_COMMAND) &&
+           (getTimeUS() >= (releaseTime + (INPUT_GAP_MS * 1000))) &&
+           (poll(&input, 1, 0) > 0))
+    {
+        char c;
+        if (read(STDIN_FILENO, &c, 1) != 1)
+        {
+            printf("sim: end of input\n");
+            exit(0);
+        }
+
+        if (consoleInputEnd)
+        {
+            // Arguments are UART input, one character per firmware read
+            if (strchr(consoleInputEnd, c)) { consoleInputEnd = NULL; }
+            consoleCommand = c;
+            break;
+        }
+        else if ((c == 'L') || (c == 'Z') || (c == 'R') || (c == 'G') ||
+                 (c == 'T') || (c == 'S'))
+        {
+            consoleInputEnd = (c == 'L') ? "CX" : "\n";
+            consoleCommand = c;
+            break;
+        }
+        else if (((c >= '0') && (c <= '9')) || ((c >= 'a') && (c <= 'f')))
+        {
+            keyValue = (c <= '9') ? (c - '0') : (c - 'a' + 0xA);
+            heldKey = HEX_KEYS[keyValue];
+            keyChangeTime = getTimeUS();
+        }
+        else if ((c == 'h') || (c == 'l'))
+        {
+            heldKey = (c == 'h') ? H_KEY : L_KEY;
+            keyChangeTime = getTimeUS();
+        }
+        else if (c == 'm')
+        {
+            heldButtons = MODE_BUTTON_MASK;
+        }
+        else if (c == 'r')
+        {
+            heldButtons = RESET_BUTTON_MASK;
+        }
+        else if ((c == 't') || (c == 'p'))
+        {
+            // Let the firmware see the command before reading further
+            consoleCommand = c;
+            break;
+        }
+        releaseTime = getTimeUS() + (INPUT_HOLD_MS * 1000);
+    }
+
+    return ((heldKey != NO_KEY) || heldButtons);
+}
+
+/*
+ * This function removes the SIM_UART_LINK symlink at exit.
+ *
+ * Return: None (void)
+ */
+static void removeUARTLink()
+{
+    unlink(uartLink);
+}
+
+/*
+ * This function opens the pseudo terminal standing in for the UART. The sim
+ * keeps the slave end open in raw mode, so output written before a reader
+ * opens it is kept (up to the pty buffer) and is not altered by the line
+ * discipline.
+ *
+ * Return: (bool): Pseudo terminal opened?
+ */
+static bool openUART()
+{
+    uartMaster = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if ((uartMaster < 0) || (grantpt(uartMaster) != 0) ||
+        (unlockpt(uartMaster) != 0))
+    {
+        perror("sim: posix_openpt");
+        return false;
+    }
+
+    const char *name = ptsname(uartMaster);
+    uartSlave = open(name, O_RDWR | O_NOCTTY);
+    struct termios settings;
+    if ((uartSlave < 0) || (tcgetattr(uartSlave, &settings) != 0))
+    {
+        perror(name);
+        return false;
+    }
+    cfmakeraw(&settings);
+    tcsetattr(uartSlave, TCSANOW, &settings);
+    fprintf(stderr, "sim: UART on %s\n", name);
+
+    uartLink = getenv("SIM_UART_LINK");
+    if (uartLink != NULL)
+    {
+        unlink(uartLink);
+        if (symlink(name, uartLink) == 0) { atexit(removeUARTLink); }
+    }
+    return true;
+}
+
+u32 Xil_In32(UINTPTR Addr)
+{
+    updateInputs();
+
+    UINTPTR offset = (Addr & REGISTER_OFFSET_MASK);
+    switch (Addr & ~REGISTER_OFFSET_MASK)
+    {
+        case KEYPAD_BASE_ADDR:
+            if (offset == KEYPAD_BINARY_SLAVE_KEY_OFFSET)
+            {
+                if (heldKey == NO_KEY) { return 0xF; }
+                if (heldKey == H_KEY)
+                {
+                    return (keyValue | KEYPAD_BINARY_SLAVE_KEY_H_MASK);
+                }
+                if (heldKey == L_KEY)
+                {
+                    return (keyValue | KEYPAD_BINARY_SLAVE_KEY_L_MASK);
+                }
+                return (keyValue | KEYPAD_BINARY_SLAVE_KEY_HEX_MASK);
+            }
+            if (offset == KEYPAD_BINARY_SLAVE_SCAN_DIVIDER_OFFSET)
+            {
+                return keypadScanDivider;
+            }
+            if (offset == KEYPAD_BINARY_SLAVE_KEY_STATE_OFFSET)
+            {
+                return ((heldKey == NO_KEY) ? 0 : (1u << heldKey));
+            }
+            if (offset == KEYPAD_BINARY_SLAVE_KEY_AGE_OFFSET)
+            {
+                return (u32)((getTimeUS() - keyChangeTime) * KEYPAD_CLOCK_MHZ);
+            }
+            return 0;
+        case ONBOARD_PUSH_BASE_ADDR:
+            return heldButtons;
+        case SEVEN_SEGMENT_BASE_ADDR:
+            return displayData;
+        case RGB_LEDS_BASE_ADDR:
+            return ledData;
+        default:
+            return 0;
+    }
+}
+
+void Xil_Out32(UINTPTR Addr, u32 Value)
+{
+    switch (Addr & ~REGISTER_OFFSET_MASK)
+    {
+        case KEYPAD_BASE_ADDR:
+            if ((Addr & REGISTER_OFFSET_MASK) == KEYPAD_BINARY_SLAVE_SCAN_DIVIDER_OFFSET)
+            {
+                keypadScanDivider = Value;
+            }
+            break;
+        case SEVEN_SEGMENT_BASE_ADDR:
+            if (Value != displayData)
+            {
+                printf("display: ");
+                for (int shift = 12; shift >= 0; shift -= 4)
+                {
+                    u32 digit = ((Value >> shift) & 0xF);
+                    putchar((digit == 0xF) ? '_' : "0123456789ABCDE"[digit]);
+                }
+                putchar('\n');
+                fflush(stdout);
+            }
+            displayData = Value;
+            break;
+        case RGB_LEDS_BASE_ADDR:
+            if (Value != ledData)
+            {
+                printf("leds: 0x%02x\n", (unsigned)Value);
+                fflush(stdout);
+            }
+            ledData = Value;
+            break;
+        default:
+            break;
+    }
+}
+
+void hostDelayMS(uint16_t ms)
+{
+    struct timespec delay = {ms / 1000, (ms % 1000) * 1000000L};
+    nanosleep(&delay, NULL);
+}
+
+size_t hostWriteUART(const uint8_t data[], size_t size)
+{
+    static bool uartFailed;
+    if ((uartMaster < 0) && !uartFailed && !openUART()) { uartFailed = true; }
+    if (uartFailed) { return size; }  // Discard
+
+    // A full pty buffer (nobody reading) accepts nothing
+    ssize_t written = write(uartMaster, data, size);
+    return (written > 0) ? written : 0;
+}
+
+bool hostWaitForInput(uint32_t timeoutMS)
+{
+    XTime deadline = getTimeUS() + ((XTime)timeoutMS * 1000);
+    struct pollfd input = {STDIN_FILENO, POLLIN, 0};
+
+    while (!updateInputs() && (consoleCommand == NO_COMMAND))
+    {
+        // Block until stdin is readable or the timeout passes
+        XTime now = getTimeUS();
+        int waitMS = -1;
+        if (timeoutMS != 0)
+        {
+            if (now >= deadline) { return false; }
+            waitMS = (int)((deadline - now + 999) / 1000);
+        }
+
+        // Stdin is not read until the gap after the last input has passed
+        XTime nextInputTime = releaseTime + (INPUT_GAP_MS * 1000);
+        if (now < nextInputTime)
+        {
+            int gapMS = (int)((nextInputTime - now + 999) / 1000);
+            if ((waitMS == -1) || (gapMS < waitMS)) { waitMS = gapMS; }
+            poll(NULL, 0, waitMS);
+            continue;
+        }
+        poll(&input, 1, waitMS);
+    }
+    return true;
+}
+
+int hostReadConsoleCommand(void)
+{
+    int command = consoleCommand;
+    consoleCommand = NO_COMMAND;
+    return command;
+}
+
+void XTime_GetTime(XTime *Xtime_Global)
+{
+    *Xtime_Global = getTimeUS();
+}
+
+int main(void)
+{
+    fprintf(stderr, "sim: keys 0-9, a-f, h, l, m (mode button), r (reset button)\n");
+    return securitySystemMain();
+}
@@ -0,0 +1,354 @@
+/* -----------------------------------------------------------------------------
+ * Filename     : telemetry_decode.c
+ * Author(s)    : Kyle Bielby, Chris Lloyd (Team 1)
+ * Class        : EE365 (Final Project)
+ * Target Board : Cora Z7-10 (host tools)
+ * Description  : Decodes the binary telemetry frames (see telemetry.h) sent
+ *                by Security_System.c (USE_TELEMETRY) over UART. Frames are
+ *                printed as they arrive and status frames can also be written
+ *                to a CSV file.
+ *
+ *                  telemetry_decode [-b BAUD] [-c CSV] [-q] SOURCE
+ *
+ *                SOURCE is a serial port (e.g. /dev/ttyUSB1), the pty of
+ *                host/sim, a capture file or - for stdin. Serial ports are
+ *                set to raw mode at BAUD (115200 by default). Decoding stops
+ *                at the end of the input.
+ * -------------------------------------------------------------------------- */
+
+// Includes
+#define _GNU_SOURCE  // cfmakeraw, cfsetspeed
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <termios.h>
+#include "telemetry.h"
+
+static const char *OPERATION_NAMES[TELEMETRY_NUM_OPERATIONS] = {
+    "check", "store", "remove", "store_temp"
+};
+
+// Frame parser state
+typedef enum
+{
+    WAIT_SYNC_0,
+    WAIT_SYNC_1,
+    READ_TYPE,
+    READ_LENGTH,
+    READ_PAYLOAD,
+    READ_CRC_LOW,
+    READ_CRC_HIGH
+} ParserState;
+
+typedef struct
+{
+    ParserState state;
+    uint8_t type;
+    uint8_t length;
+    uint8_t payload[TELEMETRY_MAX_PAYLOAD];
+    uint8_t received;
+    uint16_t crc;
+    uint16_t frameCRC;
+
+    // Statistics
+    uint32_t frames;
+    uint32_t crcErrors;
+    uint32_t skippedBytes;
+} FrameParser;
+
+// Output options
+static FILE *csvFile;
+static bool quiet;
+
+static uint16_t getU16(const uint8_t *bytes)
+{
+    return bytes[0] | (bytes[1] << 8);
+}
+
+static uint32_t getU32(const uint8_t *bytes)
+{
+    return getU16(bytes) | ((uint32_t)getU16(bytes + 2) << 16);
+}
+
+/*
+ * This function writes the CSV header row.
+ *
+ * Return: None (void)
+ */
+static void writeCSVHeader()
+{
+    fprintf(csvFile, "sequence,time_ms,loops_per_s,key_presses,mode,"
+                     "stored,capacity");
+    for (int i = 0; i < TELEMETRY_NUM_OPERATIONS; i++)
+    {
+        fprintf(csvFile, ",%s_accepted,%s_rejected", OPERATION_NAMES[i],
+                OPERATION_NAMES[i]);
+    }
+    fprintf(csvFile, ",expired,dropped_frames\n");
+}
+
+/*
+ * This function prints a status frame and adds it to the CSV file.
+ *
+ * Return: None (void)
+ */
+static void handleStatus(const uint8_t *payload, uint8_t length)
+{
+    if (length < TELEMETRY_STATUS_SIZE)
+    {
+        fprintf(stderr, "telemetry: short status frame (%u bytes)\n", length);
+        return;
+    }
+
+    uint16_t sequence = getU16(payload);
+    uint32_t timeMS = getU32(payload + 2);
+    uint32_t loopsPerSecond = getU32(payload + 6);
+    uint32_t keyPresses = getU32(payload + 10);
+    uint8_t mode = payload[14];
+    uint8_t stored = payload[15];
+    uint8_t capacity = payload[16];
+    const uint8_t *verdicts = payload + 17;
+    const uint8_t *tail = verdicts + (4 * TELEMETRY_NUM_OPERATIONS);
+    uint16_t expired = getU16(tail);
+    uint16_t dropped = getU16(tail + 2);
+
+    if (!quiet)
+    {
+        printf("%10.3f s  status #%u  mode %u  %u loops/s  %u keys  "
+               "stored %u/%u ", timeMS / 1000.0, sequence, mode, loopsPerSecond,
+               keyPresses, stored, capacity);
+        for (int i = 0; i < TELEMETRY_NUM_OPERATIONS; i++)
+        {
+            printf(" %s %u/%u", OPERATION_NAMES[i], getU16(verdicts + (4 * i)),
+                   getU16(verdicts + (4 * i) + 2));
+        }
+        printf("  expired %u  dropped %u\n", expired, dropped);
+        fflush(stdout);
+    }
+
+    if (csvFile != NULL)
+    {
+        fprintf(csvFile, "%u,%u,%u,%u,%u,%u,%u", sequence, timeMS,
+                loopsPerSecond, keyPresses, mode, stored, capacity);
+        for (int i = 0; i < (2 * TELEMETRY_NUM_OPERATIONS); i++)
+        {
+            fprintf(csvFile, ",%u", getU16(verdicts + (2 * i)));
+        }
+        fprintf(csvFile, ",%u,%u\n", expired, dropped);
+        fflush(csvFile);
+    }
+}
+
+/*
+ * This function prints a verdict frame.
+ *
+ * Return: None (void)
+ */
+static void handleVerdict(const uint8_t *payload, uint8_t length)
+{
+    if (length < TELEMETRY_VERDICT_SIZE)
+    {
+        fprintf(stderr, "telemetry: short verdict frame (%u bytes)\n", length);
+        return;
+    }
+    if (quiet) { return; }
+
+    uint8_t operation = payload[4];
+    printf("%10.3f s  verdict %s %s  stored %u\n", getU32(payload) / 1000.0,
+           (operation < TELEMETRY_NUM_OPERATIONS) ? OPERATION_NAMES[operation] :
+                                                    "unknown",
+           payload[5] ? "accepted" : "rejected", payload[6]);
+    fflush(stdout);
+}
+
+/*
+ * This function feeds one received byte to the frame parser and handles the
+ * frame it completes. Bytes outside frames (e.g. printed text) are skipped.
+ *
+ * Return: None (void)
+ */
+static void parseByte(FrameParser *parser, uint8_t byte)
+{
+    switch (parser->state)
+    {
+        case WAIT_SYNC_0:
+            if (byte == TELEMETRY_SYNC_0)
+            {
+                parser->state = WAIT_SYNC_1;
+            }
+            else
+            {
+                parser->skippedBytes++;
+            }
+            break;
+        case WAIT_SYNC_1:
+            if (byte == TELEMETRY_SYNC_1)
+            {
+                parser->state = READ_TYPE;
+            }
+            else
+            {
+                parser->skippedBytes++;
+                parser->state = (byte == TELEMETRY_SYNC_0) ? WAIT_SYNC_1 :
+                                                             WAIT_SYNC_0;
+            }
+            break;
+        case READ_TYPE:
+            parser->type = byte;
+            parser->crc = updateTelemetryCRC(TELEMETRY_CRC_INIT, byte);
+            parser->state = READ_LENGTH;
+            break;
+        case READ_LENGTH:
+            parser->length = byte;
+            parser->received = 0;
+            parser->crc = updateTelemetryCRC(parser->crc, byte);
+            parser->state = (byte > 0) ? READ_PAYLOAD : READ_CRC_LOW;
+            break;
+        case READ_PAYLOAD:
+            parser->payload[parser->received++] = byte;
+            parser->crc = updateTelemetryCRC(parser->crc, byte);
+            if (parser->received == parser->length)
+            {
+                parser->state = READ_CRC_LOW;
+            }
+            break;
+        case READ_CRC_LOW:
+            parser->frameCRC = byte;
+            parser->state = READ_CRC_HIGH;
+            break;
+        case READ_CRC_HIGH:
+            parser->frameCRC |= (byte << 8);
+            parser->state = WAIT_SYNC_0;
+            if (parser->frameCRC != parser->crc)
+            {
+                parser->crcErrors++;
+                break;
+            }
+
+            parser->frames++;
+            if (parser->type == TELEMETRY_FRAME_STATUS)
+            {
+                handleStatus(parser->payload, parser->length);
+            }
+            else if (parser->type == TELEMETRY_FRAME_VERDICT)
+            {
+                handleVerdict(parser->payload, parser->length);
+            }
+            break;
+    }
+}
+
+/*
+ * This function opens the telemetry source, setting serial ports to raw mode
+ * at baud.
+ *
+ * Return: (int): File descriptor (-1 on error).
+ */
+static int openSource(const char *path, speed_t baud)
+{
+    if (strcmp(path, "-") == 0) { return STDIN_FILENO; }
+
+    int fd = open(path, O_RDONLY | O_NOCTTY);
+    if (fd < 0)
+    {
+        perror(path);
+        return -1;
+    }
+
+    struct termios settings;
+    if (isatty(fd) && (tcgetattr(fd, &settings) == 0))
+    {
+        cfmakeraw(&settings);
+        cfsetspeed(&settings, baud);
+        settings.c_cflag |= (CLOCAL | CREAD);
+        tcsetattr(fd, TCSANOW, &settings);
+    }
+    return fd;
+}
+
+static speed_t getBaudRate(const char *text)
+{
+    switch (atoi(text))
+    {
+        case 9600:   return B9600;
+        case 19200:  return B19200;
+        case 38400:  return B38400;
+        case 57600:  return B57600;
+        case 115200: return B115200;
+        case 230400: return B230400;
+        case 460800: return B460800;
+        case 921600: return B921600;
+        default:     return 0;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    speed_t baud = B115200;
+    const char *csvPath = NULL;
+    int option;
+    while ((option = getopt(argc, argv, "b:c:q")) != -1)
+    {
+        switch (option)
+        {
+            case 'b':
+                baud = getBaudRate(optarg);
+                if (baud == 0)
+                {
+                    fprintf(stderr, "telemetry: unsupported baud rate %s\n",
+                            optarg);
+                    return 2;
+                }
+                break;
+            case 'c':
+                csvPath = optarg;
+                break;
+            case 'q':
+                quiet = true;
+                break;
+            default:
+                optind = argc + 1;
+                break;
+        }
+    }
+    if (optind != (argc - 1))
+    {
+        fprintf(stderr, "usage: %s [-b BAUD] [-c CSV] [-q] SOURCE\n", argv[0]);
+        return 2;
+    }
+
+    int fd = openSource(argv[optind], baud);
+    if (fd < 0) { return 1; }
+
+    if (csvPath != NULL)
+    {
+        csvFile = fopen(csvPath, "w");
+        if (csvFile == NULL)
+        {
+            perror(csvPath);
+            return 1;
+        }
+        writeCSVHeader();
+    }
+
+    // A pty read fails (EIO) once the sim closes it, which ends the input too
+    FrameParser parser = {0};
+    uint8_t buffer[256];
+    ssize_t count;
+    while ((count = read(fd, buffer, sizeof(buffer))) > 0)
+    {
+        for (ssize_t i = 0; i < count; i++)
+        {
+            parseByte(&parser, buffer[i]);
+        }
+    }
+
+    fprintf(stderr, "telemetry: %u frames, %u CRC errors, %u bytes skipped\n",
+            parser.frames, parser.crcErrors, parser.skippedBytes);
+    if (csvFile != NULL) { fclose(csvFile); }
+    return 0;
+}
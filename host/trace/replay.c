@@ -0,0 +1,146 @@
+/* -----------------------------------------------------------------------------
+ * Filename     : replay.c
+ * Author(s)    : Kyle Bielby, Chris Lloyd (Team 1)
+ * Class        : EE365 (Final Project)
+ * Target Board : Cora Z7-10 (host tools)
+ * Description  : Replays a register trace against a host build of
+ *                Security_System.c. Every register read returns the value
+ *                recorded for it and every write must match the recorded one,
+ *                so the firmware follows exactly the path it took when the
+ *                trace was recorded. The first access that does not match the
+ *                trace (register, direction or written value) is reported and
+ *                ends the replay with status 1.
+ *
+ *                  trace_replay TRACE
+ *
+ *                The trace must start at boot (first block sequence 0), i.e.
+ *                it was dumped before the trace ring wrapped.
+ * -------------------------------------------------------------------------- */
+
+// Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include "xil_io.h"
+#include "xtime_l.h"
+#include "host_platform.h"
+#include "register_trace.h"
+#include "trace_reader.h"
+
+// Address of the first peripheral (each peripheral has a 64 KB window)
+#define PERIPHERAL_BASE_ADDR 0x43c00000
+
+int securitySystemMain(void);
+
+static RegisterTrace trace;
+static size_t nextAccess;
+static uint64_t currentTime;   // Trace clock of the last replayed access
+
+/*
+ * This function ends the replay once every access in the trace matched.
+ *
+ * Return: None (does not return)
+ */
+static void finishReplay(void)
+{
+    printf("replay: all %zu accesses matched (%.6f s of firmware time)\n",
+           trace.numAccesses,
+           traceTicksToUS(&trace, currentTime - trace.startTime) / 1e6);
+    freeRegisterTrace(&trace);
+    exit(0);
+}
+
+/*
+ * This function checks an access of the firmware against the next access of
+ * the trace, ending the replay when they differ.
+ *
+ * Return: (const TraceAccess *): The matching trace access.
+ */
+static const TraceAccess *replayAccess(bool isWrite, UINTPTR address, u32 value)
+{
+    if (nextAccess == trace.numAccesses) { finishReplay(); }
+
+    const TraceAccess *expected = &trace.accesses[nextAccess];
+    uint8_t peripheral = REGISTER_TRACE_UNKNOWN;
+    if ((address >= PERIPHERAL_BASE_ADDR) &&
+        (address < (PERIPHERAL_BASE_ADDR +
+                    (REGISTER_TRACE_UNKNOWN << 16))))
+    {
+        peripheral = (address - PERIPHERAL_BASE_ADDR) >> 16;
+    }
+    uint8_t reg = (address >> 2) & REGISTER_TRACE_REGISTER_MASK;
+
+    if ((expected->isWrite != isWrite) ||
+        (expected->peripheral != peripheral) || (expected->reg != reg) ||
+        (isWrite && (expected->value != value)))
+    {
+        printf("replay: diverged at access %zu (%.1f us)\n", nextAccess,
+               traceTicksToUS(&trace, expected->time));
+        printf("  trace   : %c %s[%u] 0x%08x\n", expected->isWrite ? 'W' : 'R',
+               tracePeripheralName(expected->peripheral), expected->reg,
+               expected->value);
+        printf("  firmware: %c %s[%u]", isWrite ? 'W' : 'R',
+               tracePeripheralName(peripheral), reg);
+        if (isWrite) { printf(" 0x%08x", value); }
+        printf("\n");
+        freeRegisterTrace(&trace);
+        exit(1);
+    }
+
+    currentTime = trace.startTime + expected->time;
+    nextAccess++;
+    return expected;
+}
+
+u32 Xil_In32(UINTPTR Addr)
+{
+    return replayAccess(false, Addr, 0)->value;
+}
+
+void Xil_Out32(UINTPTR Addr, u32 Value)
+{
+    replayAccess(true, Addr, Value);
+}
+
+// Waiting takes no time: the clock follows the recorded accesses
+void hostDelayMS(uint16_t ms)
+{
+    (void)ms;
+}
+
+bool hostWaitForInput(uint32_t timeoutMS)
+{
+    (void)timeoutMS;
+    return true;
+}
+
+int hostReadConsoleCommand(void)
+{
+    return -1;
+}
+
+void XTime_GetTime(XTime *Xtime_Global)
+{
+    // The host firmware build counts COUNTS_PER_SECOND per second
+    *Xtime_Global = (currentTime * COUNTS_PER_SECOND) / trace.ticksPerSecond;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 2)
+    {
+        fprintf(stderr, "usage: %s TRACE\n", argv[0]);
+        return 2;
+    }
+    if (!readRegisterTrace(argv[1], &trace)) { return 1; }
+    if (trace.firstSequence != 0)
+    {
+        fprintf(stderr, "replay: trace starts at block %u, not at boot\n",
+                trace.firstSequence);
+        freeRegisterTrace(&trace);
+        return 1;
+    }
+
+    currentTime = trace.startTime;
+    securitySystemMain();
+    return 0;
+}
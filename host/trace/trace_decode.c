@@ -0,0 +1,348 @@
+/* -----------------------------------------------------------------------------
+ * Filename     : trace_decode.c
+ * Author(s)    : Kyle Bielby, Chris Lloyd (Team 1)
+ * Class        : EE365 (Final Project)
+ * Target Board : Cora Z7-10 (host tools)
+ * Description  : Prints a register trace recorded by Security_System.c
+ *                (USE_REGISTER_TRACE) as a timeline, per-register access
+ *                counts and rates, or the hot polling loops in it.
+ *
+ *                  trace_decode [summary|timeline|counts|loops] TRACE
+ *
+ *                TRACE is a raw binary trace or a UART log holding a dump.
+ * -------------------------------------------------------------------------- */
+
+// Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "register_trace.h"
+#include "trace_reader.h"
+
+// Longest repeating access sequence reported as a loop
+#define MAX_LOOP_LENGTH 16
+
+// Fewest iterations for a repeating sequence to count as a loop
+#define MIN_LOOP_ITERATIONS 3
+
+#define MAX_LOOP_PATTERNS 256
+#define NUM_HOT_LOOPS     10
+
+#define NUM_REGISTERS ((REGISTER_TRACE_PERIPHERAL_MASK + 1) * \
+                       (REGISTER_TRACE_REGISTER_MASK + 1))
+
+// A repeating access sequence and every run of it found in the trace
+typedef struct
+{
+    uint8_t signature[MAX_LOOP_LENGTH];
+    uint8_t length;
+    uint32_t runs;
+    uint64_t iterations;
+    uint64_t ticks;
+} LoopPattern;
+
+/*
+ * This function gets the signature of an access (the record header without
+ * the delta size), which identifies the register and direction.
+ *
+ * Return: (uint8_t): The access signature.
+ */
+static uint8_t getSignature(const TraceAccess *access)
+{
+    return (access->isWrite ? REGISTER_TRACE_WRITE_BIT : 0) |
+           (access->peripheral << REGISTER_TRACE_PERIPHERAL_SHIFT) |
+           (access->reg << REGISTER_TRACE_REGISTER_SHIFT);
+}
+
+static void printSignature(uint8_t signature)
+{
+    printf("%c %s[%u]", (signature & REGISTER_TRACE_WRITE_BIT) ? 'W' : 'R',
+           tracePeripheralName((signature >> REGISTER_TRACE_PERIPHERAL_SHIFT) &
+                               REGISTER_TRACE_PERIPHERAL_MASK),
+           (signature >> REGISTER_TRACE_REGISTER_SHIFT) &
+           REGISTER_TRACE_REGISTER_MASK);
+}
+
+static double getDurationS(const RegisterTrace *trace)
+{
+    if (trace->numAccesses == 0) { return 0; }
+    return traceTicksToUS(trace, trace->accesses[trace->numAccesses - 1].time) /
+           1e6;
+}
+
+/*
+ * This function prints every access with its time since the trace start and
+ * since the previous access.
+ *
+ * Return: None (void)
+ */
+static void printTimeline(const RegisterTrace *trace)
+{
+    printf("%14s %12s  access\n", "time (us)", "delta (us)");
+    uint64_t previousTime = 0;
+    for (size_t i = 0; i < trace->numAccesses; i++)
+    {
+        const TraceAccess *access = &trace->accesses[i];
+        printf("%14.1f %12.1f  ", traceTicksToUS(trace, access->time),
+               traceTicksToUS(trace, access->time - previousTime));
+        printSignature(getSignature(access));
+        printf(" %s 0x%08x\n", access->isWrite ? "<-" : "->", access->value);
+        previousTime = access->time;
+    }
+}
+
+/*
+ * This function prints the number of reads and writes of every register used
+ * and their rates over the trace.
+ *
+ * Return: None (void)
+ */
+static void printCounts(const RegisterTrace *trace)
+{
+    uint64_t reads[NUM_REGISTERS] = {0};
+    uint64_t writes[NUM_REGISTERS] = {0};
+    for (size_t i = 0; i < trace->numAccesses; i++)
+    {
+        const TraceAccess *access = &trace->accesses[i];
+        int index = (access->peripheral * (REGISTER_TRACE_REGISTER_MASK + 1)) +
+                    access->reg;
+        if (access->isWrite) { writes[index]++; } else { reads[index]++; }
+    }
+
+    double durationS = getDurationS(trace);
+    printf("%-18s %10s %10s %12s %12s\n", "register", "reads", "writes",
+           "reads/s", "writes/s");
+    for (int i = 0; i < NUM_REGISTERS; i++)
+    {
+        if ((reads[i] == 0) && (writes[i] == 0)) { continue; }
+
+        char name[32];
+        snprintf(name, sizeof(name), "%s[%d]",
+                 tracePeripheralName(i / (REGISTER_TRACE_REGISTER_MASK + 1)),
+                 i % (REGISTER_TRACE_REGISTER_MASK + 1));
+        printf("%-18s %10llu %10llu %12.1f %12.1f\n", name,
+               (unsigned long long)reads[i], (unsigned long long)writes[i],
+               (durationS > 0) ? (reads[i] / durationS) : 0,
+               (durationS > 0) ? (writes[i] / durationS) : 0);
+    }
+}
+
+/*
+ * This function rotates a loop signature to its smallest rotation, so a loop
+ * is grouped the same whichever access the run started on.
+ *
+ * Return: None (void)
+ */
+static void canonicalizeSignature(uint8_t signature[], uint8_t length)
+{
+    uint8_t best[MAX_LOOP_LENGTH];
+    memcpy(best, signature, length);
+    for (uint8_t shift = 1; shift < length; shift++)
+    {
+        uint8_t rotated[MAX_LOOP_LENGTH];
+        for (uint8_t i = 0; i < length; i++)
+        {
+            rotated[i] = signature[(i + shift) % length];
+        }
+        if (memcmp(rotated, best, length) < 0) { memcpy(best, rotated, length); }
+    }
+    memcpy(signature, best, length);
+}
+
+static bool matchesAt(const uint8_t *signatures, size_t a, size_t b,
+                      uint8_t length)
+{
+    return memcmp(&signatures[a], &signatures[b], length) == 0;
+}
+
+/*
+ * This function finds runs of a repeating access sequence (polling loops),
+ * groups them by sequence and prints the ones taking the most time.
+ *
+ * Return: None (void)
+ */
+static void printHotLoops(const RegisterTrace *trace)
+{
+    size_t count = trace->numAccesses;
+    uint8_t *signatures = malloc(count + 1);
+    for (size_t i = 0; i < count; i++)
+    {
+        signatures[i] = getSignature(&trace->accesses[i]);
+    }
+
+    LoopPattern *patterns = calloc(MAX_LOOP_PATTERNS, sizeof(LoopPattern));
+    int numPatterns = 0;
+
+    size_t i = 0;
+    while (i < count)
+    {
+        // Shortest sequence starting here that repeats back to back
+        uint8_t length = 0;
+        uint64_t iterations = 0;
+        for (uint8_t l = 1; (l <= MAX_LOOP_LENGTH) && ((i + (2 * l)) <= count);
+             l++)
+        {
+            if (!matchesAt(signatures, i, i + l, l)) { continue; }
+            uint64_t n = 2;
+            while (((i + ((n + 1) * l)) <= count) &&
+                   matchesAt(signatures, i, i + (n * l), l))
+            {
+                n++;
+            }
+            if (n >= MIN_LOOP_ITERATIONS)
+            {
+                length = l;
+                iterations = n;
+            }
+            break;
+        }
+        if (length == 0)
+        {
+            i++;
+            continue;
+        }
+
+        // Time from the first access of the run to the first after it
+        size_t end = i + (iterations * length);
+        uint64_t ticks = ((end < count) ? trace->accesses[end].time :
+                                          trace->accesses[end - 1].time) -
+                         trace->accesses[i].time;
+
+        uint8_t signature[MAX_LOOP_LENGTH];
+        memcpy(signature, &signatures[i], length);
+        canonicalizeSignature(signature, length);
+
+        int p;
+        for (p = 0; p < numPatterns; p++)
+        {
+            if ((patterns[p].length == length) &&
+                (memcmp(patterns[p].signature, signature, length) == 0))
+            {
+                break;
+            }
+        }
+        if ((p == numPatterns) && (numPatterns < MAX_LOOP_PATTERNS))
+        {
+            memcpy(patterns[p].signature, signature, length);
+            patterns[p].length = length;
+            numPatterns++;
+        }
+        if (p < numPatterns)
+        {
+            patterns[p].runs++;
+            patterns[p].iterations += iterations;
+            patterns[p].ticks += ticks;
+        }
+        i = end;
+    }
+
+    // Sort by time taken (few patterns, so selection order is fine)
+    for (int a = 0; a < numPatterns; a++)
+    {
+        for (int b = a + 1; b < numPatterns; b++)
+        {
+            if (patterns[b].ticks > patterns[a].ticks)
+            {
+                LoopPattern swap = patterns[a];
+                patterns[a] = patterns[b];
+                patterns[b] = swap;
+            }
+        }
+    }
+
+    double totalUS = traceTicksToUS(trace, count ?
+                                    trace->accesses[count - 1].time : 0);
+    printf("%4s %6s %10s %12s %7s %12s  accesses\n", "rank", "runs",
+           "iterations", "time (us)", "share", "period (us)");
+    for (int p = 0; (p < numPatterns) && (p < NUM_HOT_LOOPS); p++)
+    {
+        double us = traceTicksToUS(trace, patterns[p].ticks);
+        printf("%4d %6u %10llu %12.1f %6.1f%% %12.2f  ", p + 1, patterns[p].runs,
+               (unsigned long long)patterns[p].iterations, us,
+               (totalUS > 0) ? (100.0 * us / totalUS) : 0,
+               us / patterns[p].iterations);
+        for (uint8_t s = 0; s < patterns[p].length; s++)
+        {
+            if (s > 0) { printf(", "); }
+            printSignature(patterns[p].signature[s]);
+        }
+        printf("\n");
+    }
+    if (numPatterns == 0) { printf("(no loops found)\n"); }
+
+    free(patterns);
+    free(signatures);
+}
+
+/*
+ * This function prints the size and span of the trace.
+ *
+ * Return: None (void)
+ */
+static void printSummary(const RegisterTrace *trace)
+{
+    printf("blocks         : %u (first sequence %u%s)\n", trace->numBlocks,
+           trace->firstSequence,
+           (trace->firstSequence == 0) ? ", from boot" : "");
+    printf("accesses       : %zu\n", trace->numAccesses);
+    printf("encoded size   : %zu bytes (%.2f bytes/access with headers)\n",
+           trace->numBytes,
+           trace->numAccesses ? ((double)trace->numBytes / trace->numAccesses) :
+                                0);
+    printf("clock          : %u ticks/s\n", trace->ticksPerSecond);
+    printf("duration       : %.6f s\n", getDurationS(trace));
+}
+
+int main(int argc, char *argv[])
+{
+    const char *command = "summary";
+    const char *path;
+    if (argc == 3)
+    {
+        command = argv[1];
+        path = argv[2];
+    }
+    else if (argc == 2)
+    {
+        path = argv[1];
+    }
+    else
+    {
+        fprintf(stderr, "usage: %s [summary|timeline|counts|loops] TRACE\n",
+                argv[0]);
+        return 2;
+    }
+
+    RegisterTrace trace;
+    if (!readRegisterTrace(path, &trace)) { return 1; }
+
+    if (strcmp(command, "timeline") == 0)
+    {
+        printTimeline(&trace);
+    }
+    else if (strcmp(command, "counts") == 0)
+    {
+        printCounts(&trace);
+    }
+    else if (strcmp(command, "loops") == 0)
+    {
+        printHotLoops(&trace);
+    }
+    else if (strcmp(command, "summary") == 0)
+    {
+        printSummary(&trace);
+        printf("\n");
+        printCounts(&trace);
+        printf("\n");
+        printHotLoops(&trace);
+    }
+    else
+    {
+        fprintf(stderr, "unknown command '%s'\n", command);
+        freeRegisterTrace(&trace);
+        return 2;
+    }
+
+    freeRegisterTrace(&trace);
+    return 0;
+}
@@ -0,0 +1,251 @@
+/* -----------------------------------------------------------------------------
+ * Filename     : trace_reader.c
+ * Author(s)    : Kyle Bielby, Chris Lloyd (Team 1)
+ * Class        : EE365 (Final Project)
+ * Target Board : Cora Z7-10 (host tools)
+ * Description  : Decodes register traces recorded by Security_System.c.
+ * -------------------------------------------------------------------------- */
+
+// Includes
+#define _GNU_SOURCE  // memmem
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "register_trace.h"
+#include "trace_reader.h"
+
+static const char *PERIPHERAL_NAMES[] = {
+    "keypad", "button", "seven_segment", "led", "passcode_cam", "unknown",
+    "unknown", "unknown"
+};
+
+/*
+ * This function reads a whole file into memory.
+ *
+ * Return: (uint8_t *): File contents (NULL on error).
+ */
+static uint8_t *readFile(const char *path, size_t *size)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        perror(path);
+        return NULL;
+    }
+
+    size_t capacity = 65536;
+    uint8_t *data = malloc(capacity);
+    *size = 0;
+    size_t count;
+    while ((count = fread(data + *size, 1, capacity - *size, file)) > 0)
+    {
+        *size += count;
+        if (*size == capacity)
+        {
+            capacity *= 2;
+            data = realloc(data, capacity);
+        }
+    }
+    fclose(file);
+    return data;
+}
+
+/*
+ * This function replaces a text UART log with the binary contents of its last
+ * trace dump. Binary files are left as they are.
+ *
+ * Return: (bool): Data holds binary trace blocks?
+ */
+static bool extractTraceDump(uint8_t *data, size_t *size)
+{
+    // Find the last dump
+    const char *begin = NULL;
+    const char *search = (const char *)data;
+    const char *end = (const char *)data + *size;
+    while (search < end)
+    {
+        const char *found = memmem(search, end - search,
+                                   REGISTER_TRACE_DUMP_BEGIN,
+                                   strlen(REGISTER_TRACE_DUMP_BEGIN));
+        if (found == NULL) { break; }
+        begin = found;
+        search = found + 1;
+    }
+    if (begin == NULL) { return true; }
+
+    const char *dumpEnd = memmem(begin, end - begin, REGISTER_TRACE_DUMP_END,
+                                 strlen(REGISTER_TRACE_DUMP_END));
+    if (dumpEnd == NULL)
+    {
+        fprintf(stderr, "trace: dump is missing '%s'\n", REGISTER_TRACE_DUMP_END);
+        return false;
+    }
+
+    // Decode the hex digits in between (in place, output is shorter)
+    size_t numBytes = 0;
+    int high = -1;
+    for (const char *c = begin + strlen(REGISTER_TRACE_DUMP_BEGIN);
+         c < dumpEnd; c++)
+    {
+        if (!isxdigit((unsigned char)*c)) { continue; }
+        int nibble = isdigit((unsigned char)*c) ? (*c - '0') :
+                                                  (tolower(*c) - 'a' + 10);
+        if (high < 0)
+        {
+            high = nibble;
+        }
+        else
+        {
+            data[numBytes++] = (high << 4) | nibble;
+            high = -1;
+        }
+    }
+    *size = numBytes;
+    return true;
+}
+
+static uint64_t readLittleEndian(const uint8_t *bytes, int count)
+{
+    uint64_t value = 0;
+    for (int i = count - 1; i >= 0; i--)
+    {
+        value = (value << 8) | bytes[i];
+    }
+    return value;
+}
+
+/*
+ * This function reads a LEB128 varint.
+ *
+ * Return: (bool): Varint complete within the block?
+ */
+static bool readVarint(const uint8_t *block, size_t *position, uint64_t *value)
+{
+    *value = 0;
+    for (int shift = 0; (*position < REGISTER_TRACE_BLOCK_SIZE) && (shift < 64);
+         shift += 7)
+    {
+        uint8_t byte = block[(*position)++];
+        *value |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) { return true; }
+    }
+    return false;
+}
+
+bool readRegisterTrace(const char *path, RegisterTrace *trace)
+{
+    memset(trace, 0, sizeof(*trace));
+
+    size_t size;
+    uint8_t *data = readFile(path, &size);
+    if (data == NULL) { return false; }
+    if (!extractTraceDump(data, &size))
+    {
+        free(data);
+        return false;
+    }
+
+    size_t capacity = 1024;
+    trace->accesses = malloc(capacity * sizeof(TraceAccess));
+
+    for (size_t offset = 0; (offset + REGISTER_TRACE_BLOCK_SIZE) <= size;
+         offset += REGISTER_TRACE_BLOCK_SIZE)
+    {
+        const uint8_t *block = data + offset;
+        if (readLittleEndian(block, 2) != REGISTER_TRACE_MAGIC)
+        {
+            fprintf(stderr, "trace: bad block at byte %zu\n", offset);
+            continue;
+        }
+
+        uint32_t sequence = readLittleEndian(block + 2, 2);
+        uint64_t time = readLittleEndian(block + 8, 8);
+        if (trace->numBlocks == 0)
+        {
+            trace->firstSequence = sequence;
+            trace->ticksPerSecond = readLittleEndian(block + 4, 4);
+            trace->startTime = time;
+        }
+        trace->numBlocks++;
+        trace->numBytes += REGISTER_TRACE_BLOCK_SIZE;
+
+        // Decode records up to the padding
+        size_t position = REGISTER_TRACE_HEADER_SIZE;
+        while ((position < REGISTER_TRACE_BLOCK_SIZE) &&
+               (block[position] != REGISTER_TRACE_PADDING))
+        {
+            uint8_t header = block[position++];
+            uint64_t delta = 0;
+            uint64_t value;
+            bool complete = true;
+
+            switch (header & REGISTER_TRACE_DELTA_MASK)
+            {
+                case REGISTER_TRACE_DELTA_U8:
+                    delta = block[position++];
+                    break;
+                case REGISTER_TRACE_DELTA_U16:
+                    delta = readLittleEndian(block + position, 2);
+                    position += 2;
+                    break;
+                case REGISTER_TRACE_DELTA_VARINT:
+                    complete = readVarint(block, &position, &delta);
+                    break;
+                default:
+                    break;
+            }
+            complete = complete && (position < REGISTER_TRACE_BLOCK_SIZE) &&
+                       readVarint(block, &position, &value);
+            if (!complete)
+            {
+                fprintf(stderr, "trace: truncated record in block %u\n",
+                        sequence);
+                break;
+            }
+
+            if (trace->numAccesses == capacity)
+            {
+                capacity *= 2;
+                trace->accesses = realloc(trace->accesses,
+                                          capacity * sizeof(TraceAccess));
+            }
+            time += delta;
+            TraceAccess *access = &trace->accesses[trace->numAccesses++];
+            access->time = time - trace->startTime;
+            access->isWrite = (header & REGISTER_TRACE_WRITE_BIT) != 0;
+            access->peripheral = (header >> REGISTER_TRACE_PERIPHERAL_SHIFT) &
+                                 REGISTER_TRACE_PERIPHERAL_MASK;
+            access->reg = (header >> REGISTER_TRACE_REGISTER_SHIFT) &
+                          REGISTER_TRACE_REGISTER_MASK;
+            access->value = (uint32_t)value;
+        }
+    }
+    free(data);
+
+    if (trace->numBlocks == 0)
+    {
+        fprintf(stderr, "trace: no trace blocks in %s\n", path);
+        freeRegisterTrace(trace);
+        return false;
+    }
+    if (trace->ticksPerSecond == 0) { trace->ticksPerSecond = 1; }
+    return true;
+}
+
+void freeRegisterTrace(RegisterTrace *trace)
+{
+    free(trace->accesses);
+    trace->accesses = NULL;
+    trace->numAccesses = 0;
+}
+
+const char *tracePeripheralName(uint8_t peripheral)
+{
+    return PERIPHERAL_NAMES[peripheral & REGISTER_TRACE_PERIPHERAL_MASK];
+}
+
+double traceTicksToUS(const RegisterTrace *trace, uint64_t ticks)
+{
+    return (ticks * 1e6) / trace->ticksPerSecond;
+}
@@ -0,0 +1,65 @@
+/*  trace_reader.h
+ *  Authors: Kyle Bielby, Christopher Lloyd
+ *  Description: Reads a register trace (see register_trace.h) from a raw
+ *  binary file or from a UART log holding a trace dump.
+ */
+
+#ifndef TRACE_READER_H
+#define TRACE_READER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// One decoded register access
+typedef struct
+{
+    uint64_t time;        // Trace clock ticks since startTime
+    uint8_t peripheral;   // REGISTER_TRACE_KEYPAD, ...
+    uint8_t reg;          // Register number (offset / 4)
+    bool isWrite;
+    uint32_t value;
+} TraceAccess;
+
+// A decoded trace, oldest access first
+typedef struct
+{
+    TraceAccess *accesses;
+    size_t numAccesses;
+    size_t numBytes;          // Encoded size of the blocks read
+    uint32_t numBlocks;
+    uint32_t firstSequence;   // Sequence number of the oldest block
+    uint32_t ticksPerSecond;
+    uint64_t startTime;       // Trace clock at the start of the oldest block
+} RegisterTrace;
+
+/*
+ *  Reads the trace in path. When path holds text, the last dump between
+ *  REGISTER_TRACE_DUMP_BEGIN and REGISTER_TRACE_DUMP_END is read.
+ *
+ *  Returns: bool: Trace read (an error has been printed otherwise)?
+ */
+bool readRegisterTrace(const char *path, RegisterTrace *trace);
+
+/*
+ *  Frees the accesses of a trace.
+ *
+ *  Returns: void
+ */
+void freeRegisterTrace(RegisterTrace *trace);
+
+/*
+ *  Gets the name of a peripheral number.
+ *
+ *  Returns: const char *: Peripheral name.
+ */
+const char *tracePeripheralName(uint8_t peripheral);
+
+/*
+ *  Converts trace clock ticks to microseconds.
+ *
+ *  Returns: double: Microseconds.
+ */
+double traceTicksToUS(const RegisterTrace *trace, uint64_t ticks);
+
+#endif // TRACE_READER_H
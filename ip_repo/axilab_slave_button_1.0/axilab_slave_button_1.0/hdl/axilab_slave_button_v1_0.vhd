@@ -17,6 +17,7 @@ entity axilab_slave_button_v1_0 is
 	port (
 		-- Users to add ports here
         button : in std_logic_vector(1 downto 0);
+        button_irq : out std_logic;
 		-- User ports ends
 		-- Do not modify the ports beyond this line
 
@@ -115,6 +116,9 @@ axilab_slave_button_v1_0_S00_AXI_inst : axilab_slave_button_v1_0_S00_AXI
 
 	-- Add user logic here
 
+	-- Level interrupt while any button is held (wakes the processor from idle)
+	button_irq <= '0' when (button = "00") else '1';
+
 	-- User logic ends
 
 end arch_imp;
@@ -17,6 +17,11 @@ entity keypad_binary_slave_v1_0 is
 	port (
 		-- Users to add ports here
         s_keypad_binary : in std_logic_vector(3 downto 0);
+        s_keypad_key_state : in std_logic_vector(19 downto 0);
+        s_keypad_h_key : in std_logic;
+        s_keypad_l_key : in std_logic;
+        s_keypad_scan_divider : out std_logic_vector(6 downto 0);
+        keypad_irq : out std_logic;
 		-- User ports ends
 		-- Do not modify the ports beyond this line
 
@@ -56,6 +61,10 @@ architecture arch_imp of keypad_binary_slave_v1_0 is
 		);
 		port (
 		s_keypad_binary : in std_logic_vector(3 downto 0);
+		s_keypad_key_state : in std_logic_vector(19 downto 0);
+		s_keypad_h_key : in std_logic;
+		s_keypad_l_key : in std_logic;
+		s_keypad_scan_divider : out std_logic_vector(6 downto 0);
 		S_AXI_ACLK	: in std_logic;
 		S_AXI_ARESETN	: in std_logic;
 		S_AXI_AWADDR	: in std_logic_vector(C_S_AXI_ADDR_WIDTH-1 downto 0);
@@ -90,6 +99,10 @@ keypad_binary_slave_v1_0_S00_AXI_inst : keypad_binary_slave_v1_0_S00_AXI
 	)
 	port map (
 	    s_keypad_binary => s_keypad_binary,
+	    s_keypad_key_state => s_keypad_key_state,
+	    s_keypad_h_key => s_keypad_h_key,
+	    s_keypad_l_key => s_keypad_l_key,
+	    s_keypad_scan_divider => s_keypad_scan_divider,
 		S_AXI_ACLK	=> s00_axi_aclk,
 		S_AXI_ARESETN	=> s00_axi_aresetn,
 		S_AXI_AWADDR	=> s00_axi_awaddr,
@@ -115,6 +128,9 @@ keypad_binary_slave_v1_0_S00_AXI_inst : keypad_binary_slave_v1_0_S00_AXI
 
 	-- Add user logic here
 
+	-- Level interrupt while any key is held (wakes the processor from idle)
+	keypad_irq <= '0' when (unsigned(s_keypad_key_state) = 0) else '1';
+
 	-- User logic ends
 
 end arch_imp;
@@ -17,6 +17,10 @@ entity keypad_binary_slave_v1_0_S00_AXI is
 	port (
 		-- Users to add ports here
         s_keypad_binary : in std_logic_vector(3 downto 0);
+        s_keypad_key_state : in std_logic_vector(19 downto 0);
+        s_keypad_h_key : in std_logic;
+        s_keypad_l_key : in std_logic;
+        s_keypad_scan_divider : out std_logic_vector(6 downto 0);
 		-- User ports ends
 		-- Do not modify the ports beyond this line
 
@@ -118,6 +122,18 @@ architecture arch_imp of keypad_binary_slave_v1_0_S00_AXI is
 	signal byte_index	: integer;
 	signal aw_en	: std_logic;
 
+	-- Free-running S_AXI_ACLK cycle counter, its value at the last keypad
+	-- state change (press or release) and the state it changed from
+	signal key_cycle_counter  : unsigned(C_S_AXI_DATA_WIDTH-1 downto 0);
+	signal key_timestamp      : unsigned(C_S_AXI_DATA_WIDTH-1 downto 0);
+	signal key_state_previous : std_logic_vector(19 downto 0);
+
+	-- Keys with a hex value (0-9 and A-F, everything but rows 4-5 of column 4
+	-- and row 5 of columns 2-3). Only while one of them is held does the key
+	-- value name the key; 0xF alone is also the F key.
+	constant HEX_KEYS         : std_logic_vector(19 downto 0) := x"17FFF";
+	signal hex_key_pressed    : std_logic;
+
 begin
 	-- I/O Connections assignments
 
@@ -129,164 +145,130 @@ begin
 	S_AXI_RDATA	<= axi_rdata;
 	S_AXI_RRESP	<= axi_rresp;
 	S_AXI_RVALID	<= axi_rvalid;
---	-- Implement axi_awready generation
---	-- axi_awready is asserted for one S_AXI_ACLK clock cycle when both
---	-- S_AXI_AWVALID and S_AXI_WVALID are asserted. axi_awready is
---	-- de-asserted when reset is low.
+	-- Implement axi_awready generation
+	-- axi_awready is asserted for one S_AXI_ACLK clock cycle when both
+	-- S_AXI_AWVALID and S_AXI_WVALID are asserted. axi_awready is
+	-- de-asserted when reset is low.
 
---	process (S_AXI_ACLK)
---	begin
---	  if rising_edge(S_AXI_ACLK) then 
---	    if S_AXI_ARESETN = '0' then
---	      axi_awready <= '0';
---	      aw_en <= '1';
---	    else
---	      if (axi_awready = '0' and S_AXI_AWVALID = '1' and S_AXI_WVALID = '1' and aw_en = '1') then
---	        -- slave is ready to accept write address when
---	        -- there is a valid write address and write data
---	        -- on the write address and data bus. This design 
---	        -- expects no outstanding transactions. 
---	           axi_awready <= '1';
---	           aw_en <= '0';
---	        elsif (S_AXI_BREADY = '1' and axi_bvalid = '1') then
---	           aw_en <= '1';
---	           axi_awready <= '0';
---	      else
---	        axi_awready <= '0';
---	      end if;
---	    end if;
---	  end if;
---	end process;
+	process (S_AXI_ACLK)
+	begin
+	  if rising_edge(S_AXI_ACLK) then 
+	    if S_AXI_ARESETN = '0' then
+	      axi_awready <= '0';
+	      aw_en <= '1';
+	    else
+	      if (axi_awready = '0' and S_AXI_AWVALID = '1' and S_AXI_WVALID = '1' and aw_en = '1') then
+	        -- slave is ready to accept write address when
+	        -- there is a valid write address and write data
+	        -- on the write address and data bus. This design 
+	        -- expects no outstanding transactions. 
+	           axi_awready <= '1';
+	           aw_en <= '0';
+	        elsif (S_AXI_BREADY = '1' and axi_bvalid = '1') then
+	           aw_en <= '1';
+	           axi_awready <= '0';
+	      else
+	        axi_awready <= '0';
+	      end if;
+	    end if;
+	  end if;
+	end process;
 
---	-- Implement axi_awaddr latching
---	-- This process is used to latch the address when both 
---	-- S_AXI_AWVALID and S_AXI_WVALID are valid. 
+	-- Implement axi_awaddr latching
+	-- This process is used to latch the address when both 
+	-- S_AXI_AWVALID and S_AXI_WVALID are valid. 
 
---	process (S_AXI_ACLK)
---	begin
---	  if rising_edge(S_AXI_ACLK) then 
---	    if S_AXI_ARESETN = '0' then
---	      axi_awaddr <= (others => '0');
---	    else
---	      if (axi_awready = '0' and S_AXI_AWVALID = '1' and S_AXI_WVALID = '1' and aw_en = '1') then
---	        -- Write Address latching
---	        axi_awaddr <= S_AXI_AWADDR;
---	      end if;
---	    end if;
---	  end if;                   
---	end process; 
+	process (S_AXI_ACLK)
+	begin
+	  if rising_edge(S_AXI_ACLK) then 
+	    if S_AXI_ARESETN = '0' then
+	      axi_awaddr <= (others => '0');
+	    else
+	      if (axi_awready = '0' and S_AXI_AWVALID = '1' and S_AXI_WVALID = '1' and aw_en = '1') then
+	        -- Write Address latching
+	        axi_awaddr <= S_AXI_AWADDR;
+	      end if;
+	    end if;
+	  end if;                   
+	end process; 
 
---	-- Implement axi_wready generation
---	-- axi_wready is asserted for one S_AXI_ACLK clock cycle when both
---	-- S_AXI_AWVALID and S_AXI_WVALID are asserted. axi_wready is 
---	-- de-asserted when reset is low. 
+	-- Implement axi_wready generation
+	-- axi_wready is asserted for one S_AXI_ACLK clock cycle when both
+	-- S_AXI_AWVALID and S_AXI_WVALID are asserted. axi_wready is 
+	-- de-asserted when reset is low. 
 
---	process (S_AXI_ACLK)
---	begin
---	  if rising_edge(S_AXI_ACLK) then 
---	    if S_AXI_ARESETN = '0' then
---	      axi_wready <= '0';
---	    else
---	      if (axi_wready = '0' and S_AXI_WVALID = '1' and S_AXI_AWVALID = '1' and aw_en = '1') then
---	          -- slave is ready to accept write data when 
---	          -- there is a valid write address and write data
---	          -- on the write address and data bus. This design 
---	          -- expects no outstanding transactions.           
---	          axi_wready <= '1';
---	      else
---	        axi_wready <= '0';
---	      end if;
---	    end if;
---	  end if;
---	end process; 
+	process (S_AXI_ACLK)
+	begin
+	  if rising_edge(S_AXI_ACLK) then 
+	    if S_AXI_ARESETN = '0' then
+	      axi_wready <= '0';
+	    else
+	      if (axi_wready = '0' and S_AXI_WVALID = '1' and S_AXI_AWVALID = '1' and aw_en = '1') then
+	          -- slave is ready to accept write data when 
+	          -- there is a valid write address and write data
+	          -- on the write address and data bus. This design 
+	          -- expects no outstanding transactions.           
+	          axi_wready <= '1';
+	      else
+	        axi_wready <= '0';
+	      end if;
+	    end if;
+	  end if;
+	end process; 
 
---	-- Implement memory mapped register select and write logic generation
---	-- The write data is accepted and written to memory mapped registers when
---	-- axi_awready, S_AXI_WVALID, axi_wready and S_AXI_WVALID are asserted. Write strobes are used to
---	-- select byte enables of slave registers while writing.
---	-- These registers are cleared when reset (active low) is applied.
---	-- Slave register write enable is asserted when valid address and data are available
---	-- and the slave is ready to accept the write address and write data.
---	slv_reg_wren <= axi_wready and S_AXI_WVALID and axi_awready and S_AXI_AWVALID ;
+	-- Implement memory mapped register select and write logic generation
+	-- The write data is accepted and written to memory mapped registers when
+	-- axi_awready, S_AXI_WVALID, axi_wready and S_AXI_WVALID are asserted. Write strobes are used to
+	-- select byte enables of slave registers while writing.
+	-- These registers are cleared when reset (active low) is applied.
+	-- Slave register write enable is asserted when valid address and data are available
+	-- and the slave is ready to accept the write address and write data.
+	slv_reg_wren <= axi_wready and S_AXI_WVALID and axi_awready and S_AXI_AWVALID ;
 
---	process (S_AXI_ACLK)
---	variable loc_addr :std_logic_vector(OPT_MEM_ADDR_BITS downto 0); 
---	begin
---	  if rising_edge(S_AXI_ACLK) then 
---	    if S_AXI_ARESETN = '0' then
---	      slv_reg0 <= (others => '0');
---	      slv_reg1 <= (others => '0');
---	      slv_reg2 <= (others => '0');
---	      slv_reg3 <= (others => '0');
---	    else
---	      loc_addr := axi_awaddr(ADDR_LSB + OPT_MEM_ADDR_BITS downto ADDR_LSB);
---	      if (slv_reg_wren = '1') then
---	        case loc_addr is
---	          when b"00" =>
---	            for byte_index in 0 to (C_S_AXI_DATA_WIDTH/8-1) loop
---	              if ( S_AXI_WSTRB(byte_index) = '1' ) then
---	                -- Respective byte enables are asserted as per write strobes                   
---	                -- slave registor 0
---	                slv_reg0(byte_index*8+7 downto byte_index*8) <= S_AXI_WDATA(byte_index*8+7 downto byte_index*8);
---	              end if;
---	            end loop;
---	          when b"01" =>
---	            for byte_index in 0 to (C_S_AXI_DATA_WIDTH/8-1) loop
---	              if ( S_AXI_WSTRB(byte_index) = '1' ) then
---	                -- Respective byte enables are asserted as per write strobes                   
---	                -- slave registor 1
---	                slv_reg1(byte_index*8+7 downto byte_index*8) <= S_AXI_WDATA(byte_index*8+7 downto byte_index*8);
---	              end if;
---	            end loop;
---	          when b"10" =>
---	            for byte_index in 0 to (C_S_AXI_DATA_WIDTH/8-1) loop
---	              if ( S_AXI_WSTRB(byte_index) = '1' ) then
---	                -- Respective byte enables are asserted as per write strobes                   
---	                -- slave registor 2
---	                slv_reg2(byte_index*8+7 downto byte_index*8) <= S_AXI_WDATA(byte_index*8+7 downto byte_index*8);
---	              end if;
---	            end loop;
---	          when b"11" =>
---	            for byte_index in 0 to (C_S_AXI_DATA_WIDTH/8-1) loop
---	              if ( S_AXI_WSTRB(byte_index) = '1' ) then
---	                -- Respective byte enables are asserted as per write strobes                   
---	                -- slave registor 3
---	                slv_reg3(byte_index*8+7 downto byte_index*8) <= S_AXI_WDATA(byte_index*8+7 downto byte_index*8);
---	              end if;
---	            end loop;
---	          when others =>
---	            slv_reg0 <= slv_reg0;
---	            slv_reg1 <= slv_reg1;
---	            slv_reg2 <= slv_reg2;
---	            slv_reg3 <= slv_reg3;
---	        end case;
---	      end if;
---	    end if;
---	  end if;                   
---	end process; 
+	process (S_AXI_ACLK)
+	variable loc_addr :std_logic_vector(OPT_MEM_ADDR_BITS downto 0); 
+	begin
+	  if rising_edge(S_AXI_ACLK) then 
+	    if S_AXI_ARESETN = '0' then
+	      -- Default scan divider of 127 keeps the original 1.28 us scan step
+	      slv_reg1 <= std_logic_vector(to_unsigned(127, C_S_AXI_DATA_WIDTH));
+	    else
+	      loc_addr := axi_awaddr(ADDR_LSB + OPT_MEM_ADDR_BITS downto ADDR_LSB);
+	      if (slv_reg_wren = '1') then
+	        case loc_addr is
+	          when b"01" =>
+	            -- slave register 1 (keypad scan divider), the only writable register
+	            slv_reg1 <= S_AXI_WDATA;
+	          when others =>
+	            slv_reg1 <= slv_reg1;
+	        end case;
+	      end if;
+	    end if;
+	  end if;                   
+	end process; 
 
---	-- Implement write response logic generation
---	-- The write response and response valid signals are asserted by the slave 
---	-- when axi_wready, S_AXI_WVALID, axi_wready and S_AXI_WVALID are asserted.  
---	-- This marks the acceptance of address and indicates the status of 
---	-- write transaction.
+	-- Implement write response logic generation
+	-- The write response and response valid signals are asserted by the slave 
+	-- when axi_wready, S_AXI_WVALID, axi_wready and S_AXI_WVALID are asserted.  
+	-- This marks the acceptance of address and indicates the status of 
+	-- write transaction.
 
---	process (S_AXI_ACLK)
---	begin
---	  if rising_edge(S_AXI_ACLK) then 
---	    if S_AXI_ARESETN = '0' then
---	      axi_bvalid  <= '0';
---	      axi_bresp   <= "00"; --need to work more on the responses
---	    else
---	      if (axi_awready = '1' and S_AXI_AWVALID = '1' and axi_wready = '1' and S_AXI_WVALID = '1' and axi_bvalid = '0'  ) then
---	        axi_bvalid <= '1';
---	        axi_bresp  <= "00"; 
---	      elsif (S_AXI_BREADY = '1' and axi_bvalid = '1') then   --check if bready is asserted while bvalid is high)
---	        axi_bvalid <= '0';                                 -- (there is a possibility that bready is always asserted high)
---	      end if;
---	    end if;
---	  end if;                   
---	end process; 
+	process (S_AXI_ACLK)
+	begin
+	  if rising_edge(S_AXI_ACLK) then 
+	    if S_AXI_ARESETN = '0' then
+	      axi_bvalid  <= '0';
+	      axi_bresp   <= "00"; --need to work more on the responses
+	    else
+	      if (axi_awready = '1' and S_AXI_AWVALID = '1' and axi_wready = '1' and S_AXI_WVALID = '1' and axi_bvalid = '0'  ) then
+	        axi_bvalid <= '1';
+	        axi_bresp  <= "00"; 
+	      elsif (S_AXI_BREADY = '1' and axi_bvalid = '1') then   --check if bready is asserted while bvalid is high)
+	        axi_bvalid <= '0';                                 -- (there is a possibility that bready is always asserted high)
+	      end if;
+	    end if;
+	  end if;                   
+	end process; 
 
 	-- Implement axi_arready generation
 	-- axi_arready is asserted for one S_AXI_ACLK clock cycle when
@@ -346,24 +328,28 @@ begin
 	-- and the slave is ready to accept the read address.
 	slv_reg_rden <= axi_arready and S_AXI_ARVALID and (not axi_rvalid) ;
 
-	process (slv_reg0, slv_reg1, slv_reg2, slv_reg3, axi_araddr, S_AXI_ARESETN, slv_reg_rden, s_keypad_binary)
---	variable loc_add3 :std_logic_vector(OPT_MEM_ADDR_BITS downto 0);
+	process (slv_reg0, slv_reg1, slv_reg2, slv_reg3, axi_araddr, S_AXI_ARESETN, slv_reg_rden, s_keypad_binary, s_keypad_key_state, hex_key_pressed, s_keypad_h_key, s_keypad_l_key, key_cycle_counter, key_timestamp)
+	variable loc_addr :std_logic_vector(OPT_MEM_ADDR_BITS downto 0);
 	begin
-	   reg_data_out(3 downto 0) <= s_keypad_binary;
---	    -- Addres3 decoding for reading registers
---	    loc_addr := axi_araddr(ADDR_LSB + OPT_MEM_ADDR_BITS downto ADDR_LSB);
---	    case loc_addr is
---	      when b"00" =>
---	        reg_data_out <= slv_reg0;
---	      when b"01" =>
---	        reg_data_out <= slv_reg1;
---	      when b"10" =>
---	        reg_data_out <= slv_reg2;
---	      when b"11" =>
---	        reg_data_out <= slv_reg3;
---	      when others =>
---	        reg_data_out  <= (others => '0');
---	    end case;
+	    reg_data_out <= (others => '0');
+	    -- Address decoding for reading registers
+	    loc_addr := axi_araddr(ADDR_LSB + OPT_MEM_ADDR_BITS downto ADDR_LSB);
+	    case loc_addr is
+	      when b"00" =>
+	        reg_data_out(3 downto 0) <= s_keypad_binary;       -- current key
+	        reg_data_out(4) <= hex_key_pressed;                -- key is valid
+	        reg_data_out(5) <= s_keypad_h_key;                 -- H function key
+	        reg_data_out(6) <= s_keypad_l_key;                 -- L function key
+	      when b"01" =>
+	        reg_data_out <= slv_reg1;                          -- scan divider
+	      when b"10" =>
+	        reg_data_out(19 downto 0) <= s_keypad_key_state;   -- key bitmap
+	      when b"11" =>
+	        -- key age (cycles since the latched keypad state change)
+	        reg_data_out <= std_logic_vector(key_cycle_counter - key_timestamp);
+	      when others =>
+	        reg_data_out <= (others => '0');
+	    end case;
 	end process; 
 
 	-- Output register or memory read data
@@ -386,7 +372,29 @@ begin
 
 
 	-- Add user logic here
+	s_keypad_scan_divider <= slv_reg1(6 downto 0);
+	hex_key_pressed <= '0' when (unsigned(s_keypad_key_state and HEX_KEYS) = 0) else '1';
 
+	-- Key event timestamping: latch the cycle counter whenever the key bitmap
+	-- changes. Register 3 returns the cycles elapsed since then, so a single
+	-- read gives the exact time between a key event and the firmware noticing
+	-- it (wraps after 2^32 cycles).
+	process (S_AXI_ACLK)
+	begin
+	  if rising_edge(S_AXI_ACLK) then
+	    if S_AXI_ARESETN = '0' then
+	      key_cycle_counter  <= (others => '0');
+	      key_timestamp      <= (others => '0');
+	      key_state_previous <= (others => '0');
+	    else
+	      key_cycle_counter  <= key_cycle_counter + 1;
+	      key_state_previous <= s_keypad_key_state;
+	      if (s_keypad_key_state /= key_state_previous) then
+	        key_timestamp <= key_cycle_counter;
+	      end if;
+	    end if;
+	  end if;
+	end process;
 	-- User logic ends
 
 end arch_imp;
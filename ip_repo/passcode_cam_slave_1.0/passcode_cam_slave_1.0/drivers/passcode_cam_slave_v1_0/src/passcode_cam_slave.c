@@ -0,0 +1,71 @@
+
+
+/***************************** Include Files *******************************/
+#include "passcode_cam_slave.h"
+
+/************************** Function Definitions ***************************/
+
+/*
+ * Wait for the verdict of the code in the CODE register (and the result of
+ * any pending command) to become valid, then return the status register.
+ */
+static u32 PASSCODE_CAM_SLAVE_WaitStatus(UINTPTR BaseAddress)
+{
+	u32 status;
+
+	do {
+		status = PASSCODE_CAM_SLAVE_mReadReg(BaseAddress, PASSCODE_CAM_SLAVE_STATUS_OFFSET);
+	} while (!(status & PASSCODE_CAM_SLAVE_STATUS_VALID_MASK));
+
+	return status;
+}
+
+/*
+ * Write a code and a command, then wait for the command to complete.
+ */
+static u32 PASSCODE_CAM_SLAVE_Command(UINTPTR BaseAddress, u16 Code, u32 Command)
+{
+	PASSCODE_CAM_SLAVE_mWriteReg(BaseAddress, PASSCODE_CAM_SLAVE_CODE_OFFSET, Code);
+	PASSCODE_CAM_SLAVE_mWriteReg(BaseAddress, PASSCODE_CAM_SLAVE_CMD_OFFSET, Command);
+
+	return PASSCODE_CAM_SLAVE_WaitStatus(BaseAddress);
+}
+
+u32 PASSCODE_CAM_SLAVE_Lookup(UINTPTR BaseAddress, u16 Code)
+{
+	PASSCODE_CAM_SLAVE_mWriteReg(BaseAddress, PASSCODE_CAM_SLAVE_CODE_OFFSET, Code);
+
+	if (PASSCODE_CAM_SLAVE_WaitStatus(BaseAddress) & PASSCODE_CAM_SLAVE_STATUS_MATCH_MASK)
+		return TRUE;
+
+	return FALSE;
+}
+
+XStatus PASSCODE_CAM_SLAVE_Insert(UINTPTR BaseAddress, u16 Code)
+{
+	if (PASSCODE_CAM_SLAVE_Command(BaseAddress, Code, PASSCODE_CAM_SLAVE_CMD_INSERT) &
+	    PASSCODE_CAM_SLAVE_STATUS_CMD_OK_MASK)
+		return XST_SUCCESS;
+
+	return XST_FAILURE;
+}
+
+XStatus PASSCODE_CAM_SLAVE_Delete(UINTPTR BaseAddress, u16 Code)
+{
+	if (PASSCODE_CAM_SLAVE_Command(BaseAddress, Code, PASSCODE_CAM_SLAVE_CMD_DELETE) &
+	    PASSCODE_CAM_SLAVE_STATUS_CMD_OK_MASK)
+		return XST_SUCCESS;
+
+	return XST_FAILURE;
+}
+
+void PASSCODE_CAM_SLAVE_Clear(UINTPTR BaseAddress)
+{
+	PASSCODE_CAM_SLAVE_mWriteReg(BaseAddress, PASSCODE_CAM_SLAVE_CMD_OFFSET, PASSCODE_CAM_SLAVE_CMD_CLEAR);
+	PASSCODE_CAM_SLAVE_WaitStatus(BaseAddress);
+}
+
+u32 PASSCODE_CAM_SLAVE_Occupancy(UINTPTR BaseAddress)
+{
+	return PASSCODE_CAM_SLAVE_mReadReg(BaseAddress, PASSCODE_CAM_SLAVE_OCCUPANCY_OFFSET);
+}
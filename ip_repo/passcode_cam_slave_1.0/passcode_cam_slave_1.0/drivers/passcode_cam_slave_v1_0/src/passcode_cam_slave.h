@@ -0,0 +1,169 @@
+
+#ifndef PASSCODE_CAM_SLAVE_H
+#define PASSCODE_CAM_SLAVE_H
+
+
+/****************** Include Files ********************/
+#include "xil_types.h"
+#include "xstatus.h"
+
+#define PASSCODE_CAM_SLAVE_S00_AXI_SLV_REG0_OFFSET 0
+#define PASSCODE_CAM_SLAVE_S00_AXI_SLV_REG1_OFFSET 4
+#define PASSCODE_CAM_SLAVE_S00_AXI_SLV_REG2_OFFSET 8
+#define PASSCODE_CAM_SLAVE_S00_AXI_SLV_REG3_OFFSET 12
+
+/* Register map */
+#define PASSCODE_CAM_SLAVE_CODE_OFFSET      PASSCODE_CAM_SLAVE_S00_AXI_SLV_REG0_OFFSET
+#define PASSCODE_CAM_SLAVE_CMD_OFFSET       PASSCODE_CAM_SLAVE_S00_AXI_SLV_REG1_OFFSET
+#define PASSCODE_CAM_SLAVE_STATUS_OFFSET    PASSCODE_CAM_SLAVE_S00_AXI_SLV_REG2_OFFSET
+#define PASSCODE_CAM_SLAVE_OCCUPANCY_OFFSET PASSCODE_CAM_SLAVE_S00_AXI_SLV_REG3_OFFSET
+
+/* Commands (written to the CMD register, applied to the code in CODE) */
+#define PASSCODE_CAM_SLAVE_CMD_NONE   0x0
+#define PASSCODE_CAM_SLAVE_CMD_INSERT 0x1
+#define PASSCODE_CAM_SLAVE_CMD_DELETE 0x2
+#define PASSCODE_CAM_SLAVE_CMD_CLEAR  0x3
+
+/* STATUS register bits */
+#define PASSCODE_CAM_SLAVE_STATUS_MATCH_MASK  0x1
+#define PASSCODE_CAM_SLAVE_STATUS_VALID_MASK  0x2
+#define PASSCODE_CAM_SLAVE_STATUS_CMD_OK_MASK 0x4
+#define PASSCODE_CAM_SLAVE_STATUS_FULL_MASK   0x8
+
+/* Tag stored with a code on insert (CODE bits) and of the match (STATUS bits) */
+#define PASSCODE_CAM_SLAVE_CODE_TAG_SHIFT   16
+#define PASSCODE_CAM_SLAVE_STATUS_TAG_SHIFT 8
+#define PASSCODE_CAM_SLAVE_STATUS_TAG_MASK  0xFF00
+
+/* Number of entries in the default hardware configuration (C_CAM_DEPTH) */
+#define PASSCODE_CAM_SLAVE_DEPTH 128
+
+
+/**************************** Type Definitions *****************************/
+/**
+ *
+ * Write a value to a PASSCODE_CAM_SLAVE register. A 32 bit write is performed.
+ * If the component is implemented in a smaller width, only the least
+ * significant data is written.
+ *
+ * @param   BaseAddress is the base address of the PASSCODE_CAM_SLAVEdevice.
+ * @param   RegOffset is the register offset from the base to write to.
+ * @param   Data is the data written to the register.
+ *
+ * @return  None.
+ *
+ * @note
+ * C-style signature:
+ * 	void PASSCODE_CAM_SLAVE_mWriteReg(u32 BaseAddress, unsigned RegOffset, u32 Data)
+ *
+ */
+#define PASSCODE_CAM_SLAVE_mWriteReg(BaseAddress, RegOffset, Data) \
+  	Xil_Out32((BaseAddress) + (RegOffset), (u32)(Data))
+
+/**
+ *
+ * Read a value from a PASSCODE_CAM_SLAVE register. A 32 bit read is performed.
+ * If the component is implemented in a smaller width, only the least
+ * significant data is read from the register. The most significant data
+ * will be read as 0.
+ *
+ * @param   BaseAddress is the base address of the PASSCODE_CAM_SLAVE device.
+ * @param   RegOffset is the register offset from the base to write to.
+ *
+ * @return  Data is the data from the register.
+ *
+ * @note
+ * C-style signature:
+ * 	u32 PASSCODE_CAM_SLAVE_mReadReg(u32 BaseAddress, unsigned RegOffset)
+ *
+ */
+#define PASSCODE_CAM_SLAVE_mReadReg(BaseAddress, RegOffset) \
+    Xil_In32((BaseAddress) + (RegOffset))
+
+/************************** Function Prototypes ****************************/
+/**
+ *
+ * Run a self-test on the driver/device. Note this may be a destructive test if
+ * resets of the device are performed.
+ *
+ * If the hardware system is not built correctly, this function may never
+ * return to the caller.
+ *
+ * @param   baseaddr_p is the base address of the PASSCODE_CAM_SLAVE instance to be worked on.
+ *
+ * @return
+ *
+ *    - XST_SUCCESS   if all self-test code passed
+ *    - XST_FAILURE   if any self-test code failed
+ *
+ * @note    Caching must be turned off for this function to work.
+ * @note    Self test may fail if data memory and device are not on the same bus.
+ *
+ */
+XStatus PASSCODE_CAM_SLAVE_Reg_SelfTest(void * baseaddr_p);
+
+/**
+ *
+ * Look up a 16 bit code (four 4 bit digits) in the CAM.
+ *
+ * @param   BaseAddress is the base address of the PASSCODE_CAM_SLAVE device.
+ * @param   Code is the code to look up.
+ *
+ * @return  TRUE if the code is stored, FALSE otherwise.
+ *
+ */
+u32 PASSCODE_CAM_SLAVE_Lookup(UINTPTR BaseAddress, u16 Code);
+
+/**
+ *
+ * Insert a 16 bit code into the CAM.
+ *
+ * @param   BaseAddress is the base address of the PASSCODE_CAM_SLAVE device.
+ * @param   Code is the code to insert.
+ *
+ * @return
+ *
+ *    - XST_SUCCESS   if the code was inserted
+ *    - XST_FAILURE   if the code was already stored or the CAM is full
+ *
+ */
+XStatus PASSCODE_CAM_SLAVE_Insert(UINTPTR BaseAddress, u16 Code);
+
+/**
+ *
+ * Delete a 16 bit code from the CAM.
+ *
+ * @param   BaseAddress is the base address of the PASSCODE_CAM_SLAVE device.
+ * @param   Code is the code to delete.
+ *
+ * @return
+ *
+ *    - XST_SUCCESS   if the code was deleted
+ *    - XST_FAILURE   if the code was not stored
+ *
+ */
+XStatus PASSCODE_CAM_SLAVE_Delete(UINTPTR BaseAddress, u16 Code);
+
+/**
+ *
+ * Delete every code from the CAM.
+ *
+ * @param   BaseAddress is the base address of the PASSCODE_CAM_SLAVE device.
+ *
+ * @return  None.
+ *
+ */
+void PASSCODE_CAM_SLAVE_Clear(UINTPTR BaseAddress);
+
+/**
+ *
+ * Get the number of codes stored in the CAM.
+ *
+ * @param   BaseAddress is the base address of the PASSCODE_CAM_SLAVE device.
+ *
+ * @return  Number of stored codes.
+ *
+ */
+u32 PASSCODE_CAM_SLAVE_Occupancy(UINTPTR BaseAddress);
+
+#endif // PASSCODE_CAM_SLAVE_H
@@ -0,0 +1,133 @@
+
+/***************************** Include Files *******************************/
+#include "passcode_cam_slave.h"
+#include "xparameters.h"
+#include "stdio.h"
+#include "xil_io.h"
+#include "xtime_l.h"
+
+/************************** Constant Definitions ***************************/
+#define SELFTEST_NUM_CODES   100
+#define SELFTEST_NUM_LOOKUPS 1000
+
+/************************** Function Definitions ***************************/
+/*
+ * Software reference for the timing comparison. This is the same linear scan
+ * performed by isExistingPasscode() in Security_System.c.
+ */
+static u32 PASSCODE_CAM_SLAVE_SoftwareLookup(u8 codes[][4], int numCodes, u8 code[4])
+{
+	for (int i = 0; i < numCodes; i++)
+	{
+		if ((code[0] == codes[i][0]) &&
+		    (code[1] == codes[i][1]) &&
+		    (code[2] == codes[i][2]) &&
+		    (code[3] == codes[i][3]))
+		{
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+/**
+ *
+ * Run a self-test on the driver/device. Note this may be a destructive test if
+ * resets of the device are performed.
+ *
+ * If the hardware system is not built correctly, this function may never
+ * return to the caller.
+ *
+ * The CAM registers are not plain read/write registers, so instead of the
+ * generated write/read-back test this inserts, looks up and deletes codes and
+ * then compares the lookup time against a software linear scan.
+ *
+ * @param   baseaddr_p is the base address of the PASSCODE_CAM_SLAVEinstance to be worked on.
+ *
+ * @return
+ *
+ *    - XST_SUCCESS   if all self-test code passed
+ *    - XST_FAILURE   if any self-test code failed
+ *
+ * @note    Caching must be turned off for this function to work.
+ * @note    Self test may fail if data memory and device are not on the same bus.
+ * @note    This test clears the CAM.
+ *
+ */
+XStatus PASSCODE_CAM_SLAVE_Reg_SelfTest(void * baseaddr_p)
+{
+	UINTPTR baseaddr;
+	static u8 softwareCodes[SELFTEST_NUM_CODES][4];
+	u8 missingCode[4] = {0xF, 0xF, 0xF, 0xF};
+	XTime start, end;
+	u64 hardwareTicks, softwareTicks;
+	volatile u32 verdict;
+	int Index;
+
+	baseaddr = (UINTPTR) baseaddr_p;
+
+	xil_printf("******************************\n\r");
+	xil_printf("* User Peripheral Self Test\n\r");
+	xil_printf("******************************\n\n\r");
+
+	/*
+	 * Insert, look up and delete codes
+	 */
+	xil_printf("User logic CAM test...\n\r");
+
+	PASSCODE_CAM_SLAVE_Clear(baseaddr);
+	for (Index = 0; Index < SELFTEST_NUM_CODES; Index++) {
+		if (PASSCODE_CAM_SLAVE_Insert(baseaddr, Index) != XST_SUCCESS) {
+			xil_printf("Error inserting code %x\n", Index);
+			return XST_FAILURE;
+		}
+		softwareCodes[Index][0] = (Index >> 12) & 0xF;
+		softwareCodes[Index][1] = (Index >> 8) & 0xF;
+		softwareCodes[Index][2] = (Index >> 4) & 0xF;
+		softwareCodes[Index][3] = Index & 0xF;
+	}
+	if (PASSCODE_CAM_SLAVE_Insert(baseaddr, 0) == XST_SUCCESS) {
+		xil_printf("Error: duplicate code inserted\n");
+		return XST_FAILURE;
+	}
+	if (PASSCODE_CAM_SLAVE_Occupancy(baseaddr) != SELFTEST_NUM_CODES) {
+		xil_printf("Error reading occupancy\n");
+		return XST_FAILURE;
+	}
+	if (!PASSCODE_CAM_SLAVE_Lookup(baseaddr, SELFTEST_NUM_CODES - 1) ||
+	    PASSCODE_CAM_SLAVE_Lookup(baseaddr, 0xFFFF)) {
+		xil_printf("Error looking up code\n");
+		return XST_FAILURE;
+	}
+	if (PASSCODE_CAM_SLAVE_Delete(baseaddr, 0) != XST_SUCCESS ||
+	    PASSCODE_CAM_SLAVE_Lookup(baseaddr, 0) ||
+	    PASSCODE_CAM_SLAVE_Delete(baseaddr, 0) == XST_SUCCESS) {
+		xil_printf("Error deleting code\n");
+		return XST_FAILURE;
+	}
+
+	xil_printf("   - insert/lookup/delete passed\n\n\r");
+
+	/*
+	 * Compare worst case (absent code) lookup time against the software scan
+	 */
+	XTime_GetTime(&start);
+	for (Index = 0; Index < SELFTEST_NUM_LOOKUPS; Index++)
+		verdict = PASSCODE_CAM_SLAVE_Lookup(baseaddr, 0xFFFF);
+	XTime_GetTime(&end);
+	hardwareTicks = (end - start) / SELFTEST_NUM_LOOKUPS;
+
+	XTime_GetTime(&start);
+	for (Index = 0; Index < SELFTEST_NUM_LOOKUPS; Index++)
+		verdict = PASSCODE_CAM_SLAVE_SoftwareLookup(softwareCodes, SELFTEST_NUM_CODES, missingCode);
+	XTime_GetTime(&end);
+	softwareTicks = (end - start) / SELFTEST_NUM_LOOKUPS;
+	(void) verdict;
+
+	xil_printf("   - lookup of %d codes: CAM %d ticks, software %d ticks (%d ticks/s)\n\n\r",
+		   SELFTEST_NUM_CODES, (int) hardwareTicks, (int) softwareTicks, (int) COUNTS_PER_SECOND);
+
+	PASSCODE_CAM_SLAVE_Clear(baseaddr);
+
+	return XST_SUCCESS;
+}
@@ -0,0 +1,249 @@
+--------------------------------------------------------------------------------
+-- Filename     : passcode_cam_slave_v1_0_tb.vhd
+-- Author(s)    : Kyle Bielby, Chris Lloyd (Team 1)
+-- Class        : EE365 (Final Project)
+-- Target Board : Cora Z7-10
+-- Entity       : passcode_cam_slave_v1_0_tb
+-- Description  : GHDL testbench for passcode_cam_slave_v1_0. Drives the AXI4
+--                Lite slave port to insert, look up and delete passcodes and
+--                reports the number of clock ticks from the passcode write
+--                to a valid verdict.
+--------------------------------------------------------------------------------
+
+-----------------
+--  Libraries  --
+-----------------
+library ieee;
+  use ieee.std_logic_1164.all;
+  use ieee.numeric_std.all;
+
+--------------
+--  Entity  --
+--------------
+entity passcode_cam_slave_v1_0_tb is
+end entity passcode_cam_slave_v1_0_tb;
+
+--------------------------------
+--  Architecture Declaration  --
+--------------------------------
+architecture behavioral of passcode_cam_slave_v1_0_tb is
+
+  -------------
+  -- CONSTANTS --
+  -------------
+  constant CLK_PERIOD       : time    := 10 ns;  -- 100 MHz AXI clock
+  constant CAM_DEPTH        : integer := 128;
+
+  constant CODE_OFFSET      : std_logic_vector(3 downto 0) := x"0";
+  constant CMD_OFFSET       : std_logic_vector(3 downto 0) := x"4";
+  constant STATUS_OFFSET    : std_logic_vector(3 downto 0) := x"8";
+  constant OCCUPANCY_OFFSET : std_logic_vector(3 downto 0) := x"C";
+
+  constant CMD_INSERT       : std_logic_vector(31 downto 0) := x"00000001";
+  constant CMD_DELETE       : std_logic_vector(31 downto 0) := x"00000002";
+  constant CMD_CLEAR        : std_logic_vector(31 downto 0) := x"00000003";
+
+  -------------
+  -- SIGNALS --
+  -------------
+  signal s_clk      : std_logic := '0';
+  signal s_aresetn  : std_logic := '0';
+  signal s_done     : boolean   := false;
+  signal s_cycles   : natural   := 0;
+
+  signal s_awaddr   : std_logic_vector(3 downto 0)  := (others => '0');
+  signal s_awvalid  : std_logic := '0';
+  signal s_awready  : std_logic;
+  signal s_wdata    : std_logic_vector(31 downto 0) := (others => '0');
+  signal s_wvalid   : std_logic := '0';
+  signal s_wready   : std_logic;
+  signal s_bresp    : std_logic_vector(1 downto 0);
+  signal s_bvalid   : std_logic;
+  signal s_bready   : std_logic := '0';
+  signal s_araddr   : std_logic_vector(3 downto 0)  := (others => '0');
+  signal s_arvalid  : std_logic := '0';
+  signal s_arready  : std_logic;
+  signal s_rdata    : std_logic_vector(31 downto 0);
+  signal s_rresp    : std_logic_vector(1 downto 0);
+  signal s_rvalid   : std_logic;
+  signal s_rready   : std_logic := '0';
+
+begin
+
+  -- Unit under test
+  UUT: entity work.passcode_cam_slave_v1_0
+  generic map (
+    C_CAM_DEPTH          => CAM_DEPTH,
+    C_S00_AXI_DATA_WIDTH => 32,
+    C_S00_AXI_ADDR_WIDTH => 4
+  )
+  port map (
+    s00_axi_aclk    => s_clk,
+    s00_axi_aresetn => s_aresetn,
+    s00_axi_awaddr  => s_awaddr,
+    s00_axi_awprot  => "000",
+    s00_axi_awvalid => s_awvalid,
+    s00_axi_awready => s_awready,
+    s00_axi_wdata   => s_wdata,
+    s00_axi_wstrb   => "1111",
+    s00_axi_wvalid  => s_wvalid,
+    s00_axi_wready  => s_wready,
+    s00_axi_bresp   => s_bresp,
+    s00_axi_bvalid  => s_bvalid,
+    s00_axi_bready  => s_bready,
+    s00_axi_araddr  => s_araddr,
+    s00_axi_arprot  => "000",
+    s00_axi_arvalid => s_arvalid,
+    s00_axi_arready => s_arready,
+    s00_axi_rdata   => s_rdata,
+    s00_axi_rresp   => s_rresp,
+    s00_axi_rvalid  => s_rvalid,
+    s00_axi_rready  => s_rready
+  );
+
+  -- Clock and free running cycle counter
+  s_clk    <= not s_clk after CLK_PERIOD / 2 when not s_done else '0';
+  s_cycles <= s_cycles + 1 when rising_edge(s_clk);
+
+  ------------------------------------------------------------------------------
+  -- Process Name     : STIMULUS
+  -- Description      : Issues AXI4 Lite transactions the same way the C driver
+  --                    does and checks every verdict.
+  ------------------------------------------------------------------------------
+  STIMULUS: process
+
+    procedure axi_write(addr : std_logic_vector(3 downto 0);
+                        data : std_logic_vector(31 downto 0)) is
+    begin
+      wait until rising_edge(s_clk);
+      s_awaddr  <= addr;
+      s_awvalid <= '1';
+      s_wdata   <= data;
+      s_wvalid  <= '1';
+      s_bready  <= '1';
+      wait until rising_edge(s_clk) and s_awready = '1' and s_wready = '1';
+      s_awvalid <= '0';
+      s_wvalid  <= '0';
+      wait until rising_edge(s_clk) and s_bvalid = '1';
+      s_bready  <= '0';
+    end procedure axi_write;
+
+    procedure axi_read(addr : std_logic_vector(3 downto 0);
+                       data : out std_logic_vector(31 downto 0)) is
+    begin
+      wait until rising_edge(s_clk);
+      s_araddr  <= addr;
+      s_arvalid <= '1';
+      s_rready  <= '1';
+      wait until rising_edge(s_clk) and s_arready = '1';
+      s_arvalid <= '0';
+      wait until rising_edge(s_clk) and s_rvalid = '1';
+      data      := s_rdata;
+      s_rready  <= '0';
+    end procedure axi_read;
+
+    -- Poll status until the verdict is valid
+    procedure wait_status(status : out std_logic_vector(31 downto 0)) is
+      variable v_status : std_logic_vector(31 downto 0);
+    begin
+      loop
+        axi_read(STATUS_OFFSET, v_status);
+        exit when v_status(1) = '1';
+      end loop;
+      status := v_status;
+    end procedure wait_status;
+
+    procedure command(code : natural;
+                      cmd  : std_logic_vector(31 downto 0);
+                      ok   : std_logic) is
+      variable v_status : std_logic_vector(31 downto 0);
+    begin
+      axi_write(CODE_OFFSET, std_logic_vector(to_unsigned(code, 32)));
+      axi_write(CMD_OFFSET, cmd);
+      wait_status(v_status);
+      assert v_status(2) = ok
+        report "command " & integer'image(to_integer(unsigned(cmd))) &
+               " on code " & integer'image(code) & " returned wrong status"
+        severity error;
+    end procedure command;
+
+    procedure lookup(code : natural; expected : std_logic) is
+      variable v_status : std_logic_vector(31 downto 0);
+      variable v_start  : natural;
+    begin
+      axi_write(CODE_OFFSET, std_logic_vector(to_unsigned(code, 32)));
+      v_start := s_cycles;
+      wait_status(v_status);
+      assert v_status(0) = expected
+        report "lookup of code " & integer'image(code) & " returned wrong verdict"
+        severity error;
+      report "lookup of code " & integer'image(code) & ": verdict after " &
+             integer'image(s_cycles - v_start) & " clock ticks (incl. AXI reads)";
+    end procedure lookup;
+
+    procedure lookup_tag(code : natural; tag : natural) is
+      variable v_status : std_logic_vector(31 downto 0);
+    begin
+      axi_write(CODE_OFFSET, std_logic_vector(to_unsigned(code, 32)));
+      wait_status(v_status);
+      assert to_integer(unsigned(v_status(15 downto 8))) = tag
+        report "lookup of code " & integer'image(code) & " returned tag " &
+               integer'image(to_integer(unsigned(v_status(15 downto 8))))
+        severity error;
+    end procedure lookup_tag;
+
+    procedure check_occupancy(expected : natural) is
+      variable v_data : std_logic_vector(31 downto 0);
+    begin
+      axi_read(OCCUPANCY_OFFSET, v_data);
+      assert to_integer(unsigned(v_data)) = expected
+        report "occupancy " & integer'image(to_integer(unsigned(v_data))) &
+               " expected " & integer'image(expected)
+        severity error;
+    end procedure check_occupancy;
+
+  begin
+    -- Reset
+    s_aresetn <= '0';
+    wait for 5 * CLK_PERIOD;
+    s_aresetn <= '1';
+
+    -- Empty CAM
+    check_occupancy(0);
+    lookup(16#1234#, '0');
+
+    -- Insert (tagged with the entry number), reject duplicate, look up first
+    -- and last entries
+    for i in 0 to CAM_DEPTH - 1 loop
+      command(i + (i * 16#10000#), CMD_INSERT, '1');
+    end loop;
+    check_occupancy(CAM_DEPTH);
+    command(0, CMD_INSERT, '0');
+    command(16#9999#, CMD_INSERT, '0');  -- Full
+    lookup(0, '1');
+    lookup(CAM_DEPTH - 1, '1');
+    lookup(16#9999#, '0');
+    lookup_tag(0, 0);
+    lookup_tag(CAM_DEPTH - 1, CAM_DEPTH - 1);
+    lookup_tag(16#9999#, 0);
+
+    -- Delete frees an entry that is reused by the next insert
+    command(5, CMD_DELETE, '1');
+    command(5, CMD_DELETE, '0');
+    lookup(5, '0');
+    check_occupancy(CAM_DEPTH - 1);
+    command(16#9999# + (16#5A# * 16#10000#), CMD_INSERT, '1');
+    lookup(16#9999#, '1');
+    lookup_tag(16#9999#, 16#5A#);
+
+    -- Clear
+    command(0, CMD_CLEAR, '1');
+    check_occupancy(0);
+    lookup(0, '0');
+
+    report "passcode_cam_slave_v1_0_tb complete";
+    s_done <= true;
+    wait;
+  end process STIMULUS;
+
+end architecture behavioral;
@@ -33,6 +33,9 @@ port
   I_CLK_50MHZ    : in  std_logic;
   I_SYSTEM_RST    : in  std_logic;
 
+  -- Scan divider (clock ticks between keypad state changes, minus one)
+  I_SCAN_DIVIDER  : in  std_logic_vector(6 downto 0);
+
   -- Keypad Inputs (rows)
   I_KEYPAD_ROW_1  : in  std_logic;
   I_KEYPAD_ROW_2  : in  std_logic;
@@ -54,7 +57,11 @@ port
   O_KEYPAD_BINARY : out std_logic_vector(3 downto 0);
 
   -- 6 bit binary representation of keypad state for RGB representation
-  O_KEYPAD_RGB_BINARY : out std_logic_vector(8 downto 0)
+  O_KEYPAD_RGB_BINARY : out std_logic_vector(8 downto 0);
+
+  -- Full key state bitmap (bit ((row - 1) * 4) + (col - 1) is set while the
+  -- key at that row and column is held)
+  O_KEYPAD_KEY_STATE  : out std_logic_vector(19 downto 0)
 );
 end entity hex_keypad_driver;
 
@@ -97,6 +104,9 @@ architecture rtl of hex_keypad_driver is
   -- 6 bit binary representation of keypad value used for RGB LEDs
   signal s_keypad_RGB_binary  : std_logic_vector(8 downto 0);
 
+  -- Bitmap of every key held during the most recent scan of each column
+  signal s_keypad_key_state   : std_logic_vector(19 downto 0);
+
 begin
   ------------------------------------------------------------------------------
   -- Process Name     : KEYPAD_EN_CNTR
@@ -106,9 +116,10 @@ begin
   --                    in KEYPAD_STATE_MACHINE process
   --                    (active high enable logic)
   -- Description      : Counter to delay the powering of the columns to negate
-  --                    the delay of the Hardware. Every 1111111b (127) clock
-  --                    ticks (1.27 us), s_keypad_enable gets driven high to
-  --                    allow for state change in KEYPAD_STATE_MACHINE process.
+  --                    the delay of the Hardware. Every I_SCAN_DIVIDER + 1
+  --                    clock ticks (default 1111111b (127) + 1, 1.28 us),
+  --                    s_keypad_enable gets driven high to allow for state
+  --                    change in KEYPAD_STATE_MACHINE process.
   ------------------------------------------------------------------------------
   KEYPAD_EN_CNTR: process (I_CLK_50MHZ, I_SYSTEM_RST)
   begin
@@ -117,12 +128,12 @@ begin
       s_keypad_enable       <= '0';
 
     elsif (rising_edge(I_CLK_50MHZ)) then
-      s_keypad_enable_cntr  <= s_keypad_enable_cntr + 1;
-
-      if (s_keypad_enable_cntr = "110011") then  -- Max count 127 (1.27 us)
-        s_keypad_enable     <= '1';
+      if (s_keypad_enable_cntr >= unsigned(I_SCAN_DIVIDER)) then
+        s_keypad_enable_cntr  <= (others => '0');
+        s_keypad_enable       <= '1';
       else
-        s_keypad_enable     <= '0';
+        s_keypad_enable_cntr  <= s_keypad_enable_cntr + 1;
+        s_keypad_enable       <= '0';
       end if;
     end if;
   end process KEYPAD_EN_CNTR;
@@ -187,9 +198,12 @@ begin
   --                    I_SYSTEM_RST    : Global Reset line
   -- Useful Outputs   : s_keypad_binary : 4 bit binary representation of keypad
   --                                      state (output of entity).
+  --                    s_keypad_key_state : Bitmap of all keys held
   -- Description      : Entity to control the powering and reading of the
   --                    keypad rows and columns based on the current s_keypad_state.
   --                    Outputs the current binary number of keypad (0-15)
+  --                    along with a bitmap of every key held, so simultaneous
+  --                    key presses (rollover) are not lost.
   ------------------------------------------------------------------------------
   KEYPAD_TO_BINARY: process (I_CLK_50MHZ, I_SYSTEM_RST)
   begin
@@ -200,6 +214,7 @@ begin
       s_keypad_col_4      <= '0';
       s_keypad_binary     <= (others => '0');
       s_keypad_RGB_binary <= (others => '0');
+      s_keypad_key_state  <= (others => '0');
 
     elsif ((rising_edge(I_CLK_50MHZ))) then
 
@@ -240,6 +255,12 @@ begin
 
       -- Col 1
       if (s_keypad_state = COL1_READ_STATE) then
+        s_keypad_key_state(0) <= I_KEYPAD_ROW_1;
+        s_keypad_key_state(4) <= I_KEYPAD_ROW_2;
+        s_keypad_key_state(8) <= I_KEYPAD_ROW_3;
+        s_keypad_key_state(12) <= I_KEYPAD_ROW_4;
+        s_keypad_key_state(16) <= I_KEYPAD_ROW_5;
+
         if    (I_KEYPAD_ROW_1 = '1') then
           -- TODO figure out s_keypad_binary usage
           s_keypad_binary <= "1010";             -- A key pressed
@@ -262,6 +283,12 @@ begin
 
       -- Col 2
       elsif (s_keypad_state = COL2_READ_STATE) then
+        s_keypad_key_state(1) <= I_KEYPAD_ROW_1;
+        s_keypad_key_state(5) <= I_KEYPAD_ROW_2;
+        s_keypad_key_state(9) <= I_KEYPAD_ROW_3;
+        s_keypad_key_state(13) <= I_KEYPAD_ROW_4;
+        s_keypad_key_state(17) <= I_KEYPAD_ROW_5;
+
         if    (I_KEYPAD_ROW_1 = '1') then
           -- TODO figure out s_keypad_binary usage
           s_keypad_binary <= "1011";             -- B key pressed 
@@ -281,6 +308,12 @@ begin
 
       -- Col 3
       elsif (s_keypad_state = COL3_READ_STATE) then
+        s_keypad_key_state(2) <= I_KEYPAD_ROW_1;
+        s_keypad_key_state(6) <= I_KEYPAD_ROW_2;
+        s_keypad_key_state(10) <= I_KEYPAD_ROW_3;
+        s_keypad_key_state(14) <= I_KEYPAD_ROW_4;
+        s_keypad_key_state(18) <= I_KEYPAD_ROW_5;
+
         if    (I_KEYPAD_ROW_1 = '1') then
           -- TODO figure out s_keypad_binary use
           s_keypad_binary <= "1100";             -- C key pressed 
@@ -295,7 +328,7 @@ begin
           s_keypad_binary <= "1001";             -- 9 key pressed 
           s_keypad_RGB_binary <= "000100010";    -- row 4 column 3 keypad entry
         elsif (I_KEYPAD_ROW_5 = '1') then
-          h_key_pressed <= '1';                  -- H key pressed 
+          -- H key pressed (reported through s_keypad_key_state)
           s_keypad_RGB_binary <= "000010010";    -- row 5 column 3 keypad entry
         else
           s_keypad_binary <= s_keypad_binary;
@@ -303,6 +336,12 @@ begin
 
       -- Col 4
       elsif (s_keypad_state = COL4_READ_STATE) then
+        s_keypad_key_state(3) <= I_KEYPAD_ROW_1;
+        s_keypad_key_state(7) <= I_KEYPAD_ROW_2;
+        s_keypad_key_state(11) <= I_KEYPAD_ROW_3;
+        s_keypad_key_state(15) <= I_KEYPAD_ROW_4;
+        s_keypad_key_state(19) <= I_KEYPAD_ROW_5;
+
         if    (I_KEYPAD_ROW_1 = '1') then
           s_keypad_binary <= "1101";
           s_keypad_RGB_binary <= "100000001";    -- row 1 column 4 keypad entry
@@ -332,7 +371,16 @@ begin
   O_KEYPAD_COL_2          <= s_keypad_col_2;
   O_KEYPAD_COL_3          <= s_keypad_col_3;
   O_KEYPAD_COL_4          <= s_keypad_col_4;
-  O_KEYPAD_BINARY         <= s_keypad_binary;
+  -- Report no key (1111b) once a full scan finds every key released
+  O_KEYPAD_BINARY         <= "1111" when (unsigned(s_keypad_key_state) = 0) else
+                             s_keypad_binary;
   O_KEYPAD_RGB_BINARY     <= s_keypad_RGB_binary;
+  O_KEYPAD_KEY_STATE      <= s_keypad_key_state;
+
+  -- Function keys (row 5 column 3 and row 5 column 4)
+  h_key_pressed           <= s_keypad_key_state(18);
+  l_key_pressed           <= s_keypad_key_state(19);
+  H_KEY_OUT               <= h_key_pressed;
+  L_KEY_OUT               <= l_key_pressed;
   ------------------------------------------------------------------------------
 end architecture rtl;
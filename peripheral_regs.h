@@ -0,0 +1,230 @@
+/*  peripheral_regs.h
+ *  Authors: Kyle Bielby, Christopher Lloyd
+ *  Description: Register map of the AXI slaves, generated by
+ *  host/regmap/regmap_gen from their IP-XACT component.xml files. Do not
+ *  edit; change the component.xml (or the address map in
+ *  host/regmap/Makefile) and run make -C host/regmap regs instead.
+ *
+ *  Addresses and field masks are compile-time constants and accessors are
+ *  static inline, so each access compiles to a single load or store.
+ *  Define PERIPHERAL_REG_READ and PERIPHERAL_REG_WRITE before including
+ *  this header to route the accesses elsewhere (e.g. a recorder).
+ */
+
+#ifndef PERIPHERAL_REGS_H
+#define PERIPHERAL_REGS_H
+
+#include "xil_types.h"
+#include "xil_io.h"
+#ifndef HOST_BUILD
+#include "xparameters.h"
+#endif
+
+// Host builds go through the host backend's Xil_In32/Xil_Out32
+#ifndef PERIPHERAL_REG_READ
+#ifdef HOST_BUILD
+#define PERIPHERAL_REG_READ(address)         Xil_In32(address)
+#define PERIPHERAL_REG_WRITE(address, value) Xil_Out32((address), (value))
+#else
+#define PERIPHERAL_REG_READ(address)         (*(volatile u32 *)(address))
+#define PERIPHERAL_REG_WRITE(address, value) \
+    (*(volatile u32 *)(address) = (value))
+#endif
+#endif
+
+// keypad_binary_slave_0 (ip_repo/keypad_binary_slave_1.0/keypad_binary_slave_1.0/component.xml)
+#define KEYPAD_BINARY_SLAVE_BASE_ADDR 0x43C00000U
+#define KEYPAD_BINARY_SLAVE_RANGE     0x1000U
+#ifdef XPAR_KEYPAD_BINARY_SLAVE_0_S00_AXI_BASEADDR
+_Static_assert(XPAR_KEYPAD_BINARY_SLAVE_0_S00_AXI_BASEADDR == KEYPAD_BINARY_SLAVE_BASE_ADDR,
+               "keypad_binary_slave_0 moved in the address map, regenerate peripheral_regs.h");
+#endif
+
+// Key being pressed: hex key VALUE (while HEX is set), or the H or L function key
+#define KEYPAD_BINARY_SLAVE_KEY_OFFSET 0x0U
+#define KEYPAD_BINARY_SLAVE_KEY_ADDR   (KEYPAD_BINARY_SLAVE_BASE_ADDR + KEYPAD_BINARY_SLAVE_KEY_OFFSET)
+#define KEYPAD_BINARY_SLAVE_KEY_VALUE_SHIFT 0
+#define KEYPAD_BINARY_SLAVE_KEY_VALUE_MASK  0x0000000FU
+#define KEYPAD_BINARY_SLAVE_KEY_HEX_SHIFT 4
+#define KEYPAD_BINARY_SLAVE_KEY_HEX_MASK  0x00000010U
+#define KEYPAD_BINARY_SLAVE_KEY_H_SHIFT 5
+#define KEYPAD_BINARY_SLAVE_KEY_H_MASK  0x00000020U
+#define KEYPAD_BINARY_SLAVE_KEY_L_SHIFT 6
+#define KEYPAD_BINARY_SLAVE_KEY_L_MASK  0x00000040U
+static inline u32 KEYPAD_BINARY_SLAVE_ReadKey(void)
+{
+    return PERIPHERAL_REG_READ(KEYPAD_BINARY_SLAVE_KEY_ADDR);
+}
+
+// Clock ticks per keypad scan step minus one
+#define KEYPAD_BINARY_SLAVE_SCAN_DIVIDER_OFFSET 0x4U
+#define KEYPAD_BINARY_SLAVE_SCAN_DIVIDER_ADDR   (KEYPAD_BINARY_SLAVE_BASE_ADDR + KEYPAD_BINARY_SLAVE_SCAN_DIVIDER_OFFSET)
+#define KEYPAD_BINARY_SLAVE_SCAN_DIVIDER_RESET  0x7FU
+#define KEYPAD_BINARY_SLAVE_SCAN_DIVIDER_TICKS_SHIFT 0
+#define KEYPAD_BINARY_SLAVE_SCAN_DIVIDER_TICKS_MASK  0x0000007FU
+static inline u32 KEYPAD_BINARY_SLAVE_ReadScanDivider(void)
+{
+    return PERIPHERAL_REG_READ(KEYPAD_BINARY_SLAVE_SCAN_DIVIDER_ADDR);
+}
+static inline void KEYPAD_BINARY_SLAVE_WriteScanDivider(u32 value)
+{
+    PERIPHERAL_REG_WRITE(KEYPAD_BINARY_SLAVE_SCAN_DIVIDER_ADDR, value);
+}
+
+// Bitmap of held keys, bit ((row - 1) * 4) + (col - 1)
+#define KEYPAD_BINARY_SLAVE_KEY_STATE_OFFSET 0x8U
+#define KEYPAD_BINARY_SLAVE_KEY_STATE_ADDR   (KEYPAD_BINARY_SLAVE_BASE_ADDR + KEYPAD_BINARY_SLAVE_KEY_STATE_OFFSET)
+#define KEYPAD_BINARY_SLAVE_KEY_STATE_KEYS_SHIFT 0
+#define KEYPAD_BINARY_SLAVE_KEY_STATE_KEYS_MASK  0x000FFFFFU
+static inline u32 KEYPAD_BINARY_SLAVE_ReadKeyState(void)
+{
+    return PERIPHERAL_REG_READ(KEYPAD_BINARY_SLAVE_KEY_STATE_ADDR);
+}
+
+// Clock ticks since the key state last changed
+#define KEYPAD_BINARY_SLAVE_KEY_AGE_OFFSET 0xCU
+#define KEYPAD_BINARY_SLAVE_KEY_AGE_ADDR   (KEYPAD_BINARY_SLAVE_BASE_ADDR + KEYPAD_BINARY_SLAVE_KEY_AGE_OFFSET)
+#define KEYPAD_BINARY_SLAVE_KEY_AGE_CYCLES_SHIFT 0
+#define KEYPAD_BINARY_SLAVE_KEY_AGE_CYCLES_MASK  0xFFFFFFFFU
+static inline u32 KEYPAD_BINARY_SLAVE_ReadKeyAge(void)
+{
+    return PERIPHERAL_REG_READ(KEYPAD_BINARY_SLAVE_KEY_AGE_ADDR);
+}
+
+// axilab_slave_button_0 (ip_repo/axilab_slave_button_1.0/axilab_slave_button_1.0/component.xml)
+#define AXILAB_SLAVE_BUTTON_BASE_ADDR 0x43C10000U
+#define AXILAB_SLAVE_BUTTON_RANGE     0x1000U
+#ifdef XPAR_AXILAB_SLAVE_BUTTON_0_S00_AXI_BASEADDR
+_Static_assert(XPAR_AXILAB_SLAVE_BUTTON_0_S00_AXI_BASEADDR == AXILAB_SLAVE_BUTTON_BASE_ADDR,
+               "axilab_slave_button_0 moved in the address map, regenerate peripheral_regs.h");
+#endif
+
+// Onboard push buttons (1 while held)
+#define AXILAB_SLAVE_BUTTON_BUTTONS_OFFSET 0x0U
+#define AXILAB_SLAVE_BUTTON_BUTTONS_ADDR   (AXILAB_SLAVE_BUTTON_BASE_ADDR + AXILAB_SLAVE_BUTTON_BUTTONS_OFFSET)
+#define AXILAB_SLAVE_BUTTON_BUTTONS_BUTTON_0_SHIFT 0
+#define AXILAB_SLAVE_BUTTON_BUTTONS_BUTTON_0_MASK  0x00000001U
+#define AXILAB_SLAVE_BUTTON_BUTTONS_BUTTON_1_SHIFT 1
+#define AXILAB_SLAVE_BUTTON_BUTTONS_BUTTON_1_MASK  0x00000002U
+static inline u32 AXILAB_SLAVE_BUTTON_ReadButtons(void)
+{
+    return PERIPHERAL_REG_READ(AXILAB_SLAVE_BUTTON_BUTTONS_ADDR);
+}
+
+// seven_segment_display_slave_0 (ip_repo/seven_segment_display_slave_1.0/seven_segment_display_slave_1.0/component.xml)
+#define SEVEN_SEGMENT_DISPLAY_SLAVE_BASE_ADDR 0x43C20000U
+#define SEVEN_SEGMENT_DISPLAY_SLAVE_RANGE     0x1000U
+#ifdef XPAR_SEVEN_SEGMENT_DISPLAY_SLAVE_0_S00_AXI_BASEADDR
+_Static_assert(XPAR_SEVEN_SEGMENT_DISPLAY_SLAVE_0_S00_AXI_BASEADDR == SEVEN_SEGMENT_DISPLAY_SLAVE_BASE_ADDR,
+               "seven_segment_display_slave_0 moved in the address map, regenerate peripheral_regs.h");
+#endif
+
+// Displayed digits, one per nibble (0xF is blank)
+#define SEVEN_SEGMENT_DISPLAY_SLAVE_DIGITS_OFFSET 0x0U
+#define SEVEN_SEGMENT_DISPLAY_SLAVE_DIGITS_ADDR   (SEVEN_SEGMENT_DISPLAY_SLAVE_BASE_ADDR + SEVEN_SEGMENT_DISPLAY_SLAVE_DIGITS_OFFSET)
+#define SEVEN_SEGMENT_DISPLAY_SLAVE_DIGITS_DIGITS_SHIFT 0
+#define SEVEN_SEGMENT_DISPLAY_SLAVE_DIGITS_DIGITS_MASK  0x0000FFFFU
+static inline void SEVEN_SEGMENT_DISPLAY_SLAVE_WriteDigits(u32 value)
+{
+    PERIPHERAL_REG_WRITE(SEVEN_SEGMENT_DISPLAY_SLAVE_DIGITS_ADDR, value);
+}
+
+// axilab_slave_led_0 (ip_repo/axilab_slave_led_1.0/axilab_slave_led_1.0/component.xml)
+#define AXILAB_SLAVE_LED_BASE_ADDR 0x43C30000U
+#define AXILAB_SLAVE_LED_RANGE     0x1000U
+#ifdef XPAR_AXILAB_SLAVE_LED_0_S00_AXI_BASEADDR
+_Static_assert(XPAR_AXILAB_SLAVE_LED_0_S00_AXI_BASEADDR == AXILAB_SLAVE_LED_BASE_ADDR,
+               "axilab_slave_led_0 moved in the address map, regenerate peripheral_regs.h");
+#endif
+
+// Onboard RGB leds (1 lights a color)
+#define AXILAB_SLAVE_LED_LEDS_OFFSET 0x0U
+#define AXILAB_SLAVE_LED_LEDS_ADDR   (AXILAB_SLAVE_LED_BASE_ADDR + AXILAB_SLAVE_LED_LEDS_OFFSET)
+#define AXILAB_SLAVE_LED_LEDS_LED_0_BLUE_SHIFT 0
+#define AXILAB_SLAVE_LED_LEDS_LED_0_BLUE_MASK  0x00000001U
+#define AXILAB_SLAVE_LED_LEDS_LED_0_GREEN_SHIFT 1
+#define AXILAB_SLAVE_LED_LEDS_LED_0_GREEN_MASK  0x00000002U
+#define AXILAB_SLAVE_LED_LEDS_LED_0_RED_SHIFT 2
+#define AXILAB_SLAVE_LED_LEDS_LED_0_RED_MASK  0x00000004U
+#define AXILAB_SLAVE_LED_LEDS_LED_1_BLUE_SHIFT 3
+#define AXILAB_SLAVE_LED_LEDS_LED_1_BLUE_MASK  0x00000008U
+#define AXILAB_SLAVE_LED_LEDS_LED_1_GREEN_SHIFT 4
+#define AXILAB_SLAVE_LED_LEDS_LED_1_GREEN_MASK  0x00000010U
+#define AXILAB_SLAVE_LED_LEDS_LED_1_RED_SHIFT 5
+#define AXILAB_SLAVE_LED_LEDS_LED_1_RED_MASK  0x00000020U
+static inline void AXILAB_SLAVE_LED_WriteLeds(u32 value)
+{
+    PERIPHERAL_REG_WRITE(AXILAB_SLAVE_LED_LEDS_ADDR, value);
+}
+
+// passcode_cam_slave_0 (ip_repo/passcode_cam_slave_1.0/passcode_cam_slave_1.0/component.xml)
+#define PASSCODE_CAM_SLAVE_BASE_ADDR 0x43C40000U
+#define PASSCODE_CAM_SLAVE_RANGE     0x1000U
+#ifdef XPAR_PASSCODE_CAM_SLAVE_0_S00_AXI_BASEADDR
+_Static_assert(XPAR_PASSCODE_CAM_SLAVE_0_S00_AXI_BASEADDR == PASSCODE_CAM_SLAVE_BASE_ADDR,
+               "passcode_cam_slave_0 moved in the address map, regenerate peripheral_regs.h");
+#endif
+
+// Packed passcode to look up or apply CMD to
+#define PASSCODE_CAM_SLAVE_CODE_OFFSET 0x0U
+#define PASSCODE_CAM_SLAVE_CODE_ADDR   (PASSCODE_CAM_SLAVE_BASE_ADDR + PASSCODE_CAM_SLAVE_CODE_OFFSET)
+#define PASSCODE_CAM_SLAVE_CODE_CODE_SHIFT 0
+#define PASSCODE_CAM_SLAVE_CODE_CODE_MASK  0x0000FFFFU
+#define PASSCODE_CAM_SLAVE_CODE_TAG_SHIFT 16
+#define PASSCODE_CAM_SLAVE_CODE_TAG_MASK  0x00FF0000U
+static inline u32 PASSCODE_CAM_SLAVE_ReadCode(void)
+{
+    return PERIPHERAL_REG_READ(PASSCODE_CAM_SLAVE_CODE_ADDR);
+}
+static inline void PASSCODE_CAM_SLAVE_WriteCode(u32 value)
+{
+    PERIPHERAL_REG_WRITE(PASSCODE_CAM_SLAVE_CODE_ADDR, value);
+}
+
+// Command applied to CODE (last command when read)
+#define PASSCODE_CAM_SLAVE_CMD_OFFSET 0x4U
+#define PASSCODE_CAM_SLAVE_CMD_ADDR   (PASSCODE_CAM_SLAVE_BASE_ADDR + PASSCODE_CAM_SLAVE_CMD_OFFSET)
+#define PASSCODE_CAM_SLAVE_CMD_OP_SHIFT 0
+#define PASSCODE_CAM_SLAVE_CMD_OP_MASK  0x00000003U
+#define PASSCODE_CAM_SLAVE_CMD_OP_NONE 0x0U
+#define PASSCODE_CAM_SLAVE_CMD_OP_INSERT 0x1U
+#define PASSCODE_CAM_SLAVE_CMD_OP_DELETE 0x2U
+#define PASSCODE_CAM_SLAVE_CMD_OP_CLEAR 0x3U
+static inline u32 PASSCODE_CAM_SLAVE_ReadCmd(void)
+{
+    return PERIPHERAL_REG_READ(PASSCODE_CAM_SLAVE_CMD_ADDR);
+}
+static inline void PASSCODE_CAM_SLAVE_WriteCmd(u32 value)
+{
+    PERIPHERAL_REG_WRITE(PASSCODE_CAM_SLAVE_CMD_ADDR, value);
+}
+
+// Lookup and command status
+#define PASSCODE_CAM_SLAVE_STATUS_OFFSET 0x8U
+#define PASSCODE_CAM_SLAVE_STATUS_ADDR   (PASSCODE_CAM_SLAVE_BASE_ADDR + PASSCODE_CAM_SLAVE_STATUS_OFFSET)
+#define PASSCODE_CAM_SLAVE_STATUS_MATCH_SHIFT 0
+#define PASSCODE_CAM_SLAVE_STATUS_MATCH_MASK  0x00000001U
+#define PASSCODE_CAM_SLAVE_STATUS_VALID_SHIFT 1
+#define PASSCODE_CAM_SLAVE_STATUS_VALID_MASK  0x00000002U
+#define PASSCODE_CAM_SLAVE_STATUS_CMD_OK_SHIFT 2
+#define PASSCODE_CAM_SLAVE_STATUS_CMD_OK_MASK  0x00000004U
+#define PASSCODE_CAM_SLAVE_STATUS_FULL_SHIFT 3
+#define PASSCODE_CAM_SLAVE_STATUS_FULL_MASK  0x00000008U
+#define PASSCODE_CAM_SLAVE_STATUS_TAG_SHIFT 8
+#define PASSCODE_CAM_SLAVE_STATUS_TAG_MASK  0x0000FF00U
+static inline u32 PASSCODE_CAM_SLAVE_ReadStatus(void)
+{
+    return PERIPHERAL_REG_READ(PASSCODE_CAM_SLAVE_STATUS_ADDR);
+}
+
+// Number of stored codes
+#define PASSCODE_CAM_SLAVE_OCCUPANCY_OFFSET 0xCU
+#define PASSCODE_CAM_SLAVE_OCCUPANCY_ADDR   (PASSCODE_CAM_SLAVE_BASE_ADDR + PASSCODE_CAM_SLAVE_OCCUPANCY_OFFSET)
+#define PASSCODE_CAM_SLAVE_OCCUPANCY_COUNT_SHIFT 0
+#define PASSCODE_CAM_SLAVE_OCCUPANCY_COUNT_MASK  0x0000FFFFU
+static inline u32 PASSCODE_CAM_SLAVE_ReadOccupancy(void)
+{
+    return PERIPHERAL_REG_READ(PASSCODE_CAM_SLAVE_OCCUPANCY_ADDR);
+}
+
+#endif // PERIPHERAL_REGS_H
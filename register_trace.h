@@ -0,0 +1,63 @@
+/*  register_trace.h
+ *  Authors: Kyle Bielby, Christopher Lloyd
+ *  Description: Binary format of the register access trace recorded by
+ *  Security_System.c (USE_REGISTER_TRACE) and read by the tools in host/trace.
+ *
+ *  The trace is a ring of REGISTER_TRACE_NUM_BLOCKS blocks. Once the ring is
+ *  full the oldest block is overwritten, so every block can be decoded on its
+ *  own. A block is a header followed by records, and the unused bytes at its
+ *  end hold REGISTER_TRACE_PADDING.
+ *
+ *  Block header (REGISTER_TRACE_HEADER_SIZE bytes, little endian):
+ *      u16 : REGISTER_TRACE_MAGIC
+ *      u16 : Block sequence number (blocks started since boot)
+ *      u32 : Trace clock ticks per second
+ *      u64 : Trace clock at the start of the block
+ *
+ *  Record (2 to REGISTER_TRACE_MAX_RECORD_SIZE bytes):
+ *      u8  : Bit 7 write, bits 6:4 peripheral, bits 3:2 register,
+ *            bits 1:0 size of the time delta
+ *      0-10: Trace clock ticks since the previous record of the block (or
+ *            the block start). Size 0: no bytes (delta 0), 1: u8, 2: u16,
+ *            3: LEB128 varint
+ *      1-5 : Register value (LEB128 varint)
+ */
+
+#ifndef REGISTER_TRACE_H
+#define REGISTER_TRACE_H
+
+#define REGISTER_TRACE_MAGIC           0x5452
+#define REGISTER_TRACE_NUM_BLOCKS      64
+#define REGISTER_TRACE_BLOCK_SIZE      256
+#define REGISTER_TRACE_HEADER_SIZE     16
+#define REGISTER_TRACE_MAX_RECORD_SIZE (1 + 10 + 5)
+#define REGISTER_TRACE_PADDING         0xFF
+
+// Record header fields
+#define REGISTER_TRACE_WRITE_BIT       0x80
+#define REGISTER_TRACE_PERIPHERAL_SHIFT 4
+#define REGISTER_TRACE_PERIPHERAL_MASK 0x7
+#define REGISTER_TRACE_REGISTER_SHIFT  2
+#define REGISTER_TRACE_REGISTER_MASK   0x3
+#define REGISTER_TRACE_DELTA_MASK      0x3
+
+#define REGISTER_TRACE_DELTA_NONE      0
+#define REGISTER_TRACE_DELTA_U8        1
+#define REGISTER_TRACE_DELTA_U16       2
+#define REGISTER_TRACE_DELTA_VARINT    3
+
+// Peripheral numbers (address bits 18:16 above 0x43c00000)
+#define REGISTER_TRACE_KEYPAD          0
+#define REGISTER_TRACE_BUTTON          1
+#define REGISTER_TRACE_SEVEN_SEGMENT   2
+#define REGISTER_TRACE_LED             3
+#define REGISTER_TRACE_PASSCODE_CAM    4
+#define REGISTER_TRACE_UNKNOWN         5
+
+// Dump format printed over UART (hex, REGISTER_TRACE_DUMP_LINE_SIZE bytes
+// per line between the begin and end lines)
+#define REGISTER_TRACE_DUMP_BEGIN      "REGISTER TRACE BEGIN"
+#define REGISTER_TRACE_DUMP_END        "REGISTER TRACE END"
+#define REGISTER_TRACE_DUMP_LINE_SIZE  32
+
+#endif // REGISTER_TRACE_H
@@ -0,0 +1,77 @@
+/*  telemetry.h
+ *  Authors: Kyle Bielby, Christopher Lloyd
+ *  Description: Binary telemetry frames sent over UART by Security_System.c
+ *  (USE_TELEMETRY) and read by host/telemetry/telemetry_decode.
+ *
+ *  Frame:
+ *      u8  : TELEMETRY_SYNC_0
+ *      u8  : TELEMETRY_SYNC_1
+ *      u8  : Frame type (TELEMETRY_FRAME_*)
+ *      u8  : Payload length
+ *      ... : Payload
+ *      u16 : CRC-16/CCITT-FALSE of the type, length and payload
+ *  All fields are little endian. Text printed to the same UART is skipped by
+ *  the decoder, which resynchronizes on the sync bytes and checks the CRC.
+ *
+ *  TELEMETRY_FRAME_STATUS payload (every TELEMETRY_INTERVAL_MS):
+ *      u16 : Frame sequence number (status frames sent since boot)
+ *      u32 : Milliseconds since boot
+ *      u32 : Main loop iterations per second over the last interval
+ *      u32 : Keypad digits entered since boot
+ *      u8  : Current mode
+ *      u8  : Passcodes stored
+ *      u8  : Passcode capacity
+ *      u16 : Accepted and rejected counts (2 x u16) of each operation,
+ *            TELEMETRY_NUM_OPERATIONS in order
+ *      u16 : Passcodes expired since boot
+ *      u16 : Frames dropped because the TX buffer was full
+ *
+ *  TELEMETRY_FRAME_VERDICT payload (when a complete passcode is handled):
+ *      u32 : Milliseconds since boot
+ *      u8  : Operation (TELEMETRY_OPERATION_*)
+ *      u8  : Accepted (1) or rejected (0)
+ *      u8  : Passcodes stored afterwards
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+
+#define TELEMETRY_SYNC_0          0xA5
+#define TELEMETRY_SYNC_1          0x5A
+#define TELEMETRY_FRAME_OVERHEAD  6   // Sync, type, length and CRC
+#define TELEMETRY_MAX_PAYLOAD     255
+
+// Frame types
+#define TELEMETRY_FRAME_STATUS    1
+#define TELEMETRY_FRAME_VERDICT   2
+
+// Operations (the mode a passcode was entered in)
+#define TELEMETRY_OPERATION_CHECK       0
+#define TELEMETRY_OPERATION_STORE       1
+#define TELEMETRY_OPERATION_REMOVE      2
+#define TELEMETRY_OPERATION_STORE_TEMP  3
+#define TELEMETRY_NUM_OPERATIONS        4
+
+#define TELEMETRY_STATUS_SIZE   (21 + (4 * TELEMETRY_NUM_OPERATIONS))
+#define TELEMETRY_VERDICT_SIZE  7
+
+/*
+ *  Adds a byte to a CRC-16/CCITT-FALSE (polynomial 0x1021, initial value
+ *  TELEMETRY_CRC_INIT).
+ *
+ *  Returns: uint16_t: The updated CRC.
+ */
+#define TELEMETRY_CRC_INIT 0xFFFF
+static inline uint16_t updateTelemetryCRC(uint16_t crc, uint8_t byte)
+{
+    crc ^= ((uint16_t)byte << 8);
+    for (int bit = 0; bit < 8; bit++)
+    {
+        crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+    }
+    return crc;
+}
+
+#endif // TELEMETRY_H